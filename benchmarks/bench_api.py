@@ -0,0 +1,159 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Copyright 2026 Bastien Léonard. All rights reserved.
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+
+#    1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+
+#    2. Redistributions in binary form must reproduce the above
+#    copyright notice, this list of conditions and the following
+#    disclaimer in the documentation and/or other materials provided
+#    with the distribution.
+
+# THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+# USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+# OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+
+"""Benchmark the main API calls against a fake hwmon tree.
+
+    python3 benchmarks/bench_api.py [--chips N] [--duration S] [API ...]
+
+The tree and its libsensors configuration are generated in a temporary
+directory, and the benchmark runs again in a mount namespace where the
+tree replaces /sys/class (see fakehwmon.py), so it doesn't depend on
+the hardware. For each API, the calls per second and the median and
+99th percentile latencies are printed.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import fakehwmon
+
+
+def measure(function, duration):
+    """Call function repeatedly for duration seconds, and return the
+    calls per second and the latencies of the calls, sorted."""
+    clock = time.perf_counter
+    latencies = []
+    function()
+    end = clock() + duration
+
+    while True:
+        start = clock()
+        function()
+        stop = clock()
+        latencies.append(stop - start)
+
+        if stop >= end:
+            break
+
+    latencies.sort()
+
+    return len(latencies) / sum(latencies), latencies
+
+
+def percentile(latencies, p):
+    return latencies[min(len(latencies) - 1, int(len(latencies) * p))]
+
+
+def make_apis(sensors):
+    chip = sensors.get_detected_chips()[0]
+    name = str(chip)
+    feature = [f for f in chip.get_features() if f.name == 'temp1'][0]
+    number = chip.get_subfeature(feature,
+                                 sensors.SUBFEATURE_TEMP_INPUT).number
+
+    return [
+        ('get_detected_chips', sensors.get_detected_chips),
+        ('get_features', chip.get_features),
+        ('get_all_subfeatures', lambda: chip.get_all_subfeatures(feature)),
+        ('get_label', lambda: chip.get_label(feature)),
+        ('get_value', lambda: chip.get_value(number)),
+        ('get_value_or_none', lambda: chip.get_value_or_none(number)),
+        ('parse_chip_name', lambda: sensors.ChipName.parse_chip_name(name)),
+    ]
+
+
+def run(args, root):
+    import sensors
+
+    sensors.init(os.path.join(root, 'sensors.conf'))
+    apis = make_apis(sensors)
+    results = {}
+
+    if args.apis:
+        apis = [api for api in apis if api[0] in args.apis]
+
+    print('{0:24} {1:>12} {2:>10} {3:>10}'.format(
+        'API', 'calls/s', 'p50 ns', 'p99 ns'))
+
+    for name, function in apis:
+        rate, latencies = measure(function, args.duration)
+        p50 = percentile(latencies, 0.5) * 1e9
+        p99 = percentile(latencies, 0.99) * 1e9
+        results[name] = {'calls_per_second': rate, 'p50_ns': p50,
+                         'p99_ns': p99}
+        print('{0:24} {1:12.0f} {2:10.0f} {3:10.0f}'.format(
+            name, rate, p50, p99))
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(results, f, indent=4, sort_keys=True)
+
+    sensors.cleanup()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Benchmark the API against a fake hwmon tree.')
+    parser.add_argument('apis', nargs='*', metavar='API',
+                        help='only run these benchmarks')
+    parser.add_argument('--chips', type=int, default=4,
+                        help='number of chips in the tree')
+    parser.add_argument('--duration', type=float, default=1.0,
+                        help='seconds per benchmark')
+    parser.add_argument('--json', metavar='FILE',
+                        help='also write the results to FILE')
+    args = parser.parse_args()
+    root = fakehwmon.in_tree()
+
+    if root is not None:
+        run(args, root)
+        return
+
+    root = tempfile.mkdtemp(prefix='fakehwmon-')
+
+    try:
+        fakehwmon.generate(root, args.chips, {'fakechip': 1})
+        status = fakehwmon.run_in_tree(
+            root, [sys.executable, os.path.abspath(__file__)] + sys.argv[1:])
+    finally:
+        shutil.rmtree(root)
+
+    sys.exit(status)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,191 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Copyright 2026 Bastien Léonard. All rights reserved.
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+
+#    1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+
+#    2. Redistributions in binary form must reproduce the above
+#    copyright notice, this list of conditions and the following
+#    disclaimer in the documentation and/or other materials provided
+#    with the distribution.
+
+# THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+# USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+# OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+
+"""Benchmark concurrent reads against the fake libsensors of the tests.
+
+    python setup.py build_ext --shim --force
+    python3 benchmarks/bench_concurrency.py [--latency 0,100,1000]
+
+The module must be built with the shim (see tests/shim/sensors_shim.c),
+which makes every read take a fixed time without doing any I/O. For
+each read latency and number of threads, the threads call get_value()
+in a loop, and the total reads per second and the median and 99th
+percentile latencies are printed; the overhead column is the median
+latency minus the simulated one, that is the cost of the binding. The
+batch APIs are then timed with the same latencies.
+"""
+
+import argparse
+import json
+import os
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from bench_api import measure, percentile
+
+import sensors
+
+
+def configure(chips, latency, jitter, error_rate):
+    settings = 'chips={0} latency={1} jitter={2}'.format(
+        chips, latency, jitter)
+
+    if error_rate:
+        settings += ' error=kernel:{0}'.format(error_rate)
+
+    os.environ['SENSORS_SHIM'] = settings
+    sensors.init(os.devnull)
+
+    return sensors.get_detected_chips()
+
+
+def read_in_threads(chips, thread_count, duration):
+    """Read from thread_count threads for duration seconds, and return
+    the reads per second and the latencies of the reads, sorted."""
+    clock = time.perf_counter
+    latencies = [[] for i in range(thread_count)]
+    start_barrier = threading.Barrier(thread_count + 1)
+
+    def read(i):
+        chip = chips[i % len(chips)]
+        own = latencies[i]
+        start_barrier.wait()
+        end = clock() + duration
+
+        while True:
+            start = clock()
+            chip.get_value_or_none(0)
+            stop = clock()
+            own.append(stop - start)
+
+            if stop >= end:
+                break
+
+    threads = [threading.Thread(target=read, args=(i,))
+               for i in range(thread_count)]
+
+    for thread in threads:
+        thread.start()
+
+    start_barrier.wait()
+    start = clock()
+
+    for thread in threads:
+        thread.join()
+
+    elapsed = clock() - start
+    merged = sorted(latency for own in latencies for latency in own)
+
+    return len(merged) / elapsed, merged
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Benchmark concurrent reads against the shim.')
+    parser.add_argument('--chips', type=int, default=8,
+                        help='number of chips')
+    parser.add_argument('--latency', default='0,100,1000',
+                        help='read latencies in microseconds, separated'
+                        ' by commas')
+    parser.add_argument('--jitter', type=int, default=0,
+                        help='random latency added to each read, up to'
+                        ' this many microseconds')
+    parser.add_argument('--error-rate', type=float, default=0.0,
+                        help='probability that a read fails')
+    parser.add_argument('--threads', default='1,2,4,8',
+                        help='numbers of threads, separated by commas')
+    parser.add_argument('--duration', type=float, default=1.0,
+                        help='seconds per benchmark')
+    parser.add_argument('--json', metavar='FILE',
+                        help='also write the results to FILE')
+    args = parser.parse_args()
+
+    if sensors.LIBSENSORS_VERSION != 'shim':
+        sys.exit('The module must be built with: '
+                 'python setup.py build_ext --shim --force')
+
+    latencies = [int(latency) for latency in args.latency.split(',')]
+    thread_counts = [int(count) for count in args.threads.split(',')]
+    results = {'reads': [], 'batches': []}
+    print('{0:>10} {1:>8} {2:>12} {3:>10} {4:>10} {5:>12}'.format(
+        'latency us', 'threads', 'reads/s', 'p50 us', 'p99 us',
+        'overhead us'))
+
+    for latency in latencies:
+        chips = configure(args.chips, latency, args.jitter, args.error_rate)
+
+        for thread_count in thread_counts:
+            rate, measured = read_in_threads(chips, thread_count,
+                                             args.duration)
+            p50 = percentile(measured, 0.5) * 1e6
+            p99 = percentile(measured, 0.99) * 1e6
+            results['reads'].append({
+                'latency_us': latency, 'threads': thread_count,
+                'reads_per_second': rate, 'p50_us': p50, 'p99_us': p99})
+            print('{0:10} {1:8} {2:12.0f} {3:10.1f} {4:10.1f} {5:12.1f}'
+                  .format(latency, thread_count, rate, p50, p99,
+                          p50 - latency))
+
+    print()
+    print('{0:>10} {1:28} {2:>10} {3:>10}'.format(
+        'latency us', 'batch', 'p50 ms', 'p99 ms'))
+
+    for latency in latencies:
+        chips = configure(args.chips, latency, args.jitter, args.error_rate)
+        pairs = [(chip, number) for chip in chips for number in (0, 5, 8)]
+        batches = [
+            ('snapshot()', sensors.snapshot),
+            ('snapshot(parallel=True)',
+             lambda: sensors.snapshot(parallel=True)),
+            ('read_many()', lambda: sensors.read_many(pairs)),
+        ]
+
+        for name, function in batches:
+            rate, measured = measure(function, args.duration)
+            p50 = percentile(measured, 0.5) * 1e3
+            p99 = percentile(measured, 0.99) * 1e3
+            results['batches'].append({
+                'latency_us': latency, 'batch': name, 'p50_ms': p50,
+                'p99_ms': p99})
+            print('{0:10} {1:28} {2:10.2f} {3:10.2f}'.format(
+                latency, name, p50, p99))
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(results, f, indent=4, sort_keys=True)
+
+    sensors.cleanup()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,91 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Copyright 2026 Bastien Léonard. All rights reserved.
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+
+#    1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+
+#    2. Redistributions in binary form must reproduce the above
+#    copyright notice, this list of conditions and the following
+#    disclaimer in the documentation and/or other materials provided
+#    with the distribution.
+
+# THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+# USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+# OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+
+"""Measure the cost of creating ChipName, Feature and Subfeature objects.
+
+Run it from a build directory, or after installing the module:
+
+    python3 benchmarks/bench_objects.py [--number N]
+
+Each line gives the time per object, in nanoseconds, for the best of
+several repeats.
+"""
+
+import argparse
+import timeit
+
+import sensors
+
+
+def per_object(function, objects, number, repeat):
+    best = min(timeit.repeat(function, number=number, repeat=repeat))
+
+    return best / (number * objects) * 1e9
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--number', type=int, default=100000,
+                        help='calls per repeat')
+    parser.add_argument('--repeat', type=int, default=5)
+    args = parser.parse_args()
+
+    chips = sensors.get_detected_chips()
+    chip = chips[0]
+    name = str(chip)
+    feature = chip.get_features()[0]
+    subfeature = chip.get_all_subfeatures(feature)[0]
+    cases = [
+        ('get_detected_chips() per chip',
+         sensors.get_detected_chips, len(chips)),
+        ('ChipName.parse_chip_name()',
+         lambda: sensors.ChipName.parse_chip_name(name), 1),
+        ('ChipName()',
+         lambda: sensors.ChipName(chip.prefix, chip.bus_type, chip.bus_nr,
+                                  chip.addr, chip.path), 1),
+        ('Feature()',
+         lambda: sensors.Feature(feature.name, feature.number,
+                                 feature.type), 1),
+        ('Subfeature()',
+         lambda: sensors.Subfeature(subfeature.name, subfeature.number,
+                                    subfeature.type, subfeature.mapping,
+                                    subfeature.flags), 1),
+    ]
+
+    for label, function, objects in cases:
+        print('{0:32} {1:8.1f} ns'.format(
+            label, per_object(function, objects, args.number, args.repeat)))
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    finally:
+        sensors.cleanup()
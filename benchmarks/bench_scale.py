@@ -0,0 +1,177 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Copyright 2026 Bastien Léonard. All rights reserved.
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+
+#    1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+
+#    2. Redistributions in binary form must reproduce the above
+#    copyright notice, this list of conditions and the following
+#    disclaimer in the documentation and/or other materials provided
+#    with the distribution.
+
+# THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+# USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+# OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+
+"""Measure how the enumeration scales with the number of chips.
+
+    python3 benchmarks/bench_scale.py [--sizes 10,100,1000,10000]
+
+For each size, a fake hwmon tree with that many chips is generated (see
+fakehwmon.py), and the following are timed against it:
+
+* init: sensors.init(), which makes libsensors scan sysfs;
+* detect: get_detected_chips();
+* cold scan: reading every subfeature of every chip through
+  get_features() and get_all_subfeatures(), right after init();
+* warm scan: the same scan again;
+* snapshot: snapshot().
+
+With --max-growth, the exit status is 1 if the time per chip of a
+measure grows by more than that factor between the smallest and the
+largest size, so that a superlinear regression can fail a CI job.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import fakehwmon
+
+
+MEASURES = ('init', 'detect', 'cold scan', 'warm scan', 'snapshot')
+
+
+def timed(function, repeat=1):
+    """Return the best time of function, in seconds."""
+    best = None
+
+    for i in range(repeat):
+        start = time.perf_counter()
+        function()
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+
+    return best
+
+
+def scan(sensors):
+    for chip in sensors.get_detected_chips():
+        for feature in chip.get_features():
+            for subfeature in chip.get_all_subfeatures(feature):
+                chip.get_value_or_none(subfeature.number)
+
+
+def measure(root, result):
+    """Run in the tree: time everything, and write the times to the
+    result file."""
+    import sensors
+
+    config = os.path.join(root, 'sensors.conf')
+    times = {}
+    times['init'] = timed(lambda: sensors.init(config))
+    times['cold scan'] = timed(lambda: scan(sensors))
+    times['warm scan'] = timed(lambda: scan(sensors), 3)
+    times['detect'] = timed(sensors.get_detected_chips, 5)
+    times['snapshot'] = timed(sensors.snapshot, 3)
+    sensors.cleanup()
+
+    with open(result, 'w') as f:
+        json.dump(times, f)
+
+
+def run_size(chips, mix):
+    root = tempfile.mkdtemp(prefix='fakehwmon-')
+
+    try:
+        fakehwmon.generate(root, chips, mix)
+        result = os.path.join(root, 'result.json')
+        status = fakehwmon.run_in_tree(
+            root, [sys.executable, os.path.abspath(__file__),
+                   '--result', result])
+
+        if status != 0:
+            sys.exit(status)
+
+        with open(result) as f:
+            return json.load(f)
+    finally:
+        shutil.rmtree(root)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Measure how the enumeration scales with the number'
+        ' of chips.')
+    parser.add_argument('--sizes', default='10,100,1000',
+                        help='numbers of chips, separated by commas')
+    parser.add_argument('--mix', type=fakehwmon.parse_mix,
+                        help='profiles of the chips, as for fakehwmon.py')
+    parser.add_argument('--max-growth', type=float, metavar='FACTOR',
+                        help='fail if the time per chip grows more than'
+                        ' this between the smallest and largest size')
+    parser.add_argument('--json', metavar='FILE',
+                        help='also write the results to FILE')
+    parser.add_argument('--result', help=argparse.SUPPRESS)
+    args = parser.parse_args()
+    root = fakehwmon.in_tree()
+
+    if root is not None:
+        measure(root, args.result)
+        return
+
+    sizes = sorted(int(size) for size in args.sizes.split(','))
+    results = {}
+    print('{0:>6} {1}'.format('chips', ' '.join(
+        '{0:>12}'.format(m + ' ms') for m in MEASURES)))
+
+    for size in sizes:
+        times = run_size(size, args.mix)
+        results[size] = times
+        print('{0:6} {1}'.format(size, ' '.join(
+            '{0:12.2f}'.format(times[m] * 1e3) for m in MEASURES)))
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(results, f, indent=4, sort_keys=True)
+
+    if args.max_growth is not None and len(sizes) > 1:
+        first, last = sizes[0], sizes[-1]
+        failed = False
+
+        for m in MEASURES:
+            growth = ((results[last][m] / last) /
+                      (results[first][m] / first))
+
+            if growth > args.max_growth:
+                print('{0}: the time per chip grew {1:.1f} times from {2}'
+                      ' to {3} chips'.format(m, growth, first, last))
+                failed = True
+
+        if failed:
+            sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
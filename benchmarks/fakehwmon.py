@@ -0,0 +1,338 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Copyright 2026 Bastien Léonard. All rights reserved.
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+
+#    1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+
+#    2. Redistributions in binary form must reproduce the above
+#    copyright notice, this list of conditions and the following
+#    disclaimer in the documentation and/or other materials provided
+#    with the distribution.
+
+# THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+# USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+# OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+
+"""Generate a fake sysfs hwmon tree, and run programs against it.
+
+libsensors finds the chips by listing /sys/class/hwmon. The tree made
+by generate() has a class/hwmon directory, which run_in_tree() bind
+mounts over /sys/class in a private mount namespace (with unshare, so
+no privileges are needed), before running the program. The chips have
+no device link, so libsensors sees them as virtual devices, named
+PREFIX-virtual-N.
+
+The chips are made from profiles that mimic common drivers, mixed in
+the given proportions, so that trees from 10 to 10,000 chips look like
+real hosts. From the command line:
+
+    fakehwmon.py generate ROOT [--chips N] [--mix PROFILE=WEIGHT,...]
+    fakehwmon.py run ROOT COMMAND [ARGUMENT ...]
+
+The first creates the tree and ROOT/sensors.conf, the second runs a
+command against it; SENSORS_FAKE_HWMON is set to ROOT in its
+environment.
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+
+
+# Set in the environment of the programs run by run_in_tree()
+TREE_VARIABLE = 'SENSORS_FAKE_HWMON'
+
+CONFIG = '''\
+chip "fakechip-*"
+    label temp1 "Package"
+    label fan1 "System fan"
+    compute in0 @*2, @/2
+
+chip "coretemp-*"
+    label temp1 "Package id 0"
+
+chip "nct6775-*"
+    label in0 "Vcore"
+    compute in1 @*11, @/11
+
+chip "psu-*"
+    label power1 "Input power"
+'''
+
+
+def write(path, value):
+    with open(path, 'w') as f:
+        f.write('{0}\n'.format(value))
+
+
+def write_attributes(chip, attributes):
+    for name, value in attributes:
+        write(os.path.join(chip, name), value)
+
+
+def fakechip(i, rng):
+    """Small chip with a label, a compute statement and every value
+    known in advance, for the API benchmarks."""
+    attributes = []
+
+    for n in (1, 2):
+        attributes += [('temp{0}_input'.format(n), 40000 + 1000 * i + n),
+                       ('temp{0}_max'.format(n), 80000),
+                       ('temp{0}_crit'.format(n), 100000)]
+
+    return attributes + [('temp2_label', 'Core 0'),
+                         ('fan1_input', 1200 + i),
+                         ('fan1_min', 300),
+                         ('in0_input', 1100),
+                         ('in0_min', 1000),
+                         ('in0_max', 1300)]
+
+
+def coretemp(i, rng):
+    """CPU package and cores."""
+    attributes = []
+
+    for n in range(1, rng.randint(5, 17) + 1):
+        label = 'Package id 0' if n == 1 else 'Core {0}'.format(n - 2)
+        attributes += [('temp{0}_input'.format(n), rng.randint(35, 70) * 1000),
+                       ('temp{0}_max'.format(n), 80000),
+                       ('temp{0}_crit'.format(n), 100000),
+                       ('temp{0}_crit_alarm'.format(n), 0),
+                       ('temp{0}_label'.format(n), label)]
+
+    return attributes
+
+
+def nct6775(i, rng):
+    """Super I/O chip of a motherboard: voltages, fans and temperatures."""
+    attributes = []
+
+    for n in range(9):
+        value = rng.randint(800, 3400)
+        attributes += [('in{0}_input'.format(n), value),
+                       ('in{0}_min'.format(n), value * 9 // 10),
+                       ('in{0}_max'.format(n), value * 11 // 10),
+                       ('in{0}_alarm'.format(n), 0)]
+
+    for n in range(1, 6):
+        attributes += [('fan{0}_input'.format(n), rng.randint(0, 2000)),
+                       ('fan{0}_min'.format(n), 0),
+                       ('fan{0}_alarm'.format(n), 0)]
+
+    for n, label in enumerate(('SYSTIN', 'CPUTIN', 'AUXTIN0', 'AUXTIN1',
+                               'AUXTIN2', 'PECI Agent 0'), 1):
+        attributes += [('temp{0}_input'.format(n), rng.randint(25, 60) * 1000),
+                       ('temp{0}_max'.format(n), 80000),
+                       ('temp{0}_max_hyst'.format(n), 75000),
+                       ('temp{0}_type'.format(n), 4),
+                       ('temp{0}_label'.format(n), label)]
+
+    return attributes + [('intrusion0_alarm', 0)]
+
+
+def nvme(i, rng):
+    """NVMe drive: composite temperature and one sensor."""
+    return [('temp1_input', rng.randint(30, 55) * 1000),
+            ('temp1_max', 84850),
+            ('temp1_min', -273150),
+            ('temp1_crit', 84850),
+            ('temp1_alarm', 0),
+            ('temp1_label', 'Composite'),
+            ('temp2_input', rng.randint(30, 60) * 1000),
+            ('temp2_max', 65261850),
+            ('temp2_min', -273150),
+            ('temp2_label', 'Sensor 1')]
+
+
+def drivetemp(i, rng):
+    """SATA drive."""
+    value = rng.randint(25, 45) * 1000
+
+    return [('temp1_input', value),
+            ('temp1_lowest', value - 5000),
+            ('temp1_highest', value + 10000),
+            ('temp1_min', 0),
+            ('temp1_max', 60000),
+            ('temp1_lcrit', -5000),
+            ('temp1_crit', 70000)]
+
+
+def psu(i, rng):
+    """PMBus power supply."""
+    attributes = []
+
+    for n, label in enumerate(('vin', 'vout1'), 1):
+        attributes += [('in{0}_input'.format(n), rng.randint(11800, 12200)),
+                       ('in{0}_label'.format(n), label),
+                       ('in{0}_crit'.format(n), 14000)]
+
+    for n, label in enumerate(('iin', 'iout1'), 1):
+        attributes += [('curr{0}_input'.format(n), rng.randint(1000, 20000)),
+                       ('curr{0}_max'.format(n), 60000),
+                       ('curr{0}_label'.format(n), label)]
+
+    for n, label in enumerate(('pin', 'pout1'), 1):
+        attributes += [('power{0}_input'.format(n),
+                        rng.randint(50, 500) * 1000000),
+                       ('power{0}_max'.format(n), 800000000),
+                       ('power{0}_label'.format(n), label)]
+
+    return attributes + [('temp1_input', rng.randint(30, 50) * 1000),
+                         ('temp1_max', 85000),
+                         ('temp1_crit', 100000),
+                         ('fan1_input', rng.randint(3000, 9000)),
+                         ('fan1_target', 6000)]
+
+
+def bmc(i, rng):
+    """Sensors bridged from a BMC: energy and power of a node."""
+    return [('energy1_input', rng.randint(10 ** 9, 10 ** 12)),
+            ('power1_average', rng.randint(50, 400) * 1000000),
+            ('power1_average_interval', 1000),
+            ('curr1_input', rng.randint(1000, 30000)),
+            ('in1_input', rng.randint(11800, 12200)),
+            ('temp1_input', rng.randint(20, 40) * 1000)]
+
+
+PROFILES = {
+    'fakechip': fakechip,
+    'coretemp': coretemp,
+    'nct6775': nct6775,
+    'nvme': nvme,
+    'drivetemp': drivetemp,
+    'psu': psu,
+    'bmc': bmc,
+}
+
+# Roughly a storage server
+DEFAULT_MIX = {'coretemp': 2, 'nct6775': 1, 'nvme': 16, 'drivetemp': 12,
+               'psu': 2, 'bmc': 3}
+
+
+def parse_mix(text):
+    """Parse PROFILE=WEIGHT,... into a dictionary."""
+    mix = {}
+
+    for item in text.split(','):
+        profile, _, weight = item.partition('=')
+
+        if profile not in PROFILES:
+            raise ValueError('unknown profile: {0}'.format(profile))
+
+        mix[profile] = int(weight or 1)
+
+    return mix
+
+
+def assign_profiles(chips, mix):
+    """Return the profile of each chip, so that the proportions of the
+    mix are respected even for a few chips, and the profiles are
+    interleaved as on a real host."""
+    total = float(sum(mix.values()))
+    profiles = sorted(mix)
+    counts = dict((profile, 0) for profile in profiles)
+    result = []
+
+    for i in range(chips):
+        # The profile that is the most behind its share
+        profile = max(profiles,
+                      key=lambda p: (mix[p] / total * (i + 1) - counts[p]))
+        counts[profile] += 1
+        result.append(profile)
+
+    return result
+
+
+def generate(root, chips=4, mix=None, seed=0):
+    """Create the tree for chips chips under root, and a libsensors
+    configuration file that matches it. mix maps profile names to
+    weights, and defaults to DEFAULT_MIX; the values are random, from
+    seed. Return the path of the configuration file."""
+    hwmon = os.path.join(root, 'class', 'hwmon')
+    rng = random.Random(seed)
+
+    for i, profile in enumerate(assign_profiles(chips, mix or DEFAULT_MIX)):
+        chip = os.path.join(hwmon, 'hwmon{0}'.format(i))
+        os.makedirs(chip)
+        write(os.path.join(chip, 'name'), profile)
+        write_attributes(chip, PROFILES[profile](i, rng))
+
+    config = os.path.join(root, 'sensors.conf')
+
+    with open(config, 'w') as f:
+        f.write(CONFIG)
+
+    return config
+
+
+def in_tree():
+    """Return the root of the tree if this process runs in one, or
+    None."""
+    return os.environ.get(TREE_VARIABLE)
+
+
+def run_in_tree(root, argv):
+    """Run argv with the tree under root mounted over /sys/class, and
+    return its exit status."""
+    script = 'mount --bind "$0/class" /sys/class && exec "$@"'
+    env = dict(os.environ)
+    env[TREE_VARIABLE] = root
+
+    try:
+        return subprocess.call(
+            ['unshare', '--user', '--map-root-user', '--mount',
+             'sh', '-c', script, root] + list(argv),
+            env=env)
+    except OSError as e:
+        sys.stderr.write('Can\'t run unshare: {0}\n'.format(e))
+        return 1
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Generate a fake hwmon tree, or run a command'
+        ' against one.')
+    commands = parser.add_subparsers(dest='command')
+    generate_parser = commands.add_parser(
+        'generate', help='create a tree and its libsensors configuration')
+    generate_parser.add_argument('root')
+    generate_parser.add_argument('--chips', type=int, default=10)
+    generate_parser.add_argument(
+        '--mix', type=parse_mix,
+        help='PROFILE=WEIGHT,... among {0}'.format(', '.join(
+            sorted(PROFILES))))
+    generate_parser.add_argument('--seed', type=int, default=0)
+    run_parser = commands.add_parser(
+        'run', help='run a command with the tree mounted over /sys/class')
+    run_parser.add_argument('root')
+    run_parser.add_argument('argv', nargs=argparse.REMAINDER)
+    args = parser.parse_args()
+
+    if args.command == 'generate':
+        print(generate(args.root, args.chips, args.mix, args.seed))
+    elif args.command == 'run' and args.argv:
+        sys.exit(run_in_tree(os.path.abspath(args.root), args.argv))
+    else:
+        parser.print_usage()
+        sys.exit(2)
+
+
+if __name__ == '__main__':
+    main()
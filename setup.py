@@ -28,8 +28,14 @@
 # SUCH DAMAGE.
 
 import glob
+import os
+import subprocess
+import sys
 
+from distutils.cmd import Command
+from distutils.command.build_ext import build_ext
 from distutils.core import setup, Extension
+from distutils.errors import DistutilsError
 import distutils.ccompiler
 
 
@@ -42,6 +48,71 @@ EXTRA_COMPILE_ARGS = [
     '-fvisibility=hidden'
 ]
 EXTRA_LINK_ARGS = ['-fvisibility=hidden']
+SHIM_SOURCE = os.path.join('tests', 'shim', 'sensors_shim.c')
+
+# The asyncio wrappers use asynchronous generators
+if sys.version_info >= (3, 6):
+    PY_MODULES = ['sensors_async']
+else:
+    PY_MODULES = []
+
+
+class BuildExt(build_ext):
+    user_options = build_ext.user_options + [
+        ('shim', None,
+         'use the fake libsensors of the tests instead of libsensors'),
+        ('usdt', None, 'compile the USDT probes (needs sys/sdt.h)'),
+    ]
+    boolean_options = build_ext.boolean_options + ['shim', 'usdt']
+
+    def initialize_options(self):
+        build_ext.initialize_options(self)
+        self.shim = 0
+        self.usdt = 0
+
+    def build_extension(self, ext):
+        if self.shim:
+            ext.sources = ext.sources + [SHIM_SOURCE]
+            ext.libraries = [library for library in ext.libraries
+                             if library != 'sensors']
+        if self.usdt:
+            ext.define_macros = ext.define_macros + [('SENSORS_USDT', '1')]
+
+        build_ext.build_extension(self, ext)
+
+
+class Bench(Command):
+    description = 'run the benchmarks against a fake hwmon tree'
+    user_options = [
+        ('chips=', None, 'number of chips in the tree'),
+        ('duration=', None, 'seconds per benchmark'),
+        ('json=', None, 'also write the results to this file'),
+    ]
+
+    def initialize_options(self):
+        self.chips = None
+        self.duration = None
+        self.json = None
+
+    def finalize_options(self):
+        pass
+
+    def run(self):
+        self.run_command('build_ext')
+        build_ext = self.get_finalized_command('build_ext')
+        env = dict(os.environ)
+        env['PYTHONPATH'] = os.pathsep.join(
+            [os.path.abspath(build_ext.build_lib), os.path.abspath('src')])
+        argv = [sys.executable, os.path.join('benchmarks', 'bench_api.py')]
+
+        for option in ('chips', 'duration', 'json'):
+            value = getattr(self, option)
+
+            if value is not None:
+                argv += ['--' + option, value]
+
+        if subprocess.call(argv, env=env) != 0:
+            raise DistutilsError('the benchmarks failed')
 
 
 with open('README.md') as f:
@@ -68,6 +139,9 @@ setup(
         'Topic :: System :: Hardware',
         'Topic :: System :: Monitoring'
     ],
+    cmdclass={'build_ext': BuildExt, 'bench': Bench},
+    package_dir={'': 'src'},
+    py_modules=PY_MODULES,
     ext_modules=[
         Extension(
             'sensors',
@@ -0,0 +1,732 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <sensors/sensors.h>
+#include <sensors/error.h>
+
+#include "sensorsmodule.h"
+#include "chipname.h"
+#include "subfeature.h"
+#include "alarmwatcher.h"
+#include "topology.h"
+#include "utils.h"
+
+/* Events handled by one call to epoll_wait() */
+#define MAX_EVENTS 64
+
+/* A subfeature to watch, found while sensors_lock was held */
+typedef struct
+{
+    sensors_subfeature subfeature; /* With its own copy of the name */
+    char *path;
+} Alarm;
+
+
+static PyObject* new(PyTypeObject*, PyObject*, PyObject*);
+static int init(AlarmWatcher*, PyObject*, PyObject*);
+static void dealloc(AlarmWatcher*);
+static PyObject* repr(AlarmWatcher*);
+static PyObject* wait_(AlarmWatcher*, PyObject*, PyObject*);
+static PyObject* fileno_(AlarmWatcher*, PyObject*);
+static PyObject* close_(AlarmWatcher*, PyObject*);
+static PyObject* enter(AlarmWatcher*, PyObject*);
+static PyObject* exit_(AlarmWatcher*, PyObject*);
+static int parse_numbers(PyObject*, int**, Py_ssize_t*);
+static Py_ssize_t find_alarms(const sensors_chip_name*, const int*,
+                              Py_ssize_t, Alarm**);
+static int is_alarm(const sensors_subfeature*, const int*, Py_ssize_t);
+static int read_alarm(int, double*);
+static int check_open(AlarmWatcher*);
+static void close_all(AlarmWatcher*);
+static void free_alarms(Alarm*, Py_ssize_t);
+
+
+static PyMethodDef methods[] = {
+    {"wait", (PyCFunction)wait_, METH_VARARGS | METH_KEYWORDS,
+     "Wait until at least one alarm changes, or timeout seconds if it"
+     " isn't None, and return a list of (Subfeature, value) tuples for"
+     " the alarms that changed. The value is None if it can't be read."},
+    {"fileno", (PyCFunction)fileno_, METH_NOARGS,
+     "Return the file descriptor of the epoll set, which is readable when"
+     " an alarm changes."},
+    {"close", (PyCFunction)close_, METH_NOARGS,
+     "Close the files. The watcher can't be used anymore."},
+    {"__enter__", (PyCFunction)enter, METH_NOARGS,
+     "Return the watcher."},
+    {"__exit__", (PyCFunction)exit_, METH_VARARGS,
+     "Close the watcher."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef members[] =
+{
+    {"chip", T_OBJECT, offsetof(AlarmWatcher, chip), READONLY,
+     "The chip that is watched."},
+    {"subfeatures", T_OBJECT, offsetof(AlarmWatcher, subfeatures), READONLY,
+     "Tuple of the subfeatures that are watched."},
+    {NULL, 0, 0, 0, NULL}
+};
+
+PyTypeObject AlarmWatcherType =
+{
+    INIT_TYPE_HEAD
+    "sensors.AlarmWatcher",    /*tp_name*/
+    sizeof(AlarmWatcher),      /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    0,                         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "AlarmWatcher(chip, subfeatures=None)\n\n"
+    "Wait for the alarm attributes of chip to change, without polling."
+    " subfeatures is a sequence of Subfeature objects or numbers; by"
+    " default, all the *_alarm subfeatures of the chip are watched.",
+    /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    members,                   /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    (initproc)init,            /* tp_init */
+    0,                         /* tp_alloc */
+    new,                       /* tp_new */
+};
+
+
+static PyObject*
+new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    AlarmWatcher *self = (AlarmWatcher*)PyType_GenericNew(type, args,
+                                                          kwargs);
+
+    if (self != NULL)
+    {
+        self->epoll_fd = -1;
+    }
+
+    return (PyObject*)self;
+}
+
+static int
+init(AlarmWatcher *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"chip", "subfeatures", NULL};
+    ChipName *chip = NULL;
+    PyObject *py_subfeatures = Py_None;
+    int *numbers = NULL;
+    Py_ssize_t number_count = -1;
+    Alarm *alarms = NULL;
+    Py_ssize_t count = -1;
+    int found = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|O", kwlist,
+                                     &ChipNameType, &chip, &py_subfeatures))
+    {
+        return -1;
+    }
+
+    if (self->waiting > 0)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the watcher can't be reinitialized while waiting");
+        return -1;
+    }
+
+    if (chip_name_has_wildcards(&chip->chip_name))
+    {
+        PyErr_SetString(SensorsException,
+                        sensors_strerror(-SENSORS_ERR_WILDCARDS));
+        return -1;
+    }
+
+    if (py_subfeatures != Py_None &&
+        parse_numbers(py_subfeatures, &numbers, &number_count) < 0)
+    {
+        return -1;
+    }
+
+    close_all(self);
+
+    /* The Subfeature objects are created once the lock is released */
+    LOCK_SENSORS();
+    const sensors_chip_name *detected = resolve_chip(&chip->chip_name);
+
+    if (detected != NULL && detected->path != NULL)
+    {
+        found = 1;
+        count = find_alarms(detected, numbers, number_count, &alarms);
+    }
+
+    UNLOCK_SENSORS();
+    PyMem_Free(numbers);
+
+    if (found && count < 0)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    if (!found || (py_subfeatures != Py_None && count != number_count))
+    {
+        PyErr_SetString(SensorsException,
+                        sensors_strerror(-SENSORS_ERR_NO_ENTRY));
+        free_alarms(alarms, count);
+        return -1;
+    }
+
+    PyObject *subfeatures = PyTuple_New(count);
+
+    if (subfeatures == NULL)
+    {
+        free_alarms(alarms, count);
+        return -1;
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        PyObject *py_subfeature = topology_intern_subfeature(
+            &alarms[i].subfeature);
+
+        if (py_subfeature == NULL)
+        {
+            Py_DECREF(subfeatures);
+            free_alarms(alarms, count);
+            return -1;
+        }
+
+        PyTuple_SET_ITEM(subfeatures, i, py_subfeature);
+    }
+
+    Py_INCREF(chip);
+    self->chip = chip;
+    self->subfeatures = subfeatures;
+    self->fds = PyMem_Malloc((count + 1) * sizeof(int));
+    self->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (self->fds == NULL)
+    {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        self->fds[i] = -1;
+    }
+
+    if (self->epoll_fd < 0)
+    {
+        PyErr_SetFromErrno(PyExc_OSError);
+        goto error;
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        struct epoll_event event;
+        double value = 0.0;
+
+        memset(&event, 0, sizeof event);
+        event.events = EPOLLPRI | EPOLLERR;
+        event.data.u32 = (uint32_t)i;
+        self->fds[i] = open(alarms[i].path, O_RDONLY | O_CLOEXEC);
+
+        /* The attribute has to be read once to be armed */
+        if (self->fds[i] < 0 ||
+            epoll_ctl(self->epoll_fd, EPOLL_CTL_ADD, self->fds[i],
+                      &event) < 0)
+        {
+            PyErr_SetFromErrnoWithFilename(PyExc_OSError, alarms[i].path);
+            goto error;
+        }
+
+        read_alarm(self->fds[i], &value);
+    }
+
+    free_alarms(alarms, count);
+
+    return 0;
+
+error:
+    free_alarms(alarms, count);
+    close_all(self);
+    return -1;
+}
+
+static void
+dealloc(AlarmWatcher *self)
+{
+    close_all(self);
+    FREE_OBJECT(self);
+}
+
+static PyObject*
+repr(AlarmWatcher *self)
+{
+    return PyString_FromFormat(
+        "AlarmWatcher(alarms=%zd, closed=%s)",
+        self->subfeatures == NULL ? 0 : PyTuple_GET_SIZE(self->subfeatures),
+        self->epoll_fd < 0 ? "True" : "False");
+}
+
+static PyObject*
+wait_(AlarmWatcher *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"timeout", NULL};
+    PyObject *py_timeout = Py_None;
+    int64_t deadline = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist,
+                                     &py_timeout) ||
+        check_open(self) < 0)
+    {
+        return NULL;
+    }
+
+    if (py_timeout != Py_None)
+    {
+        double timeout = PyFloat_AsDouble(py_timeout);
+
+        if (timeout == -1.0 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        if (!(timeout >= 0.0) || !isfinite(timeout))
+        {
+            PyErr_SetString(PyExc_ValueError,
+                            "timeout must be positive or None");
+            return NULL;
+        }
+
+        deadline = clock_ns(CLOCK_MONOTONIC) + (int64_t)(timeout * 1e9);
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    double values[MAX_EVENTS];
+    int statuses[MAX_EVENTS];
+    int count = 0;
+    int error = 0;
+
+    self->waiting++;
+
+    for (;;)
+    {
+        int milliseconds = -1;
+
+        if (deadline >= 0)
+        {
+            int64_t remaining = deadline - clock_ns(CLOCK_MONOTONIC);
+
+            /* Rounded up, so that the timeout isn't cut short */
+            milliseconds = remaining <= 0 ? 0 :
+                remaining >= (int64_t)INT_MAX * 1000000 ? INT_MAX :
+                (int)((remaining + 999999) / 1000000);
+        }
+
+        Py_BEGIN_ALLOW_THREADS
+        count = epoll_wait(self->epoll_fd, events, MAX_EVENTS, milliseconds);
+        error = errno;
+
+        for (int i = 0; i < count; i++)
+        {
+            statuses[i] = read_alarm(self->fds[events[i].data.u32],
+                                     &values[i]);
+        }
+        Py_END_ALLOW_THREADS
+
+        if (count >= 0 || error != EINTR)
+        {
+            break;
+        }
+
+        if (PyErr_CheckSignals() < 0)
+        {
+            self->waiting--;
+            return NULL;
+        }
+    }
+
+    self->waiting--;
+
+    if (count < 0)
+    {
+        errno = error;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    PyObject *list = PyList_New(count);
+
+    if (list == NULL)
+    {
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        PyObject *item = NULL;
+
+        if (statuses[i] == 0)
+        {
+            item = Py_BuildValue(
+                "(Od)", PyTuple_GET_ITEM(self->subfeatures,
+                                         events[i].data.u32),
+                values[i]);
+        }
+        else
+        {
+            item = Py_BuildValue(
+                "(OO)", PyTuple_GET_ITEM(self->subfeatures,
+                                         events[i].data.u32),
+                Py_None);
+        }
+
+        if (item == NULL)
+        {
+            Py_DECREF(list);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(list, i, item);
+    }
+
+    return list;
+}
+
+static PyObject*
+fileno_(AlarmWatcher *self, PyObject *unused)
+{
+    (void)unused;
+
+    if (check_open(self) < 0)
+    {
+        return NULL;
+    }
+
+    return PyLong_FromLong(self->epoll_fd);
+}
+
+static PyObject*
+close_(AlarmWatcher *self, PyObject *unused)
+{
+    (void)unused;
+
+    if (self->waiting > 0)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the watcher can't be closed while waiting");
+        return NULL;
+    }
+
+    close_all(self);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+enter(AlarmWatcher *self, PyObject *unused)
+{
+    (void)unused;
+
+    Py_INCREF(self);
+
+    return (PyObject*)self;
+}
+
+static PyObject*
+exit_(AlarmWatcher *self, PyObject *args)
+{
+    (void)args;
+
+    return close_(self, NULL);
+}
+
+/**
+ * Convert a sequence of Subfeature objects or numbers to an array of
+ * numbers, to be freed with PyMem_Free().
+ */
+static int
+parse_numbers(PyObject *py_subfeatures, int **numbers, Py_ssize_t *count)
+{
+    PyObject *seq = PySequence_Fast(
+        py_subfeatures, "subfeatures must be a sequence of Subfeature");
+
+    if (seq == NULL)
+    {
+        return -1;
+    }
+
+    *count = PySequence_Fast_GET_SIZE(seq);
+    *numbers = PyMem_Malloc((*count + 1) * sizeof(int));
+
+    if (*numbers == NULL)
+    {
+        Py_DECREF(seq);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    for (Py_ssize_t i = 0; i < *count; i++)
+    {
+        PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+
+        if (PyObject_IsInstance(item, (PyObject*)&SubfeatureType))
+        {
+            (*numbers)[i] = ((Subfeature*)item)->subfeature.number;
+            continue;
+        }
+
+        long number = PyLong_AsLong(item);
+
+        if (number == -1 && PyErr_Occurred())
+        {
+            Py_DECREF(seq);
+            PyMem_Free(*numbers);
+            *numbers = NULL;
+            return -1;
+        }
+
+        (*numbers)[i] = (int)number;
+    }
+
+    Py_DECREF(seq);
+
+    return 0;
+}
+
+/**
+ * Store the alarm subfeatures of chip, and the paths of their
+ * attributes, in *alarms, and return how many there are, or -1 if
+ * memory couldn't be allocated. If numbers isn't NULL, the subfeatures
+ * are the ones with these numbers instead. sensors_lock must be held,
+ * so no Python object is created here.
+ */
+static Py_ssize_t
+find_alarms(const sensors_chip_name *chip, const int *numbers,
+            Py_ssize_t number_count, Alarm **alarms)
+{
+    const sensors_feature *feature = NULL;
+    int feature_nr = 0;
+    Py_ssize_t count = 0;
+    Py_ssize_t capacity = 0;
+
+    *alarms = NULL;
+
+    while ((feature = sensors_get_features(chip, &feature_nr)) != NULL)
+    {
+        const sensors_subfeature *subfeature = NULL;
+        int subfeature_nr = 0;
+
+        while ((subfeature = sensors_get_all_subfeatures(
+                    chip, feature, &subfeature_nr)) != NULL)
+        {
+            if (!is_alarm(subfeature, numbers, number_count))
+            {
+                continue;
+            }
+
+            if (count == capacity)
+            {
+                capacity = capacity == 0 ? 8 : capacity * 2;
+                Alarm *grown = PyMem_Realloc(*alarms,
+                                             capacity * sizeof(Alarm));
+
+                if (grown == NULL)
+                {
+                    goto error;
+                }
+
+                *alarms = grown;
+            }
+
+            Alarm *alarm = &(*alarms)[count];
+            size_t size = strlen(chip->path) + strlen(subfeature->name) + 2;
+
+            alarm->subfeature = *subfeature;
+            alarm->subfeature.name = PyMem_Malloc(strlen(subfeature->name) +
+                                                  1);
+            alarm->path = PyMem_Malloc(size);
+
+            if (alarm->subfeature.name == NULL || alarm->path == NULL)
+            {
+                PyMem_Free(alarm->subfeature.name);
+                PyMem_Free(alarm->path);
+                goto error;
+            }
+
+            strcpy(alarm->subfeature.name, subfeature->name);
+            snprintf(alarm->path, size, "%s/%s", chip->path,
+                     subfeature->name);
+            count++;
+        }
+    }
+
+    return count;
+
+error:
+    free_alarms(*alarms, count);
+    *alarms = NULL;
+    return -1;
+}
+
+/**
+ * Whether subfeature has to be watched: its number is in numbers, or
+ * it is a readable *_alarm attribute if numbers is NULL.
+ */
+static int
+is_alarm(const sensors_subfeature *subfeature, const int *numbers,
+         Py_ssize_t number_count)
+{
+    if (numbers != NULL)
+    {
+        for (Py_ssize_t i = 0; i < number_count; i++)
+        {
+            if (numbers[i] == subfeature->number)
+            {
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+    size_t length = strlen(subfeature->name);
+
+    return (subfeature->flags & SENSORS_MODE_R) && length > 6 &&
+        strcmp(subfeature->name + length - 6, "_alarm") == 0;
+}
+
+/**
+ * Read an alarm attribute from the start, which also rearms it. Return
+ * 0 or a libsensors error.
+ */
+static int
+read_alarm(int fd, double *value)
+{
+    char buffer[64];
+    ssize_t n = pread(fd, buffer, sizeof buffer - 1, 0);
+
+    if (n < 0)
+    {
+        return -SENSORS_ERR_KERNEL;
+    }
+
+    char *end = NULL;
+
+    buffer[n] = '\0';
+    *value = strtod(buffer, &end);
+
+    return end == buffer ? -SENSORS_ERR_ACCESS_R : 0;
+}
+
+static int
+check_open(AlarmWatcher *self)
+{
+    if (self->epoll_fd < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "the watcher is closed");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void
+close_all(AlarmWatcher *self)
+{
+    if (self->fds != NULL)
+    {
+        for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(self->subfeatures); i++)
+        {
+            if (self->fds[i] >= 0)
+            {
+                close(self->fds[i]);
+            }
+        }
+    }
+
+    if (self->epoll_fd >= 0)
+    {
+        close(self->epoll_fd);
+    }
+
+    PyMem_Free(self->fds);
+    self->fds = NULL;
+    self->epoll_fd = -1;
+    Py_CLEAR(self->chip);
+    Py_CLEAR(self->subfeatures);
+}
+
+static void
+free_alarms(Alarm *alarms, Py_ssize_t count)
+{
+    if (alarms == NULL)
+    {
+        return;
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        PyMem_Free(alarms[i].subfeature.name);
+        PyMem_Free(alarms[i].path);
+    }
+
+    PyMem_Free(alarms);
+}
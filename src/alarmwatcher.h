@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_ALARM_WATCHER
+#define H_ALARM_WATCHER
+
+#include <Python.h>
+
+#include "chipname.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject AlarmWatcherType;
+
+
+/*
+ * Waits for the alarm attributes of a chip to change.  The drivers
+ * call sysfs_notify() when an alarm changes, which wakes up poll() and
+ * epoll with POLLPRI, so all the attributes are registered in one
+ * epoll set.  An attribute has to be read again after each
+ * notification to be rearmed.
+ */
+typedef struct
+{
+    PyObject_HEAD
+    ChipName *chip;
+    PyObject *subfeatures;      /* Tuple of Subfeature */
+    int *fds;                   /* One per subfeature */
+    int epoll_fd;               /* -1 when closed */
+    int waiting;                /* Number of threads in wait() */
+} AlarmWatcher;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
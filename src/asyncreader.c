@@ -0,0 +1,567 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <sensors/sensors.h>
+#include <sensors/error.h>
+
+#include "sensorsmodule.h"
+#include "chipname.h"
+#include "subfeature.h"
+#include "asyncreader.h"
+#include "fastread.h"
+#include "stats.h"
+
+
+static PyObject* new(PyTypeObject*, PyObject*, PyObject*);
+static void dealloc(AsyncReader*);
+static PyObject* repr(AsyncReader*);
+static PyObject* submit(AsyncReader*, PyObject*, PyObject*);
+static PyObject* results(AsyncReader*, PyObject*);
+static PyObject* fileno_(AsyncReader*, PyObject*);
+static PyObject* close_(AsyncReader*, PyObject*);
+static int reserve(AsyncRead**, Py_ssize_t*, Py_ssize_t);
+static int is_running(AsyncReader*);
+static int start(AsyncReader*);
+static void join(AsyncReader*);
+static void reset_after_fork(AsyncReader*);
+static void* run(void*);
+static void free_reads(AsyncRead*, Py_ssize_t);
+
+
+static PyMethodDef methods[] = {
+    {"submit", (PyCFunction)submit, METH_VARARGS | METH_KEYWORDS,
+     "Queue a read of subfeature, a Subfeature or a subfeature number,"
+     " for chip, and return a token that identifies it in results()."
+     " The chip shouldn't contain wildcard values."},
+    {"results", (PyCFunction)results, METH_NOARGS,
+     "Return the reads that have completed since the last call, as a"
+     " list of (token, value, error) tuples. value is None and error is"
+     " the error message if the read failed, otherwise error is None."},
+    {"fileno", (PyCFunction)fileno_, METH_NOARGS,
+     "Return a file descriptor that is readable when results() has"
+     " something to return."},
+    {"close", (PyCFunction)close_, METH_NOARGS,
+     "Stop the thread and close the file descriptor. The reads that"
+     " haven't completed are discarded."},
+    {NULL, NULL, 0, NULL}
+};
+
+PyTypeObject AsyncReaderType =
+{
+    INIT_TYPE_HEAD
+    "sensors.AsyncReader",     /*tp_name*/
+    sizeof(AsyncReader),       /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    0,                         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "AsyncReader()\n\n"
+    "Read subfeatures on a native thread, and signal a file descriptor"
+    " when the values are available, so that an event loop can wait for"
+    " them without a thread per read.", /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    0,                         /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    0,                         /* tp_init */
+    0,                         /* tp_alloc */
+    new,                       /* tp_new */
+};
+
+
+static PyObject*
+new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, ":AsyncReader", kwlist))
+    {
+        return NULL;
+    }
+
+    AsyncReader *self = (AsyncReader*)PyType_GenericNew(type, args, kwargs);
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_init(&self->lock, NULL);
+    pthread_cond_init(&self->cond, NULL);
+    self->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (self->event_fd < 0)
+    {
+        PyErr_SetFromErrno(PyExc_OSError);
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return (PyObject*)self;
+}
+
+static void
+dealloc(AsyncReader *self)
+{
+    PyObject *result = close_(self, NULL);
+
+    Py_XDECREF(result);
+    pthread_cond_destroy(&self->cond);
+    pthread_mutex_destroy(&self->lock);
+    free_reads(self->pending, self->pending_size);
+    free_reads(self->work, self->work_size);
+    free_reads(self->done, self->done_size);
+    free(self->pending);
+    free(self->work);
+    free(self->done);
+    FREE_OBJECT(self);
+}
+
+static PyObject*
+repr(AsyncReader *self)
+{
+    return PyString_FromFormat("AsyncReader(outstanding=%zd, closed=%s)",
+                               self->outstanding,
+                               self->event_fd < 0 ? "True" : "False");
+}
+
+static PyObject*
+submit(AsyncReader *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"chip", "subfeature", NULL};
+    ChipName *chip = NULL;
+    PyObject *subfeature = NULL;
+    int number = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O", kwlist,
+                                     &ChipNameType, &chip, &subfeature))
+    {
+        return NULL;
+    }
+
+    if (PyObject_TypeCheck(subfeature, &SubfeatureType))
+    {
+        number = ((Subfeature*)subfeature)->subfeature.number;
+    }
+    else
+    {
+        long value = PyLong_AsLong(subfeature);
+
+        if (value == -1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        if (value < 0 || value > INT_MAX)
+        {
+            PyErr_SetString(SensorsException,
+                            sensors_strerror(-SENSORS_ERR_NO_ENTRY));
+            return NULL;
+        }
+
+        number = (int)value;
+    }
+
+    if (self->event_fd < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "the reader is closed");
+        return NULL;
+    }
+
+    char *prefix = NULL;
+
+    if (chip->chip_name.prefix != NULL)
+    {
+        prefix = strdup(chip->chip_name.prefix);
+
+        if (prefix == NULL)
+        {
+            return PyErr_NoMemory();
+        }
+    }
+
+    if (self->thread_pid != 0 && self->thread_pid != getpid())
+    {
+        reset_after_fork(self);
+    }
+
+    pthread_mutex_lock(&self->lock);
+
+    /* Every outstanding read has a slot in done, so that the thread
+     * never has to allocate */
+    if (reserve(&self->pending, &self->pending_capacity,
+                self->pending_size + 1) < 0 ||
+        reserve(&self->done, &self->done_capacity,
+                self->outstanding + 1) < 0)
+    {
+        pthread_mutex_unlock(&self->lock);
+        free(prefix);
+        return PyErr_NoMemory();
+    }
+
+    if (!is_running(self) && start(self) < 0)
+    {
+        pthread_mutex_unlock(&self->lock);
+        free(prefix);
+        return NULL;
+    }
+
+    AsyncRead *read = &self->pending[self->pending_size++];
+    unsigned long token = self->next_token++;
+
+    memset(read, 0, sizeof(*read));
+    read->chip_name.prefix = prefix;
+    read->chip_name.bus = chip->chip_name.bus;
+    read->chip_name.addr = chip->chip_name.addr;
+    read->number = number;
+    read->token = token;
+    self->outstanding++;
+    pthread_cond_signal(&self->cond);
+    pthread_mutex_unlock(&self->lock);
+
+    return PyLong_FromUnsignedLong(token);
+}
+
+static PyObject*
+results(AsyncReader *self, PyObject *unused)
+{
+    (void)unused;
+
+    /* Reset the event before taking the results: a read that completes
+     * after this signals it again */
+    if (self->event_fd >= 0)
+    {
+        uint64_t count;
+
+        if (read(self->event_fd, &count, sizeof(count)) < 0)
+        {
+            /* Nothing was pending */
+        }
+    }
+
+    pthread_mutex_lock(&self->lock);
+
+    PyObject *list = PyList_New(self->done_size);
+
+    for (Py_ssize_t i = 0; list != NULL && i < self->done_size; i++)
+    {
+        AsyncRead *read = &self->done[i];
+        PyObject *item = NULL;
+
+        if (read->status < 0)
+        {
+            item = Py_BuildValue("(kOs)", read->token, Py_None,
+                                 sensors_strerror(read->status));
+        }
+        else
+        {
+            item = Py_BuildValue("(kdO)", read->token, read->value, Py_None);
+        }
+
+        if (item == NULL)
+        {
+            Py_CLEAR(list);
+            break;
+        }
+
+        PyList_SET_ITEM(list, i, item);
+    }
+
+    if (list != NULL)
+    {
+        for (Py_ssize_t i = 0; i < self->done_size; i++)
+        {
+            AsyncRead *read = &self->done[i];
+
+            stats_record(&read->chip_name, STATS_GET_VALUE, read->elapsed,
+                         read->status);
+        }
+
+        free_reads(self->done, self->done_size);
+        self->outstanding -= self->done_size;
+        self->done_size = 0;
+    }
+
+    pthread_mutex_unlock(&self->lock);
+
+    return list;
+}
+
+static PyObject*
+fileno_(AsyncReader *self, PyObject *unused)
+{
+    (void)unused;
+
+    if (self->event_fd < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "the reader is closed");
+        return NULL;
+    }
+
+    return PyLong_FromLong(self->event_fd);
+}
+
+static PyObject*
+close_(AsyncReader *self, PyObject *unused)
+{
+    (void)unused;
+
+    if (is_running(self))
+    {
+        join(self);
+    }
+
+    if (self->event_fd >= 0)
+    {
+        close(self->event_fd);
+        self->event_fd = -1;
+    }
+
+    Py_RETURN_NONE;
+}
+
+/*
+ * Make sure that array can hold size reads. Return -1 if it can't be
+ * grown.
+ */
+static int
+reserve(AsyncRead **array, Py_ssize_t *capacity, Py_ssize_t size)
+{
+    if (size <= *capacity)
+    {
+        return 0;
+    }
+
+    Py_ssize_t new_capacity = *capacity < 16 ? 16 : *capacity;
+
+    while (new_capacity < size)
+    {
+        new_capacity *= 2;
+    }
+
+    if ((size_t)new_capacity > PY_SSIZE_T_MAX / sizeof(AsyncRead))
+    {
+        return -1;
+    }
+
+    AsyncRead *new_array = realloc(*array, new_capacity * sizeof(AsyncRead));
+
+    if (new_array == NULL)
+    {
+        return -1;
+    }
+
+    *array = new_array;
+    *capacity = new_capacity;
+
+    return 0;
+}
+
+/*
+ * Return 1 if the thread has been started and not stopped. After
+ * fork(), the thread only exists in the parent.
+ */
+static int
+is_running(AsyncReader *self)
+{
+    return self->thread_pid != 0 && self->thread_pid == getpid();
+}
+
+/*
+ * Start the thread. The lock must be held.
+ */
+static int
+start(AsyncReader *self)
+{
+    sigset_t all;
+    sigset_t old;
+    int error = 0;
+
+    self->stopping = 0;
+
+    /* The signals are handled by the Python threads, not this one */
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    error = pthread_create(&self->thread, NULL, run, self);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (error != 0)
+    {
+        errno = error;
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+
+    self->thread_pid = getpid();
+
+    return 0;
+}
+
+/*
+ * Tell the thread to stop, and wait for it. The GIL is released, since
+ * the thread may be waiting for sensors_lock, and whoever holds it may
+ * need the GIL.
+ */
+static void
+join(AsyncReader *self)
+{
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&self->lock);
+    self->stopping = 1;
+    pthread_cond_signal(&self->cond);
+    pthread_mutex_unlock(&self->lock);
+    pthread_join(self->thread, NULL);
+    Py_END_ALLOW_THREADS
+
+    self->thread_pid = 0;
+}
+
+/*
+ * In a child process, the thread is gone and may have left the lock
+ * held. The reads it was doing are lost.
+ */
+static void
+reset_after_fork(AsyncReader *self)
+{
+    pthread_mutex_init(&self->lock, NULL);
+    pthread_cond_init(&self->cond, NULL);
+    free_reads(self->work, self->work_size);
+    self->outstanding -= self->work_size;
+    self->work_size = 0;
+    self->thread_pid = 0;
+}
+
+static void*
+run(void *arg)
+{
+    AsyncReader *self = arg;
+
+    pthread_mutex_lock(&self->lock);
+
+    while (1)
+    {
+        while (!self->stopping && self->pending_size == 0)
+        {
+            pthread_cond_wait(&self->cond, &self->lock);
+        }
+
+        if (self->stopping)
+        {
+            break;
+        }
+
+        /* Take all the pending reads, and give the empty work array
+         * to submit() */
+        AsyncRead *reads = self->pending;
+        Py_ssize_t capacity = self->pending_capacity;
+
+        self->pending = self->work;
+        self->pending_capacity = self->work_capacity;
+        self->work = reads;
+        self->work_capacity = capacity;
+        self->work_size = self->pending_size;
+        self->pending_size = 0;
+        pthread_mutex_unlock(&self->lock);
+
+        pthread_rwlock_rdlock(&sensors_lock);
+
+        for (Py_ssize_t i = 0; i < self->work_size; i++)
+        {
+            AsyncRead *read = &self->work[i];
+            int64_t start = stats_start(STATS_GET_VALUE);
+
+            read->status = fast_read_get_value(&read->chip_name, read->number,
+                                               &read->value);
+            read->elapsed = stats_stop(start);
+        }
+
+        pthread_rwlock_unlock(&sensors_lock);
+        pthread_mutex_lock(&self->lock);
+
+        /* submit() reserved the room */
+        memcpy(self->done + self->done_size, self->work,
+               self->work_size * sizeof(AsyncRead));
+        self->done_size += self->work_size;
+        self->work_size = 0;
+
+        uint64_t one = 1;
+
+        if (write(self->event_fd, &one, sizeof(one)) < 0)
+        {
+            /* Already readable */
+        }
+    }
+
+    pthread_mutex_unlock(&self->lock);
+
+    return NULL;
+}
+
+static void
+free_reads(AsyncRead *reads, Py_ssize_t size)
+{
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        free(reads[i].chip_name.prefix);
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_ASYNC_READER
+#define H_ASYNC_READER
+
+#include <Python.h>
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#include <sensors/sensors.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject AsyncReaderType;
+
+
+/* A read submitted to an AsyncReader, and later its result */
+typedef struct
+{
+    sensors_chip_name chip_name; /* Copy of the chip, prefix included */
+    int number;
+    unsigned long token;
+    double value;
+    int status;
+    int64_t elapsed;            /* See stats_stop() */
+} AsyncRead;
+
+/*
+ * Reads subfeatures on a native thread for an event loop.  submit()
+ * queues a read and returns a token; the thread takes all the pending
+ * reads at once, does them under one hold of sensors_lock, moves them
+ * to the done list and signals event_fd.  results() then returns the
+ * completed reads with their tokens.  Compared to one executor job per
+ * read, the reads that are submitted together cost one wakeup.
+ */
+typedef struct
+{
+    PyObject_HEAD
+    pthread_mutex_t lock;       /* Protects everything below */
+    pthread_cond_t cond;        /* Signaled when reads are submitted */
+    AsyncRead *pending;
+    Py_ssize_t pending_size;
+    Py_ssize_t pending_capacity;
+    AsyncRead *work;            /* Being read by the thread */
+    Py_ssize_t work_size;
+    Py_ssize_t work_capacity;
+    AsyncRead *done;
+    Py_ssize_t done_size;
+    Py_ssize_t done_capacity;
+    Py_ssize_t outstanding;     /* Submitted and not returned yet */
+    unsigned long next_token;
+    int event_fd;               /* -1 when closed */
+    int stopping;
+
+    pthread_t thread;
+    pid_t thread_pid;           /* 0 when the thread isn't running */
+} AsyncReader;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
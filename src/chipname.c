@@ -30,6 +30,8 @@
 #include <Python.h>
 #include <structmember.h>
 
+#include <string.h>
+
 #include <sensors/sensors.h>
 #include <sensors/error.h>
 
@@ -37,9 +39,17 @@
 #include "chipname.h"
 #include "feature.h"
 #include "subfeature.h"
+#include "readings.h"
+#include "fastread.h"
+#include "probes.h"
+#include "stats.h"
+#include "topology.h"
 #include "utils.h"
 
 
+static PyObject* alloc(PyTypeObject*, Py_ssize_t);
+static int copy_string(const char*, char**, PyObject**);
+static int copy_name(ChipName*, sensors_chip_name*);
 static int init(ChipName*, PyObject*, PyObject*);
 static void dealloc(ChipName*);
 static PyObject* repr(ChipName*);
@@ -55,6 +65,8 @@ static PyObject* get_subfeature(ChipName*, PyObject*, PyObject*);
 static PyObject* get_label(ChipName*, PyObject*, PyObject*);
 static PyObject* get_value(ChipName*, PyObject*, PyObject*);
 static PyObject* get_value_or_none(ChipName*, PyObject*, PyObject*);
+static PyObject* aget_value(ChipName*, PyObject*, PyObject*);
+static PyObject* get_values(ChipName*, PyObject*, PyObject*);
 static PyObject* set_value(ChipName*, PyObject*, PyObject*);
 static PyObject* do_chip_sets(ChipName*, PyObject*);
 static PyObject* parse_chip_name(ChipName*, PyObject*, PyObject*);
@@ -74,13 +86,23 @@ static PyMethodDef methods[] = {
      " values."},
     {"get_value", (PyCFunction)get_value, METH_VARARGS | METH_KEYWORDS,
      "Return the value of a subfeature for the chip, as a"
-     " float. The chip shouldn't contain wildcard values."},
+     " float. The chip shouldn't contain wildcard values. See"
+     " set_fast_read() for a faster way to read values."},
     {"get_value_or_none",
      (PyCFunction)get_value_or_none,
      METH_VARARGS | METH_KEYWORDS,
      "Return the value of a subfeature for the chip as a"
      " float, or None if an error occurred. "
      "The chip shouldn't contain wildcard values."},
+    {"aget_value", (PyCFunction)aget_value, METH_VARARGS | METH_KEYWORDS,
+     "Return an awaitable for the value of a subfeature, which is read"
+     " by the AsyncReader of the running event loop. The chip shouldn't"
+     " contain wildcard values."},
+    {"get_values", (PyCFunction)get_values, METH_VARARGS | METH_KEYWORDS,
+     "Read all the subfeatures whose numbers are in the numbers sequence,"
+     " and return them as a Readings object. Errors don't raise"
+     " SensorsException; they are recorded in the Readings object instead."
+     " The chip shouldn't contain wildcard values."},
     {"set_value", (PyCFunction)set_value, METH_VARARGS | METH_KEYWORDS,
      "Set a value of the chip. The chip shouldn't contain wildcard"
      " values."},
@@ -108,6 +130,13 @@ static PyGetSetDef getsetters[] = {
     {NULL, NULL, NULL, NULL, NULL}
 };
 
+/* Deallocated objects kept for reuse, since many of them are created
+ * and freed when the chips are enumerated */
+#define FREE_LIST_SIZE 64
+
+static ChipName *free_list[FREE_LIST_SIZE];
+static int free_count = 0;
+
 PyTypeObject ChipNameType =
 {
     INIT_TYPE_HEAD
@@ -152,11 +181,57 @@ PyTypeObject ChipNameType =
     0,                         /* tp_descr_set */
     0,                         /* tp_dictoffset */
     (initproc)init,            /* tp_init */
-    0,                         /* tp_alloc */
+    alloc,                     /* tp_alloc */
     0,                         /* tp_new */
 };
 
 
+/**
+ * Create a ChipName object with a copy of name, without going through
+ * __init__().
+ */
+ChipName* chip_name_new(const sensors_chip_name *name)
+{
+    ChipName *self = (ChipName*)alloc(&ChipNameType, 0);
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    self->chip_name = *name;
+    self->chip_name.prefix = NULL;
+    self->chip_name.path = NULL;
+
+    if (copy_string(name->prefix, &self->chip_name.prefix,
+                    &self->py_prefix) < 0 ||
+        copy_string(name->path, &self->chip_name.path, &self->py_path) < 0)
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+/**
+ * tp_alloc, which takes the object from the free list when it can.
+ */
+static PyObject*
+alloc(PyTypeObject *type, Py_ssize_t nitems)
+{
+    if (type != &ChipNameType || free_count == 0)
+    {
+        return PyType_GenericAlloc(type, nitems);
+    }
+
+    ChipName *self = free_list[--free_count];
+
+    memset(self, 0, sizeof(ChipName));
+
+    return PyObject_INIT(self, type);
+}
+
 static int
 init(ChipName *self, PyObject *args, PyObject *kwargs)
 {
@@ -230,11 +305,18 @@ dealloc(ChipName *self)
 {
     free(self->chip_name.prefix);
     self->chip_name.prefix = NULL;
-    Py_DECREF(self->py_prefix);
+    Py_XDECREF(self->py_prefix);
     free(self->chip_name.path);
     self->chip_name.path = NULL;
-    Py_DECREF(self->py_path);
-    FREE_OBJECT(self);
+    Py_XDECREF(self->py_path);
+    if (Py_TYPE(self) == &ChipNameType && free_count < FREE_LIST_SIZE)
+    {
+        free_list[free_count++] = self;
+    }
+    else
+    {
+        FREE_OBJECT(self);
+    }
 }
 
 static PyObject*
@@ -428,56 +510,21 @@ set_path(ChipName *self, PyObject *value, void *closure)
 static PyObject*
 get_features(ChipName *self, PyObject *args)
 {
-    PyObject *list = PyList_New(0);
-    int n = 0;
-
     (void)args;
 
-    while (1)
-    {
-        const sensors_feature *feature = sensors_get_features(&self->chip_name,
-                                                              &n);
-        if (feature == NULL)
-        {
-            break;
-        }
-        else
-        {
-            /* Some internal fields are not accessible with
-             * __init__(), so we need to copy them ourselves.  We
-             * bypass __init__() altogether. */
-            Feature *py_feature = PyObject_New(Feature,
-                                               &FeatureType);
+    int64_t start = stats_start(STATS_GET_FEATURES);
+    PyObject *features = topology_get_features(&self->chip_name);
+    stats_record(&self->chip_name, STATS_GET_FEATURES, stats_stop(start),
+                 features == NULL ? STATS_FAILED : 0);
 
-            if (py_feature == NULL)
-            {
-                goto error;
-            }
-
-            py_feature->feature = *feature;
-
-            /* Duplicate the name string, so that destructors won't
-             * end up freeing the same string pointer multiple
-             * times. */
-            py_feature->feature.name = strdup(feature->name);
-            py_feature->py_name = PyString_FromString(feature->name);
-            PyList_Append(list, (PyObject*)py_feature);
-            Py_DECREF(py_feature);
-        }
-    }
-
-    return list;
-
-error:
-    Py_DECREF(list);
-    return NULL;
+    return features;
 }
 
 static PyObject*
 get_all_subfeatures(ChipName *self, PyObject *args, PyObject *kwargs)
 {
     char *kwlist[] = {"feature", NULL};
-    Feature *feature = NULL;    
+    Feature *feature = NULL;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!", kwlist,
                                      &FeatureType, &feature))
@@ -485,50 +532,13 @@ get_all_subfeatures(ChipName *self, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    PyObject *list = PyList_New(0);
-    int n = 0;
+    int64_t start = stats_start(STATS_GET_ALL_SUBFEATURES);
+    PyObject *subfeatures = topology_get_subfeatures(&self->chip_name,
+                                                     &feature->feature);
+    stats_record(&self->chip_name, STATS_GET_ALL_SUBFEATURES,
+                 stats_stop(start), subfeatures == NULL ? STATS_FAILED : 0);
 
-    while (1)
-    {
-        const sensors_subfeature *subfeature = sensors_get_all_subfeatures(
-            &self->chip_name, &feature->feature, &n);
-
-        if (subfeature == NULL)
-        {
-            break;
-        }
-        else
-        {
-            PyObject *subfeature_args = Py_BuildValue(
-                "siiiI",
-                subfeature->name, subfeature->number, subfeature->type,
-                subfeature->mapping, subfeature->flags);
-
-            if (subfeature_args == NULL)
-            {
-                goto error;
-            }
-
-            PyObject *py_subfeature = PyObject_CallObject(
-                (PyObject*)&SubfeatureType,
-                subfeature_args);
-            Py_DECREF(subfeature_args);
-
-            if (py_subfeature == NULL)
-            {
-                goto error;
-            }
-
-            PyList_Append(list, py_subfeature);
-            Py_DECREF(py_subfeature);
-        }
-    }
-
-    return list;
-
-error:
-    Py_DECREF(list);
-    return NULL;
+    return subfeatures;
 }
 
 static PyObject*
@@ -544,26 +554,13 @@ get_subfeature(ChipName *self, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    const sensors_subfeature *subfeature = sensors_get_subfeature(
-        &self->chip_name, &feature->feature, type);
-
-    if (subfeature == NULL)
-    {
-        Py_RETURN_NONE;
-    }
-
-    Subfeature *py_subfeature = PyObject_New(Subfeature, &SubfeatureType);
-
-    if (py_subfeature == NULL)
-    {
-        return NULL;
-    }
-
-    py_subfeature->subfeature = *subfeature;
-    py_subfeature->subfeature.name = strdup(subfeature->name);
-    py_subfeature->py_name = PyString_FromString(subfeature->name);
+    int64_t start = stats_start(STATS_GET_SUBFEATURE);
+    PyObject *subfeature = topology_get_subfeature(&self->chip_name,
+                                                   &feature->feature, type);
+    stats_record(&self->chip_name, STATS_GET_SUBFEATURE, stats_stop(start),
+                 subfeature == NULL ? STATS_FAILED : 0);
 
-    return (PyObject*)py_subfeature;
+    return subfeature;
 }
 
 static PyObject*
@@ -578,19 +575,12 @@ get_label(ChipName *self, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    char *label = sensors_get_label(&self->chip_name, &feature->feature);
+    int64_t start = stats_start(STATS_GET_LABEL);
+    PyObject *label = topology_get_label(&self->chip_name, &feature->feature);
+    stats_record(&self->chip_name, STATS_GET_LABEL, stats_stop(start),
+                 label == NULL ? STATS_FAILED : 0);
 
-    if (label == NULL)
-    {
-        PyErr_SetString(SensorsException,
-                        "sensors_get_label() returned NULL");
-        return NULL;
-    }
-
-    PyObject *py_label = PyString_FromString(label);
-    free(label);
-
-    return py_label;
+    return label;
 }
 
 static PyObject*
@@ -605,7 +595,24 @@ get_value(ChipName *self, PyObject *args, PyObject *kwargs)
     }
 
     double value = 0.0;
-    int status = sensors_get_value(&self->chip_name, subfeat_nr, &value);
+    int status = 0;
+    int64_t elapsed = 0;
+    sensors_chip_name name;
+
+    if (copy_name(self, &name) < 0)
+    {
+        return NULL;
+    }
+
+    BEGIN_SENSORS_IO
+    int64_t start = stats_start(STATS_GET_VALUE);
+    status = fast_read_get_value(&name, subfeat_nr, &value);
+    elapsed = stats_stop(start);
+    END_SENSORS_IO
+
+    free_chip_name(&name);
+
+    stats_record(&self->chip_name, STATS_GET_VALUE, elapsed, status);
 
     if (status < 0)
     {
@@ -647,6 +654,171 @@ get_value_or_none(ChipName *self, PyObject *args, PyObject *kwargs)
     }
 }
 
+static PyObject*
+aget_value(ChipName *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"subfeat_nr", NULL};
+    int subfeat_nr = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i", kwlist, &subfeat_nr))
+    {
+        return NULL;
+    }
+
+    PyObject *call_args = Py_BuildValue("(Oi)", self, subfeat_nr);
+
+    if (call_args == NULL)
+    {
+        return NULL;
+    }
+
+    PyObject *result = call_async("get_value", call_args, NULL);
+
+    Py_DECREF(call_args);
+
+    return result;
+}
+
+static PyObject*
+get_values(ChipName *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"numbers", NULL};
+    PyObject *numbers = NULL;
+    Py_buffer view;
+    int *buffer_numbers = NULL;
+    PyObject *seq = NULL;
+    Py_ssize_t size = 0;
+    int64_t *elapsed = NULL;
+    sensors_chip_name name = {NULL, {0, 0}, 0, NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &numbers))
+    {
+        return NULL;
+    }
+
+    /* Arrays of C ints (e.g. array.array('i')) are read in place,
+     * anything else goes through the sequence protocol. */
+    if (PyObject_CheckBuffer(numbers) &&
+        PyObject_GetBuffer(numbers, &view,
+                           PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) == 0)
+    {
+        if (view.itemsize == sizeof(int) && view.format != NULL &&
+            strcmp(view.format, "i") == 0)
+        {
+            buffer_numbers = view.buf;
+            size = view.len / view.itemsize;
+        }
+        else
+        {
+            PyBuffer_Release(&view);
+        }
+    }
+    else
+    {
+        PyErr_Clear();
+    }
+
+    if (buffer_numbers == NULL)
+    {
+        seq = PySequence_Fast(numbers, "numbers must be a sequence of ints");
+
+        /* The parsing may run Python code, which could change a list */
+        if (seq != NULL && PyList_Check(seq))
+        {
+            PyObject *tuple = PyList_AsTuple(seq);
+
+            Py_DECREF(seq);
+            seq = tuple;
+        }
+
+        if (seq == NULL)
+        {
+            return NULL;
+        }
+
+        size = PySequence_Fast_GET_SIZE(seq);
+    }
+
+    Readings *readings = readings_new(size);
+
+    if (readings == NULL)
+    {
+        goto error;
+    }
+
+    /* The durations of the reads, recorded once the GIL is back */
+    elapsed = PyMem_Malloc((size + 1) * sizeof *elapsed);
+
+    if (elapsed == NULL)
+    {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    if (buffer_numbers == NULL)
+    {
+        /* The statuses array holds the numbers until the values are
+         * read, so that the GIL can be released during the reads. */
+        for (Py_ssize_t i = 0; i < size; i++)
+        {
+            if (parse_subfeature_number(PySequence_Fast_GET_ITEM(seq, i),
+                                        &readings->statuses[i]) < 0)
+            {
+                goto error;
+            }
+        }
+    }
+
+    if (copy_name(self, &name) < 0)
+    {
+        goto error;
+    }
+
+    BEGIN_SENSORS_IO
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        int subfeat_nr = buffer_numbers != NULL ?
+            buffer_numbers[i] : readings->statuses[i];
+        int64_t start = stats_start(STATS_GET_VALUE);
+        int status = fast_read_get_value(&name, subfeat_nr,
+                                         &readings->values[i]);
+        elapsed[i] = stats_stop(start);
+        readings->statuses[i] = status < 0 ? status : 0;
+    }
+    END_SENSORS_IO
+
+    free_chip_name(&name);
+
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        stats_record(&self->chip_name, STATS_GET_VALUE, elapsed[i],
+                     readings->statuses[i]);
+    }
+
+    PyMem_Free(elapsed);
+
+    if (buffer_numbers != NULL)
+    {
+        PyBuffer_Release(&view);
+    }
+
+    Py_XDECREF(seq);
+
+    return (PyObject*)readings;
+
+error:
+    if (buffer_numbers != NULL)
+    {
+        PyBuffer_Release(&view);
+    }
+
+    Py_XDECREF(seq);
+    Py_XDECREF(readings);
+    PyMem_Free(elapsed);
+    free_chip_name(&name);
+    return NULL;
+}
+
 static PyObject*
 set_value(ChipName *self, PyObject *args, PyObject *kwargs)
 {
@@ -660,7 +832,26 @@ set_value(ChipName *self, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    int status = sensors_set_value(&self->chip_name, subfeat_nr, value);
+    int status = 0;
+    int64_t elapsed = 0;
+    sensors_chip_name name;
+
+    if (copy_name(self, &name) < 0)
+    {
+        return NULL;
+    }
+
+    BEGIN_SENSORS_WRITE
+    int64_t start = stats_start(STATS_SET_VALUE);
+    PROBE_CHIP1(set_value__entry, &name, subfeat_nr);
+    status = sensors_set_value(&name, subfeat_nr, value);
+    PROBE_CHIP2(set_value__return, &name, subfeat_nr, status);
+    elapsed = stats_stop(start);
+    END_SENSORS_WRITE
+
+    free_chip_name(&name);
+
+    stats_record(&self->chip_name, STATS_SET_VALUE, elapsed, status);
 
     if (status < 0)
     {
@@ -676,7 +867,21 @@ do_chip_sets(ChipName *self, PyObject *args)
 {
     (void)args;
 
-    int status = sensors_do_chip_sets(&self->chip_name);
+    int status = 0;
+    sensors_chip_name name;
+
+    if (copy_name(self, &name) < 0)
+    {
+        return NULL;
+    }
+
+    BEGIN_SENSORS_WRITE
+    PROBE_CHIP(do_chip_sets__entry, &name);
+    status = sensors_do_chip_sets(&name);
+    PROBE_CHIP1(do_chip_sets__return, &name, status);
+    END_SENSORS_WRITE
+
+    free_chip_name(&name);
 
     if (status < 0)
     {
@@ -713,48 +918,60 @@ parse_chip_name(ChipName *self, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    ChipName *py_chip_name = PyObject_New(ChipName, &ChipNameType);
+    /* The strings are duplicated, because name is supposed to be
+     * freed by sensors_free_chip_name(), instead of our own
+     * destructor. */
+    ChipName *py_chip_name = chip_name_new(&name);
 
-    if (py_chip_name == NULL)
-    {
-        return NULL;
-    }
+    sensors_free_chip_name(&name);
 
-    /*
-     * Copy the content of the obtained name into py_chip_name.  We
-     * duplicate the strings, because name is supposed to freed by
-     * sensors_free_chip_name(), instead of our own destructor.
-     * Looking at the code of libsensors, it seems that it would
-     * actually work just fine if our destructor cleaned it up, but I
-     * prefer to be on the safe side.
-     */
-    py_chip_name->chip_name = name;
+    return (PyObject*)py_chip_name;
+}
 
-    if (name.prefix == NULL)
-    {
-        py_chip_name->chip_name.prefix = NULL;
-        py_chip_name->py_prefix = Py_None;
-        Py_INCREF(py_chip_name->py_prefix);
-    }
-    else
+/*
+ * Copy the name of self, with its own strings, so that it can be used
+ * while the GIL is released: set_prefix() and set_path() free the
+ * strings of the object. Return -1 and set an exception on failure.
+ */
+static int
+copy_name(ChipName *self, sensors_chip_name *name)
+{
+    if (copy_chip_name(&self->chip_name, name) < 0)
     {
-        py_chip_name->chip_name.prefix = strdup(name.prefix);
-        py_chip_name->py_prefix = PyString_FromString(name.prefix);
+        PyErr_NoMemory();
+        return -1;
     }
 
-    if (name.path == NULL)
+    return 0;
+}
+
+/**
+ * Set *copy to a copy of string, and *py_string to a Python string with
+ * the same content, or None if string is NULL.
+ */
+static int
+copy_string(const char *string, char **copy, PyObject **py_string)
+{
+    if (string == NULL)
     {
-        py_chip_name->chip_name.path = NULL;
-        py_chip_name->py_path = Py_None;
-        Py_INCREF(py_chip_name->py_path);
+        *copy = NULL;
+        *py_string = Py_None;
+        Py_INCREF(Py_None);
+        return 0;
     }
-    else
+
+    *copy = strdup(string);
+    *py_string = PyString_FromString(string);
+
+    if (*copy == NULL || *py_string == NULL)
     {
-        py_chip_name->chip_name.path = strdup(name.path);
-        py_chip_name->py_path = PyString_FromString(name.path);
-    }
+        if (*py_string != NULL)
+        {
+            PyErr_NoMemory();
+        }
 
-    sensors_free_chip_name(&name);
+        return -1;
+    }
 
-    return (PyObject*)py_chip_name;
+    return 0;
 }
@@ -50,6 +50,8 @@ typedef struct
     PyObject *py_path;
 } ChipName;
 
+ChipName* chip_name_new(const sensors_chip_name*);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,644 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * libsensors doesn't expose the compute statements of its
+ * configuration, and the fast read mode must not bypass them, so the
+ * configuration is scanned for them here.  Only the chip and compute
+ * statements matter: the feature named by each compute statement is
+ * recorded along with the chip names of the chip statement above it.
+ * This errs on the side of libsensors: the bus numbers aren't compared,
+ * since the bus statements can renumber the I2C buses, and when a file
+ * can't be read, every feature is taken as computed.
+ */
+
+#define _GNU_SOURCE
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "computes.h"
+
+/* The files read by sensors_init(NULL), as in lib/init.c */
+#define CONFIG_FILE "/etc/sensors3.conf"
+#define ALT_CONFIG_FILE "/etc/sensors.conf"
+#define CONFIG_DIR "/etc/sensors.d"
+#define READ_SIZE 4096
+
+
+/* A chip statement and the compute statements that follow it */
+typedef struct
+{
+    sensors_chip_name *chips;   /* NULL for a compute before any chip */
+    int chip_count;
+    char **features;
+    int feature_count;
+} ComputeBlock;
+
+typedef struct
+{
+    const char *position;
+    const char *end;
+} Scanner;
+
+
+static char* read_file(FILE*, size_t*);
+static int parse(const char*, size_t);
+static int next_statement(Scanner*);
+static void skip_statement(Scanner*);
+static void skip_comment(Scanner*);
+static int next_token(Scanner*, char**);
+static int add_block(void);
+static int add_chip(const char*);
+static int add_feature(const char*);
+static int matches(const sensors_chip_name*, const sensors_chip_name*);
+static void load_path(const char*);
+static int is_config_file(const struct dirent*);
+
+
+static ComputeBlock *blocks = NULL;
+static int block_count = 0;
+/* Set when a file couldn't be read: every feature may then have a
+ * compute statement */
+static int unknown = 0;
+
+
+/**
+ * Replace the compute statements with the ones of file, which is read
+ * from the start.
+ */
+void computes_load(FILE *file)
+{
+    computes_clear();
+
+    if (fseek(file, 0, SEEK_SET) != 0)
+    {
+        unknown = 1;
+        return;
+    }
+
+    size_t size = 0;
+    char *content = read_file(file, &size);
+
+    if (content == NULL || parse(content, size) < 0)
+    {
+        unknown = 1;
+    }
+
+    free(content);
+}
+
+/**
+ * Replace the compute statements with the ones of the files that
+ * sensors_init(NULL) reads.
+ */
+void computes_load_default(void)
+{
+    computes_clear();
+
+    FILE *file = fopen(CONFIG_FILE, "r");
+
+    if (file == NULL && errno == ENOENT)
+    {
+        file = fopen(ALT_CONFIG_FILE, "r");
+    }
+
+    if (file != NULL)
+    {
+        size_t size = 0;
+        char *content = read_file(file, &size);
+
+        if (content == NULL || parse(content, size) < 0)
+        {
+            unknown = 1;
+        }
+
+        free(content);
+        fclose(file);
+    }
+    else if (errno != ENOENT)
+    {
+        unknown = 1;
+    }
+
+    struct dirent **entries = NULL;
+    int count = scandir(CONFIG_DIR, &entries, is_config_file, alphasort);
+
+    if (count < 0)
+    {
+        if (errno != ENOENT)
+        {
+            unknown = 1;
+        }
+
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        size_t size = strlen(CONFIG_DIR) + strlen(entries[i]->d_name) + 2;
+        char *path = malloc(size);
+
+        if (path == NULL)
+        {
+            unknown = 1;
+        }
+        else
+        {
+            snprintf(path, size, "%s/%s", CONFIG_DIR, entries[i]->d_name);
+            load_path(path);
+            free(path);
+        }
+
+        free(entries[i]);
+    }
+
+    free(entries);
+}
+
+/**
+ * Forget the compute statements.
+ */
+void computes_clear(void)
+{
+    for (int i = 0; i < block_count; i++)
+    {
+        for (int c = 0; c < blocks[i].chip_count; c++)
+        {
+            sensors_free_chip_name(&blocks[i].chips[c]);
+        }
+
+        for (int f = 0; f < blocks[i].feature_count; f++)
+        {
+            free(blocks[i].features[f]);
+        }
+
+        free(blocks[i].chips);
+        free(blocks[i].features);
+    }
+
+    free(blocks);
+    blocks = NULL;
+    block_count = 0;
+    unknown = 0;
+}
+
+/**
+ * Return 1 if a compute statement may apply to the given feature of
+ * chip, and 0 if none does.
+ */
+int computes_find(const sensors_chip_name *chip, const char *feature)
+{
+    if (unknown)
+    {
+        return 1;
+    }
+
+    for (int i = 0; i < block_count; i++)
+    {
+        const ComputeBlock *block = &blocks[i];
+        int chip_matches = block->chips == NULL;
+
+        for (int c = 0; c < block->chip_count && !chip_matches; c++)
+        {
+            chip_matches = matches(&block->chips[c], chip);
+        }
+
+        for (int f = 0; f < block->feature_count && chip_matches; f++)
+        {
+            if (strcmp(block->features[f], feature) == 0)
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Return the whole content of file, or NULL if it couldn't be read */
+static char*
+read_file(FILE *file, size_t *size)
+{
+    char *content = NULL;
+    size_t capacity = 0;
+
+    *size = 0;
+
+    do
+    {
+        if (capacity - *size < READ_SIZE)
+        {
+            char *new_content = realloc(content, capacity + READ_SIZE);
+
+            if (new_content == NULL)
+            {
+                free(content);
+                return NULL;
+            }
+
+            content = new_content;
+            capacity += READ_SIZE;
+        }
+
+        *size += fread(content + *size, 1, capacity - *size, file);
+    } while (!feof(file) && !ferror(file));
+
+    if (ferror(file))
+    {
+        free(content);
+        return NULL;
+    }
+
+    return content;
+}
+
+/*
+ * Record the chip and compute statements of a configuration. Return
+ * -1 if memory couldn't be allocated or if a compute statement
+ * couldn't be parsed.
+ */
+static int
+parse(const char *content, size_t size)
+{
+    Scanner scanner = {content, content + size};
+    char *keyword = NULL;
+    char *name = NULL;
+    int status = 0;
+
+    while (status >= 0 && next_statement(&scanner))
+    {
+        status = next_token(&scanner, &keyword);
+
+        if (status <= 0)
+        {
+            skip_statement(&scanner);
+            continue;
+        }
+
+        if (strcmp(keyword, "chip") == 0)
+        {
+            status = add_block();
+
+            while (status >= 0 &&
+                   (status = next_token(&scanner, &name)) > 0)
+            {
+                status = add_chip(name);
+                free(name);
+            }
+        }
+        else if (strcmp(keyword, "compute") == 0)
+        {
+            /* The feature name is the first argument */
+            status = next_token(&scanner, &name);
+
+            if (status > 0)
+            {
+                status = add_feature(name);
+                free(name);
+            }
+            else
+            {
+                status = -1;
+            }
+        }
+
+        free(keyword);
+        skip_statement(&scanner);
+    }
+
+    return status < 0 ? -1 : 0;
+}
+
+/*
+ * Skip the blank and comment lines up to the next statement. Return 0
+ * at the end.
+ */
+static int
+next_statement(Scanner *scanner)
+{
+    while (scanner->position < scanner->end)
+    {
+        char c = *scanner->position;
+
+        if (c == '#')
+        {
+            skip_comment(scanner);
+        }
+        else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            scanner->position++;
+        }
+        else
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Skip the rest of the current statement, which may be continued on
+ * the next lines with a backslash */
+static void
+skip_statement(Scanner *scanner)
+{
+    int continued = 0;
+    int quoted = 0;
+
+    while (scanner->position < scanner->end)
+    {
+        char c = *scanner->position++;
+
+        if (quoted)
+        {
+            if (c == '\\' && scanner->position < scanner->end)
+            {
+                scanner->position++;
+            }
+            else if (c == '"')
+            {
+                quoted = 0;
+            }
+        }
+        else if (c == '"')
+        {
+            quoted = 1;
+            continued = 0;
+        }
+        else if (c == '#')
+        {
+            skip_comment(scanner);
+        }
+        else if (c == '\n')
+        {
+            if (!continued)
+            {
+                return;
+            }
+
+            continued = 0;
+        }
+        else if (c == '\\')
+        {
+            continued = 1;
+        }
+        else if (c != ' ' && c != '\t' && c != '\r')
+        {
+            continued = 0;
+        }
+    }
+}
+
+static void
+skip_comment(Scanner *scanner)
+{
+    while (scanner->position < scanner->end && *scanner->position != '\n')
+    {
+        scanner->position++;
+    }
+}
+
+/*
+ * Read the next name or string of the current statement into token,
+ * which must be freed. Return 1, 0 at the end of the statement, or -1
+ * if memory couldn't be allocated.
+ */
+static int
+next_token(Scanner *scanner, char **token)
+{
+    /* Separators, and the continued lines */
+    while (scanner->position < scanner->end)
+    {
+        char c = *scanner->position;
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == ',')
+        {
+            scanner->position++;
+        }
+        else if (c == '\\' && scanner->position + 1 < scanner->end &&
+                 scanner->position[1] == '\n')
+        {
+            scanner->position += 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (scanner->position >= scanner->end || *scanner->position == '\n' ||
+        *scanner->position == '#')
+    {
+        return 0;
+    }
+
+    int quoted = *scanner->position == '"';
+    const char *start = scanner->position + quoted;
+    const char *end = start;
+
+    if (quoted)
+    {
+        while (end < scanner->end && *end != '"')
+        {
+            end += *end == '\\' && end + 1 < scanner->end ? 2 : 1;
+        }
+    }
+    else
+    {
+        while (end < scanner->end && strchr(" \t\r\n,#\"\\", *end) == NULL)
+        {
+            end++;
+        }
+
+        if (end == start)
+        {
+            /* A stray backslash */
+            return 0;
+        }
+    }
+
+    *token = malloc(end - start + 1);
+
+    if (*token == NULL)
+    {
+        return -1;
+    }
+
+    size_t length = 0;
+
+    for (const char *c = start; c < end; c++)
+    {
+        if (quoted && *c == '\\' && c + 1 < end)
+        {
+            c++;
+        }
+
+        (*token)[length++] = *c;
+    }
+
+    (*token)[length] = '\0';
+    /* Past the closing quote */
+    scanner->position = end < scanner->end ? end + quoted : end;
+
+    return 1;
+}
+
+static int
+add_block(void)
+{
+    ComputeBlock *new_blocks = realloc(blocks,
+                                       (block_count + 1) * sizeof *blocks);
+
+    if (new_blocks == NULL)
+    {
+        return -1;
+    }
+
+    blocks = new_blocks;
+    blocks[block_count++] = (ComputeBlock){NULL, 0, NULL, 0};
+
+    return 0;
+}
+
+static int
+add_chip(const char *name)
+{
+    ComputeBlock *block = &blocks[block_count - 1];
+    sensors_chip_name *new_chips = realloc(
+        block->chips, (block->chip_count + 1) * sizeof *block->chips);
+
+    if (new_chips == NULL)
+    {
+        return -1;
+    }
+
+    block->chips = new_chips;
+    sensors_chip_name *chip = &block->chips[block->chip_count];
+
+    if (sensors_parse_chip_name(name, chip) != 0)
+    {
+        /* libsensors rejects the file, but match any chip anyway */
+        chip->prefix = SENSORS_CHIP_NAME_PREFIX_ANY;
+        chip->bus.type = SENSORS_BUS_TYPE_ANY;
+        chip->bus.nr = SENSORS_BUS_NR_ANY;
+        chip->addr = SENSORS_CHIP_NAME_ADDR_ANY;
+        chip->path = NULL;
+    }
+
+    block->chip_count++;
+
+    return 0;
+}
+
+static int
+add_feature(const char *feature)
+{
+    /* A compute before any chip statement applies to every chip */
+    if (block_count == 0 && add_block() < 0)
+    {
+        return -1;
+    }
+
+    ComputeBlock *block = &blocks[block_count - 1];
+    char **new_features = realloc(
+        block->features, (block->feature_count + 1) * sizeof(char*));
+
+    if (new_features == NULL)
+    {
+        return -1;
+    }
+
+    block->features = new_features;
+    block->features[block->feature_count] = strdup(feature);
+
+    if (block->features[block->feature_count] == NULL)
+    {
+        return -1;
+    }
+
+    block->feature_count++;
+
+    return 0;
+}
+
+/* Return 1 if chip may match pattern, ignoring the bus number */
+static int
+matches(const sensors_chip_name *pattern, const sensors_chip_name *chip)
+{
+    return (pattern->prefix == SENSORS_CHIP_NAME_PREFIX_ANY ||
+            strcmp(pattern->prefix, chip->prefix) == 0) &&
+        (pattern->bus.type == SENSORS_BUS_TYPE_ANY ||
+         pattern->bus.type == chip->bus.type) &&
+        (pattern->addr == SENSORS_CHIP_NAME_ADDR_ANY ||
+         pattern->addr == chip->addr);
+}
+
+/* Add the compute statements of a file of CONFIG_DIR */
+static void
+load_path(const char *path)
+{
+    struct stat st;
+    FILE *file = NULL;
+
+    /* Like libsensors, skip everything but the regular files */
+    if (stat(path, &st) == 0 && !S_ISREG(st.st_mode))
+    {
+        return;
+    }
+
+    file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        unknown = 1;
+        return;
+    }
+
+    size_t size = 0;
+    char *content = read_file(file, &size);
+
+    if (content == NULL || parse(content, size) < 0)
+    {
+        unknown = 1;
+    }
+
+    free(content);
+    fclose(file);
+}
+
+static int
+is_config_file(const struct dirent *entry)
+{
+    /* Hidden files are skipped by libsensors too */
+    return entry->d_name[0] != '.';
+}
@@ -0,0 +1,691 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Optional replacement for sensors_get_value().  libsensors opens,
+ * reads and closes the sysfs attribute on every call; here each
+ * attribute is opened once and read with pread(), which saves two
+ * system calls and a path lookup per read.
+ *
+ * The scaling is the same as in libsensors (see get_type_scaling() in
+ * lib/sysfs.c).  A subfeature that a compute statement of the
+ * configuration may apply to is always read with libsensors; see
+ * computes.c.
+ *
+ * fast_read_many() reads a whole set of attributes at once, with
+ * io_uring when it is available.
+ */
+
+#include <Python.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sensors/sensors.h>
+#include <sensors/error.h>
+
+#include "sensorsmodule.h"
+#include "computes.h"
+#include "fastread.h"
+#include "pool.h"
+#include "probes.h"
+#include "uring.h"
+#include "utils.h"
+
+#define INITIAL_BUCKET_COUNT 256
+/* Number of attributes submitted at once by fast_read_many() */
+#define BATCH_SIZE 64
+#define BUFFER_SIZE 64
+
+
+typedef struct
+{
+    const FastReadRequest *requests;
+    const int *group_starts;
+    double *values;
+    int *statuses;
+} GroupJob;
+
+
+static int read_value(const sensors_chip_name*, int, double*);
+static unsigned int hash(const sensors_chip_name*, int);
+static FastReadEntry* create_entry(const sensors_chip_name*, int);
+static int has_compute(const sensors_chip_name*, const sensors_subfeature*);
+static int open_entry(FastReadEntry*);
+static int read_attribute(FastReadEntry*, double*);
+static void read_batch(const FastReadRequest*, int, double*, int*);
+static void read_group(void*, int);
+static void invalidate_fd(FastReadEntry*, int);
+static int device_gone(int);
+static int grow(void);
+static double get_type_scaling(int);
+
+
+int fast_read_enabled = 0;
+unsigned long fast_read_epoch = 1;
+/* Protects the hash table, but not the entries themselves */
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Taken in shared mode while a batch of reads is in flight, and in
+ * exclusive mode to close a file descriptor, so that a descriptor
+ * can't be closed and reused by another file under a batch */
+static pthread_rwlock_t close_lock = PTHREAD_RWLOCK_INITIALIZER;
+static FastReadEntry **buckets = NULL;
+static unsigned int bucket_count = 0;
+static unsigned int entry_count = 0;
+
+
+/**
+ * Same as sensors_get_value(), but goes through the cache of open
+ * attributes when the fast read mode is enabled.
+ */
+int fast_read_get_value(const sensors_chip_name *chip, int number,
+                        double *value)
+{
+    PROBE_CHIP1(get_value__entry, chip, number);
+
+    int status = read_value(chip, number, value);
+
+    PROBE_CHIP2(get_value__return, chip, number, status);
+
+    return status;
+}
+
+/**
+ * Return the entry for the given subfeature, creating it if
+ * needed. NULL is returned if memory couldn't be allocated.
+ */
+FastReadEntry* fast_read_lookup(const sensors_chip_name *chip, int number)
+{
+    FastReadEntry *entry = NULL;
+
+    pthread_mutex_lock(&table_lock);
+
+    if (buckets == NULL || entry_count >= bucket_count)
+    {
+        if (grow() < 0)
+        {
+            pthread_mutex_unlock(&table_lock);
+            return NULL;
+        }
+    }
+
+    unsigned int h = hash(chip, number) % bucket_count;
+
+    for (entry = buckets[h]; entry != NULL; entry = entry->next)
+    {
+        if (entry->number == number &&
+            entry->addr == chip->addr &&
+            entry->bus.type == chip->bus.type &&
+            entry->bus.nr == chip->bus.nr &&
+            strcmp(entry->prefix, chip->prefix) == 0)
+        {
+            pthread_mutex_unlock(&table_lock);
+            return entry;
+        }
+    }
+
+    entry = create_entry(chip, number);
+
+    if (entry != NULL)
+    {
+        entry->next = buckets[h];
+        buckets[h] = entry;
+        entry_count++;
+    }
+
+    pthread_mutex_unlock(&table_lock);
+
+    return entry;
+}
+
+/**
+ * Read the value of entry, which was returned by fast_read_lookup()
+ * for chip.
+ */
+int fast_read_entry_get_value(FastReadEntry *entry,
+                              const sensors_chip_name *chip, double *value)
+{
+    int status = entry->mode == FAST_READ_DIRECT ?
+        read_attribute(entry, value) : 1;
+
+    if (status > 0)
+    {
+        /* libsensors will report the error, if any */
+        return sensors_get_value(chip, entry->number, value);
+    }
+
+    return status;
+}
+
+/*
+ * Read the attribute of entry with pread(), opening it if needed.
+ * Return 0, a libsensors error code, or 1 if it couldn't be opened.
+ */
+static int
+read_attribute(FastReadEntry *entry, double *value)
+{
+    char buffer[BUFFER_SIZE];
+
+    pthread_mutex_lock(&entry->lock);
+
+    if (entry->fd < 0 && open_entry(entry) < 0)
+    {
+        pthread_mutex_unlock(&entry->lock);
+        return 1;
+    }
+
+    int fd = entry->fd;
+    ssize_t n = pread(fd, buffer, sizeof buffer - 1, 0);
+    int error = errno;
+
+    pthread_mutex_unlock(&entry->lock);
+
+    if (n < 0)
+    {
+        if (device_gone(error))
+        {
+            /* The attribute will be reopened on the next read, if the
+             * device comes back. */
+            invalidate_fd(entry, fd);
+        }
+
+        return fast_read_error(error);
+    }
+
+    buffer[n] = '\0';
+
+    return fast_read_parse(entry, buffer, value);
+}
+
+/**
+ * Read the count subfeatures of requests, and store their values and
+ * statuses (0 or a libsensors error) at the index of each request.
+ * The attributes are read in batches, with io_uring if possible.
+ */
+void fast_read_many(const FastReadRequest *requests, Py_ssize_t count,
+                    double *values, int *statuses)
+{
+    for (Py_ssize_t first = 0; first < count; first += BATCH_SIZE)
+    {
+        Py_ssize_t n = count - first < BATCH_SIZE ?
+            count - first : BATCH_SIZE;
+
+        read_batch(requests + first, (int)n, values, statuses);
+    }
+}
+
+/**
+ * Same as fast_read_many(), for requests sorted by bus: the requests
+ * of group g are group_starts[g] to group_starts[g + 1] - 1. If
+ * parallel is set, the groups are read at the same time.
+ */
+void fast_read_grouped(const FastReadRequest *requests,
+                       const int *group_starts, int group_count,
+                       int parallel, double *values, int *statuses)
+{
+    if (parallel && group_count > 1)
+    {
+        GroupJob job = {requests, group_starts, values, statuses};
+
+        pool_run(read_group, &job, group_count);
+    }
+    else if (group_count > 0)
+    {
+        fast_read_many(requests, group_starts[group_count], values,
+                       statuses);
+    }
+}
+
+/**
+ * Convert the content of a sysfs attribute to a value, the way
+ * libsensors does. Return 0 or -SENSORS_ERR_ACCESS_R.
+ */
+int fast_read_parse(FastReadEntry *entry, const char *buffer, double *value)
+{
+    char *end = NULL;
+    double raw = strtod(buffer, &end);
+
+    if (end == buffer)
+    {
+        return -SENSORS_ERR_ACCESS_R;
+    }
+
+    *value = raw / entry->scale;
+
+    return 0;
+}
+
+/**
+ * Return the libsensors error code matching an errno value set by a
+ * failed read.
+ */
+int fast_read_error(int error)
+{
+    if (error == EIO)
+    {
+        return -SENSORS_ERR_IO;
+    }
+
+    if (device_gone(error))
+    {
+        return -SENSORS_ERR_KERNEL;
+    }
+
+    return -SENSORS_ERR_ACCESS_R;
+}
+
+/**
+ * Close the attribute of entry. It will be opened again on the next
+ * read. The lock of entry, and close_lock in exclusive mode, must be
+ * held, unless no other thread can use entry.
+ */
+void fast_read_invalidate(FastReadEntry *entry)
+{
+    if (entry->fd >= 0)
+    {
+        close(entry->fd);
+        entry->fd = -1;
+    }
+}
+
+/**
+ * Close all the attributes and free all the entries.
+ */
+void fast_read_clear(void)
+{
+    pthread_mutex_lock(&table_lock);
+
+    for (unsigned int i = 0; i < bucket_count; i++)
+    {
+        FastReadEntry *entry = buckets[i];
+
+        while (entry != NULL)
+        {
+            FastReadEntry *next = entry->next;
+
+            fast_read_invalidate(entry);
+            pthread_mutex_destroy(&entry->lock);
+            free(entry->prefix);
+            free(entry->path);
+            free(entry);
+            entry = next;
+        }
+
+        buckets[i] = NULL;
+    }
+
+    entry_count = 0;
+    fast_read_epoch++;
+    pthread_mutex_unlock(&table_lock);
+}
+
+/*
+ * Read at most BATCH_SIZE requests. The attributes that are open are
+ * read first, all at once; the others go through libsensors.
+ */
+static void
+read_batch(const FastReadRequest *requests, int count, double *values,
+           int *statuses)
+{
+    UringRead reads[BATCH_SIZE];
+    char buffers[BATCH_SIZE][BUFFER_SIZE];
+    /* Index in requests of each read */
+    int read_requests[BATCH_SIZE];
+    int read_count = 0;
+
+    pthread_rwlock_rdlock(&close_lock);
+
+    for (int i = 0; i < count; i++)
+    {
+        FastReadEntry *entry = requests[i].entry;
+        int fd = -1;
+
+        if (entry == NULL || requests[i].chip == NULL ||
+            entry->mode != FAST_READ_DIRECT)
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&entry->lock);
+
+        if (entry->fd >= 0 || open_entry(entry) == 0)
+        {
+            fd = entry->fd;
+        }
+
+        pthread_mutex_unlock(&entry->lock);
+
+        if (fd >= 0)
+        {
+            reads[read_count].fd = fd;
+            reads[read_count].buffer = buffers[read_count];
+            reads[read_count].size = BUFFER_SIZE - 1;
+            read_requests[read_count] = i;
+            read_count++;
+        }
+    }
+
+    if (uring_read(reads, read_count) < 0)
+    {
+        for (int r = 0; r < read_count; r++)
+        {
+            ssize_t n = pread(reads[r].fd, reads[r].buffer, reads[r].size, 0);
+            reads[r].result = n < 0 ? -errno : (int)n;
+        }
+    }
+
+    pthread_rwlock_unlock(&close_lock);
+
+    int next_read = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const FastReadRequest *request = &requests[i];
+        double *value = &values[request->index];
+        int status = 0;
+
+        if (request->chip == NULL)
+        {
+            status = -SENSORS_ERR_NO_ENTRY;
+        }
+        else if (next_read < read_count && read_requests[next_read] == i)
+        {
+            UringRead *read = &reads[next_read++];
+
+            if (read->result < 0)
+            {
+                if (device_gone(-read->result))
+                {
+                    invalidate_fd(request->entry, read->fd);
+                }
+
+                status = fast_read_error(-read->result);
+            }
+            else
+            {
+                read->buffer[read->result] = '\0';
+                status = fast_read_parse(request->entry, read->buffer, value);
+            }
+        }
+        else if (request->entry != NULL)
+        {
+            /* The computed subfeatures, and the attributes that
+             * couldn't be opened */
+            status = fast_read_entry_get_value(request->entry,
+                                               request->chip, value);
+        }
+        else
+        {
+            status = sensors_get_value(request->chip, request->number, value);
+        }
+
+        statuses[request->index] = status < 0 ? status : 0;
+    }
+}
+
+static void
+read_group(void *arg, int group)
+{
+    GroupJob *job = arg;
+    int first = job->group_starts[group];
+
+    fast_read_many(job->requests + first,
+                   job->group_starts[group + 1] - first,
+                   job->values, job->statuses);
+}
+
+/*
+ * Close the attribute of entry if it is still open as fd. The lock of
+ * entry must not be held.
+ */
+static void
+invalidate_fd(FastReadEntry *entry, int fd)
+{
+    pthread_rwlock_wrlock(&close_lock);
+    pthread_mutex_lock(&entry->lock);
+
+    if (entry->fd == fd)
+    {
+        fast_read_invalidate(entry);
+    }
+
+    pthread_mutex_unlock(&entry->lock);
+    pthread_rwlock_unlock(&close_lock);
+}
+
+/*
+ * Return 1 if a read failed with error because the device has
+ * disappeared.
+ */
+static int
+device_gone(int error)
+{
+    return (error == ENODEV || error == ESTALE || error == ENOENT ||
+            error == ENXIO);
+}
+
+static int
+read_value(const sensors_chip_name *chip, int number, double *value)
+{
+    if (!fast_read_enabled || chip_name_has_wildcards(chip))
+    {
+        return sensors_get_value(chip, number, value);
+    }
+
+    FastReadEntry *entry = fast_read_lookup(chip, number);
+
+    if (entry == NULL)
+    {
+        return sensors_get_value(chip, number, value);
+    }
+
+    return fast_read_entry_get_value(entry, chip, value);
+}
+
+static unsigned int
+hash(const sensors_chip_name *chip, int number)
+{
+    /* FNV-1a */
+    unsigned int h = 2166136261u;
+
+    for (const char *c = chip->prefix; *c != '\0'; c++)
+    {
+        h = (h ^ (unsigned char)*c) * 16777619u;
+    }
+
+    h = (h ^ (unsigned int)chip->bus.type) * 16777619u;
+    h = (h ^ (unsigned int)chip->bus.nr) * 16777619u;
+    h = (h ^ (unsigned int)chip->addr) * 16777619u;
+    h = (h ^ (unsigned int)number) * 16777619u;
+
+    return h;
+}
+
+static FastReadEntry*
+create_entry(const sensors_chip_name *chip, int number)
+{
+    FastReadEntry *entry = calloc(1, sizeof *entry);
+
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+
+    entry->prefix = strdup(chip->prefix);
+
+    if (entry->prefix == NULL)
+    {
+        free(entry);
+        return NULL;
+    }
+
+    pthread_mutex_init(&entry->lock, NULL);
+
+    entry->bus = chip->bus;
+    entry->addr = chip->addr;
+    entry->number = number;
+    entry->fd = -1;
+    entry->scale = 1.0;
+    entry->mode = FAST_READ_LIBSENSORS;
+
+    const sensors_chip_name *detected = resolve_chip(chip);
+    const sensors_subfeature *subfeature = NULL;
+
+    if (detected != NULL && detected->path != NULL)
+    {
+        subfeature = find_subfeature(detected, number);
+    }
+
+    if (subfeature == NULL || !(subfeature->flags & SENSORS_MODE_R))
+    {
+        /* libsensors will report the error on every read */
+        return entry;
+    }
+
+    if (has_compute(detected, subfeature))
+    {
+        return entry;
+    }
+
+    size_t size = strlen(detected->path) + strlen(subfeature->name) + 2;
+    entry->path = malloc(size);
+
+    if (entry->path == NULL)
+    {
+        return entry;
+    }
+
+    snprintf(entry->path, size, "%s/%s", detected->path, subfeature->name);
+    entry->type = subfeature->type;
+    entry->scale = get_type_scaling(subfeature->type);
+    /* The attribute is opened by the first read */
+    entry->mode = FAST_READ_DIRECT;
+
+    return entry;
+}
+
+/* Return 1 if a compute statement may apply to subfeature */
+static int
+has_compute(const sensors_chip_name *chip,
+            const sensors_subfeature *subfeature)
+{
+    if (!(subfeature->flags & SENSORS_COMPUTE_MAPPING))
+    {
+        return 0;
+    }
+
+    const sensors_feature *feature = NULL;
+    int nr = 0;
+
+    while ((feature = sensors_get_features(chip, &nr)) != NULL)
+    {
+        if (feature->number == subfeature->mapping)
+        {
+            return computes_find(chip, feature->name);
+        }
+    }
+
+    return 1;
+}
+
+static int
+open_entry(FastReadEntry *entry)
+{
+    entry->fd = open(entry->path, O_RDONLY | O_CLOEXEC);
+
+    return entry->fd < 0 ? -1 : 0;
+}
+
+static int
+grow(void)
+{
+    unsigned int new_count = bucket_count == 0 ?
+        INITIAL_BUCKET_COUNT : bucket_count * 2;
+    FastReadEntry **new_buckets = calloc(new_count, sizeof *new_buckets);
+
+    if (new_buckets == NULL)
+    {
+        return -1;
+    }
+
+    for (unsigned int i = 0; i < bucket_count; i++)
+    {
+        FastReadEntry *entry = buckets[i];
+
+        while (entry != NULL)
+        {
+            FastReadEntry *next = entry->next;
+            sensors_chip_name key = {entry->prefix, entry->bus, entry->addr,
+                                     NULL};
+            unsigned int h = hash(&key, entry->number) % new_count;
+
+            entry->next = new_buckets[h];
+            new_buckets[h] = entry;
+            entry = next;
+        }
+    }
+
+    free(buckets);
+    buckets = new_buckets;
+    bucket_count = new_count;
+
+    return 0;
+}
+
+/*
+ * Same as get_type_scaling() in libsensors.
+ */
+static double
+get_type_scaling(int type)
+{
+    switch (type & 0xFF80)
+    {
+    case SENSORS_SUBFEATURE_IN_INPUT:
+    case SENSORS_SUBFEATURE_TEMP_INPUT:
+    case SENSORS_SUBFEATURE_CURR_INPUT:
+    case SENSORS_SUBFEATURE_HUMIDITY_INPUT:
+        return 1000.0;
+    case SENSORS_SUBFEATURE_FAN_INPUT:
+        return 1.0;
+    case SENSORS_SUBFEATURE_POWER_AVERAGE:
+    case SENSORS_SUBFEATURE_ENERGY_INPUT:
+        return 1000000.0;
+    }
+
+    switch (type)
+    {
+    case SENSORS_SUBFEATURE_POWER_AVERAGE_INTERVAL:
+    case SENSORS_SUBFEATURE_VID:
+    case SENSORS_SUBFEATURE_TEMP_OFFSET:
+        return 1000.0;
+    default:
+        return 1.0;
+    }
+}
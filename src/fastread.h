@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_FAST_READ
+#define H_FAST_READ
+
+#include <Python.h>
+
+#include <pthread.h>
+
+#include <sensors/sensors.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* How the value of a subfeature is read */
+enum
+{
+    FAST_READ_DIRECT,           /* With pread() */
+    FAST_READ_LIBSENSORS        /* With libsensors */
+};
+
+/*
+ * A subfeature whose sysfs attribute is kept open, so that it can be
+ * read with a single pread() instead of going through libsensors.
+ */
+typedef struct FastReadEntry
+{
+    /* Key */
+    char *prefix;
+    sensors_bus_id bus;
+    int addr;
+    int number;
+
+    char *path;                 /* Path of the sysfs attribute */
+    pthread_mutex_t lock;       /* Protects fd */
+    int fd;                     /* -1 if not open */
+    int type;                   /* Subfeature type */
+    double scale;               /* Divisor applied to the raw value */
+    int mode;                   /* FAST_READ_* */
+    struct FastReadEntry *next;
+} FastReadEntry;
+
+/* A subfeature to read with fast_read_many() */
+typedef struct
+{
+    FastReadEntry *entry;       /* NULL to read it with libsensors */
+    const sensors_chip_name *chip; /* NULL if the chip is gone */
+    int number;
+    Py_ssize_t index;           /* Where to store the value and status */
+} FastReadRequest;
+
+/*
+ * All of this must be used with sensors_lock held.  The entries are
+ * only freed by fast_read_clear(), which requires the lock in exclusive
+ * mode, so they can be used by several threads.
+ */
+extern int fast_read_enabled;
+/* Incremented every time the entries are freed, so that pointers to
+ * them can be invalidated */
+extern unsigned long fast_read_epoch;
+
+int fast_read_get_value(const sensors_chip_name*, int, double*);
+FastReadEntry* fast_read_lookup(const sensors_chip_name*, int);
+int fast_read_entry_get_value(FastReadEntry*, const sensors_chip_name*,
+                              double*);
+void fast_read_many(const FastReadRequest*, Py_ssize_t, double*, int*);
+void fast_read_grouped(const FastReadRequest*, const int*, int, int,
+                       double*, int*);
+int fast_read_parse(FastReadEntry*, const char*, double*);
+int fast_read_error(int);
+void fast_read_invalidate(FastReadEntry*);
+void fast_read_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -30,6 +30,8 @@
 #include <Python.h>
 #include <structmember.h>
 
+#include <string.h>
+
 #include <sensors/error.h>
 
 #include "sensorsmodule.h"
@@ -43,6 +45,8 @@ static PyObject* repr(Feature*);
 static PyObject* rich_compare(PyObject*, PyObject*, int);
 static PyObject* get_name(Feature*, void*);
 static int set_name(Feature*, PyObject*, void*);
+static int setattro(Feature*, PyObject*, PyObject*);
+static int check_mutable(Feature*);
 
 
 static PyMethodDef methods[] = {
@@ -82,7 +86,7 @@ PyTypeObject FeatureType =
     0,                         /*tp_call*/
     0,                         /*tp_str*/
     0,                         /*tp_getattro*/
-    0,                         /*tp_setattro*/
+    (setattrofunc)setattro,    /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,        /*tp_flags*/
     "You can think of features as categories for Subfeature objects.",
@@ -106,6 +110,36 @@ PyTypeObject FeatureType =
 };
 
 
+/**
+ * Create a Feature object with a copy of feature, without going through
+ * __init__(). name is a Python string with the same content as
+ * feature->name, that the object will refer to.
+ */
+Feature* feature_new(const sensors_feature *feature, PyObject *name)
+{
+    char *c_name = pystr(name);
+
+    if (c_name == NULL)
+    {
+        return NULL;
+    }
+
+    Feature *self = PyObject_New(Feature, &FeatureType);
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    self->feature = *feature;
+    self->feature.name = c_name;
+    self->py_name = name;
+    Py_INCREF(name);
+    self->interned = 0;
+
+    return self;
+}
+
 static int
 init(Feature *self, PyObject *args, PyObject *kwargs)
 {
@@ -127,25 +161,32 @@ init(Feature *self, PyObject *args, PyObject *kwargs)
         return -1;
     }
 
+    if (check_mutable(self) < 0)
+    {
+        return -1;
+    }
+
+    char *c_name = NULL;
+
     if (name == NULL)
     {
-        self->feature.name = NULL;
-        self->py_name = Py_None;
-        Py_INCREF(self->py_name);
+        name = Py_None;
     }
     else
     {
-        self->feature.name = pystrdup(name);
+        c_name = pystr(name);
 
-        if (self->feature.name == NULL)
+        if (c_name == NULL)
         {
             return -1;
         }
-
-        self->py_name = name;
-        Py_INCREF(self->py_name);
     }
 
+    Py_INCREF(name);
+    Py_XDECREF(self->py_name);
+    self->py_name = name;
+    self->feature.name = c_name;
+
     self->feature.number = number;
     self->feature.type = type;
     self->feature.first_subfeature = 0;
@@ -157,9 +198,8 @@ init(Feature *self, PyObject *args, PyObject *kwargs)
 static void
 dealloc(Feature *self)
 {
-    free(self->feature.name);
     self->feature.name = NULL;
-    Py_DECREF(self->py_name);
+    Py_XDECREF(self->py_name);
     FREE_OBJECT(self);
 }
 
@@ -183,6 +223,11 @@ rich_compare(PyObject *a, PyObject *b, int op)
 {
     if (op == Py_EQ || op == Py_NE)
     {
+        if (a == b)
+        {
+            return PyBool_FromLong(op == Py_EQ);
+        }
+
         if (! (PyObject_IsInstance(a, (PyObject*)&FeatureType) &&
                PyObject_IsInstance(b, (PyObject*)&FeatureType)))
         {
@@ -194,7 +239,8 @@ rich_compare(PyObject *a, PyObject *b, int op)
         sensors_feature *f2 = &((Feature*)b)->feature;
 
         int equal = (((f1->name == NULL && f2->name == NULL) ||
-                      strcmp(f1->name, f2->name) == 0) &&
+                      (f1->name != NULL && f2->name != NULL &&
+                       strcmp(f1->name, f2->name) == 0)) &&
                      f1->number == f2->number &&
                      f1->type == f2->type);
 
@@ -222,6 +268,11 @@ get_name(Feature *self, void *closure)
 {
     (void)closure;
 
+    if (self->py_name == NULL)
+    {
+        Py_RETURN_NONE;
+    }
+
     Py_INCREF(self->py_name);
 
     return self->py_name;
@@ -240,31 +291,54 @@ set_name(Feature *self, PyObject *value, void *closure)
 
     if (value != Py_None && !PyString_Check(value))
     {
-        PyErr_SetString(PyExc_TypeError, 
+        PyErr_SetString(PyExc_TypeError,
                         "The name attribute value must be a string");
         return -1;
     }
 
-    free(self->feature.name);
-    Py_DECREF(self->py_name);
+    char *c_name = NULL;
 
-    if (value == Py_None)
-    {
-        self->feature.name = NULL;
-        self->py_name = Py_None;
-        Py_INCREF(self->py_name);
-    }
-    else
+    if (value != Py_None)
     {
-        self->feature.name = pystrdup(value);
+        c_name = pystr(value);
 
-        if (self->feature.name == NULL)
+        if (c_name == NULL)
         {
             return -1;
         }
+    }
+
+    Py_INCREF(value);
+    Py_XDECREF(self->py_name);
+    self->py_name = value;
+    self->feature.name = c_name;
+
+    return 0;
+}
 
-        self->py_name = value;
-        Py_INCREF(self->py_name);
+static int
+setattro(Feature *self, PyObject *name, PyObject *value)
+{
+    if (check_mutable(self) < 0)
+    {
+        return -1;
+    }
+
+    return PyObject_GenericSetAttr((PyObject*)self, name, value);
+}
+
+/**
+ * Raise AttributeError if the object is interned, and can't be
+ * modified.
+ */
+static int
+check_mutable(Feature *self)
+{
+    if (self->interned)
+    {
+        PyErr_SetString(PyExc_AttributeError,
+                        "Feature objects returned by ChipName are read-only");
+        return -1;
     }
 
     return 0;
@@ -42,13 +42,22 @@ extern "C" {
 extern PyTypeObject FeatureType;
 
 
+/*
+ * feature.name points into py_name, so the name is only stored once.
+ * The objects returned by ChipName are interned: they are shared by
+ * every caller until libsensors is initialized again, and can't be
+ * modified.
+ */
 typedef struct
 {
     PyObject_HEAD
     sensors_feature feature;
-    PyObject *py_name;
+    PyObject *py_name;          /* A string, or None */
+    int interned;
 } Feature;
 
+Feature* feature_new(const sensors_feature*, PyObject*);
+
 #ifdef __cplusplus
 }
 #endif
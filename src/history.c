@@ -0,0 +1,504 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include <time.h>
+
+#include "sensorsmodule.h"
+#include "readings.h"
+#include "history.h"
+#include "utils.h"
+
+
+static int init(History*, PyObject*, PyObject*);
+static void dealloc(History*);
+static PyObject* repr(History*);
+static PyObject* append(History*, PyObject*, PyObject*);
+static PyObject* record(History*, PyObject*, PyObject*);
+static PyObject* count(History*, PyObject*, PyObject*);
+static PyObject* latest(History*, PyObject*, PyObject*);
+static PyObject* range(History*, PyObject*, PyObject*);
+static PyObject* clear(History*, PyObject*);
+static int check_column(History*, Py_ssize_t);
+static HistorySample* sample_at(History*, HistoryColumn*, Py_ssize_t);
+static Py_ssize_t lower_bound(History*, HistoryColumn*, int64_t);
+static void push(History*, HistoryColumn*, int64_t, double);
+
+
+static PyMethodDef methods[] = {
+    {"append", (PyCFunction)append, METH_VARARGS | METH_KEYWORDS,
+     "Add a sample to column. time is a CLOCK_MONOTONIC time in"
+     " nanoseconds, and defaults to now; it can't be older than the last"
+     " sample of the column. The oldest sample is overwritten when the"
+     " column is full."},
+    {"record", (PyCFunction)record, METH_VARARGS | METH_KEYWORDS,
+     "Add the values of a Readings object, which must have one column"
+     " per column of the history. The values that couldn't be read are"
+     " skipped. The time of each row is time if given, its timestamp if"
+     " the readings have some, or now. The timestamps are converted"
+     " from the real-time clock, except for the readings returned by"
+     " range(), which are already on CLOCK_MONOTONIC."},
+    {"count", (PyCFunction)count, METH_VARARGS | METH_KEYWORDS,
+     "Return the number of samples of column."},
+    {"latest", (PyCFunction)latest, METH_VARARGS | METH_KEYWORDS,
+     "Return the last (time, value) sample of column, or None if it is"
+     " empty."},
+    {"range", (PyCFunction)range, METH_VARARGS | METH_KEYWORDS,
+     "Return the samples of column such that start <= time < end, as a"
+     " Readings object with one row per sample. The bounds are"
+     " CLOCK_MONOTONIC times in nanoseconds; None means no bound."},
+    {"clear", (PyCFunction)clear, METH_NOARGS,
+     "Remove all the samples."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef members[] =
+{
+    {"columns", T_PYSSIZET, offsetof(History, columns), READONLY,
+     "Number of columns."},
+    {"capacity", T_PYSSIZET, offsetof(History, capacity), READONLY,
+     "Number of samples kept per column."},
+    {NULL, 0, 0, 0, NULL}
+};
+
+PyTypeObject HistoryType =
+{
+    INIT_TYPE_HEAD
+    "sensors.History",         /*tp_name*/
+    sizeof(History),           /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    0,                         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "History(columns, capacity)\n\n"
+    "The last capacity (time, value) samples of each of columns series,"
+    " in preallocated circular buffers of 16 bytes per sample.",
+    /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    members,                   /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    (initproc)init,            /* tp_init */
+    0,                         /* tp_alloc */
+    0,                         /* tp_new */
+};
+
+
+static int
+init(History *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"columns", "capacity", NULL};
+    Py_ssize_t columns = 0;
+    Py_ssize_t capacity = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nn", kwlist,
+                                     &columns, &capacity))
+    {
+        return -1;
+    }
+
+    if (columns < 0 || capacity <= 0)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "columns can't be negative and capacity must be"
+                        " positive");
+        return -1;
+    }
+
+    size_t column_size = sizeof(HistoryColumn) +
+        capacity * sizeof(HistorySample);
+
+    if ((size_t)capacity > PY_SSIZE_T_MAX / sizeof(HistorySample) ||
+        (columns > 0 && (size_t)columns > PY_SSIZE_T_MAX / column_size))
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    /* One block: the columns, then their samples */
+    char *block = PyMem_Malloc(columns * column_size + 1);
+
+    if (block == NULL)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    PyMem_Free(self->data);
+    self->data = (HistoryColumn*)block;
+    self->columns = columns;
+    self->capacity = capacity;
+
+    HistorySample *samples = (HistorySample*)(self->data + columns);
+
+    for (Py_ssize_t i = 0; i < columns; i++)
+    {
+        self->data[i].samples = samples + i * capacity;
+        self->data[i].start = 0;
+        self->data[i].count = 0;
+    }
+
+    return 0;
+}
+
+static void
+dealloc(History *self)
+{
+    PyMem_Free(self->data);
+    self->data = NULL;
+    FREE_OBJECT(self);
+}
+
+static PyObject*
+repr(History *self)
+{
+    return PyString_FromFormat("History(columns=%zd, capacity=%zd)",
+                               self->columns, self->capacity);
+}
+
+static PyObject*
+append(History *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"column", "value", "time", NULL};
+    Py_ssize_t column = 0;
+    double value = 0.0;
+    PyObject *py_time = Py_None;
+    int64_t time = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nd|O", kwlist,
+                                     &column, &value, &py_time))
+    {
+        return NULL;
+    }
+
+    if (check_column(self, column) < 0 || parse_monotonic_time(py_time, &time) < 0)
+    {
+        return NULL;
+    }
+
+    HistoryColumn *data = &self->data[column];
+
+    if (data->count > 0 &&
+        time < sample_at(self, data, data->count - 1)->time)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "time is older than the last sample");
+        return NULL;
+    }
+
+    push(self, data, time, value);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+record(History *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"readings", "time", NULL};
+    Readings *readings = NULL;
+    PyObject *py_time = Py_None;
+    int64_t time = 0;
+    int64_t offset = 0;
+    int use_timestamps = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|O", kwlist,
+                                     &ReadingsType, &readings, &py_time))
+    {
+        return NULL;
+    }
+
+    if (readings->columns != self->columns)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "the readings don't have the same number of"
+                        " columns as the history");
+        return NULL;
+    }
+
+    if (parse_monotonic_time(py_time, &time) < 0)
+    {
+        return NULL;
+    }
+
+    if (py_time == Py_None && readings->timestamps != NULL)
+    {
+        use_timestamps = 1;
+
+        /* The timestamps of a Sampler are on the real-time clock, and
+         * the ones returned by range() are already monotonic */
+        if (!readings->monotonic)
+        {
+            offset = clock_ns(CLOCK_MONOTONIC) - clock_ns(CLOCK_REALTIME);
+        }
+    }
+
+    for (Py_ssize_t row = 0; row < readings->rows; row++)
+    {
+        int64_t row_time = time;
+
+        if (use_timestamps)
+        {
+            /* Rounded, so that the nanoseconds of range() come back */
+            row_time = (int64_t)(readings->timestamps[row] * 1e9 + 0.5) +
+                offset;
+        }
+
+        for (Py_ssize_t column = 0; column < self->columns; column++)
+        {
+            Py_ssize_t i = row * readings->columns + column;
+            HistoryColumn *data = &self->data[column];
+
+            /* Samples older than the last one would break the order */
+            if (readings->statuses[i] != 0 ||
+                (data->count > 0 &&
+                 row_time < sample_at(self, data, data->count - 1)->time))
+            {
+                continue;
+            }
+
+            push(self, data, row_time, readings->values[i]);
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+count(History *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"column", NULL};
+    Py_ssize_t column = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", kwlist, &column) ||
+        check_column(self, column) < 0)
+    {
+        return NULL;
+    }
+
+    return PyLong_FromSsize_t(self->data[column].count);
+}
+
+static PyObject*
+latest(History *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"column", NULL};
+    Py_ssize_t column = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", kwlist, &column) ||
+        check_column(self, column) < 0)
+    {
+        return NULL;
+    }
+
+    HistoryColumn *data = &self->data[column];
+
+    if (data->count == 0)
+    {
+        Py_RETURN_NONE;
+    }
+
+    HistorySample *sample = sample_at(self, data, data->count - 1);
+
+    return Py_BuildValue("(Ld)", (long long)sample->time, sample->value);
+}
+
+static PyObject*
+range(History *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"column", "start", "end", NULL};
+    Py_ssize_t column = 0;
+    PyObject *py_start = Py_None;
+    PyObject *py_end = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|OO", kwlist,
+                                     &column, &py_start, &py_end) ||
+        check_column(self, column) < 0)
+    {
+        return NULL;
+    }
+
+    HistoryColumn *data = &self->data[column];
+    Py_ssize_t first = 0;
+    Py_ssize_t last = data->count;
+
+    if (py_start != Py_None)
+    {
+        long long start = PyLong_AsLongLong(py_start);
+
+        if (start == -1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        first = lower_bound(self, data, start);
+    }
+
+    if (py_end != Py_None)
+    {
+        long long end = PyLong_AsLongLong(py_end);
+
+        if (end == -1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        last = lower_bound(self, data, end);
+    }
+
+    Py_ssize_t rows = last > first ? last - first : 0;
+    Readings *readings = readings_new_rows(rows, 1);
+
+    if (readings == NULL)
+    {
+        return NULL;
+    }
+
+    readings->monotonic = 1;
+
+    for (Py_ssize_t i = 0; i < rows; i++)
+    {
+        HistorySample *sample = sample_at(self, data, first + i);
+
+        readings->timestamps[i] = sample->time / 1e9;
+        readings->values[i] = sample->value;
+    }
+
+    return (PyObject*)readings;
+}
+
+static PyObject*
+clear(History *self, PyObject *unused)
+{
+    (void)unused;
+
+    for (Py_ssize_t i = 0; i < self->columns; i++)
+    {
+        self->data[i].start = 0;
+        self->data[i].count = 0;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static int
+check_column(History *self, Py_ssize_t column)
+{
+    if (column < 0 || column >= self->columns)
+    {
+        PyErr_SetString(PyExc_IndexError, "History column out of range");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Return sample i of column, 0 being the oldest.
+ */
+static HistorySample*
+sample_at(History *self, HistoryColumn *column, Py_ssize_t i)
+{
+    return &column->samples[(column->start + i) % self->capacity];
+}
+
+/*
+ * Return the index of the first sample of column whose time is at
+ * least time, or the number of samples if there is none.
+ */
+static Py_ssize_t
+lower_bound(History *self, HistoryColumn *column, int64_t time)
+{
+    Py_ssize_t low = 0;
+    Py_ssize_t high = column->count;
+
+    while (low < high)
+    {
+        Py_ssize_t middle = low + (high - low) / 2;
+
+        if (sample_at(self, column, middle)->time < time)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/*
+ * Add a sample after the last one, overwriting the oldest one if the
+ * column is full.
+ */
+static void
+push(History *self, HistoryColumn *column, int64_t time, double value)
+{
+    HistorySample *sample = NULL;
+
+    if (column->count < self->capacity)
+    {
+        sample = sample_at(self, column, column->count);
+        column->count++;
+    }
+    else
+    {
+        sample = &column->samples[column->start];
+        column->start = (column->start + 1) % self->capacity;
+    }
+
+    sample->time = time;
+    sample->value = value;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_HISTORY
+#define H_HISTORY
+
+#include <Python.h>
+
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject HistoryType;
+
+
+/* 16 bytes per sample */
+typedef struct
+{
+    int64_t time;               /* CLOCK_MONOTONIC, in nanoseconds */
+    double value;
+} HistorySample;
+
+/* Circular buffer of one column */
+typedef struct
+{
+    HistorySample *samples;     /* capacity samples */
+    Py_ssize_t start;           /* Index of the oldest sample */
+    Py_ssize_t count;
+} HistoryColumn;
+
+/*
+ * The last capacity samples of each of columns series, typically the
+ * subfeatures of a ReadPlan.  All the memory is allocated by the
+ * constructor.  The samples of a column are sorted by time, so that
+ * they can be searched by time.
+ */
+typedef struct
+{
+    PyObject_HEAD
+    Py_ssize_t columns;
+    Py_ssize_t capacity;
+    HistoryColumn *data;
+} History;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,971 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include <math.h>
+
+#include <sensors/sensors.h>
+#include <sensors/error.h>
+
+#include "sensorsmodule.h"
+#include "chipname.h"
+#include "feature.h"
+#include "readings.h"
+#include "readplan.h"
+#include "monitor.h"
+
+
+static int init(Monitor*, PyObject*, PyObject*);
+static void dealloc(Monitor*);
+static int traverse(Monitor*, visitproc, void*);
+static int clear(Monitor*);
+static PyObject* repr(Monitor*);
+static Py_ssize_t length(Monitor*);
+static PyObject* check(Monitor*, PyObject*);
+static PyObject* evaluate(Monitor*, PyObject*);
+static PyObject* get_state(Monitor*, PyObject*);
+static PyObject* get_limits(Monitor*, PyObject*);
+static PyObject* set_limits(Monitor*, PyObject*, PyObject*);
+static PyObject* py_reload_limits(Monitor*, PyObject*);
+static double get_limit(const MonitorRule*, int);
+static int check_index(Monitor*, Py_ssize_t);
+static void free_rules(Monitor*);
+static int input_type(int);
+static int limit_state(int);
+static void get_limit_types(int, int*);
+static PyObject* make_plan(PyObject*);
+static int reload_limits(Monitor*);
+static int update_state(MonitorRule*, double);
+static Py_ssize_t apply(Monitor*, const double*, const int*);
+
+static const char *limit_names[LIMIT_COUNT] = {
+    "min", "max", "lcrit", "crit", "emergency", "max_hyst", "crit_hyst",
+    "emergency_hyst"
+};
+
+
+static PyMethodDef methods[] = {
+    {"check", (PyCFunction)check, METH_NOARGS,
+     "Read the inputs of the features, and call the callback for each"
+     " feature whose state changed. Return the number of changes."},
+    {"evaluate", (PyCFunction)evaluate, METH_O,
+     "Evaluate a Readings object read from plan, such as the result of"
+     " Sampler.drain(), one row at a time, and call the callback for each"
+     " change of state. Return the number of changes."},
+    {"get_state", (PyCFunction)get_state, METH_O,
+     "Return the current state of the feature at index."},
+    {"get_limits", (PyCFunction)get_limits, METH_O,
+     "Return the limits of the feature at index as a dictionary whose"
+     " keys are min, max, lcrit, crit, emergency, max_hyst, crit_hyst"
+     " and emergency_hyst. The limits it doesn't have are left out."},
+    {"set_limits", (PyCFunction)set_limits, METH_VARARGS | METH_KEYWORDS,
+     "Override the limits of the feature at index that are given as"
+     " keyword arguments, with the same names as in get_limits(). None"
+     " removes the override, so that the limit of the chip is used"
+     " again."},
+    {"reload_limits", (PyCFunction)py_reload_limits, METH_NOARGS,
+     "Read the limits of the chips again."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef members[] =
+{
+    {"plan", T_OBJECT, offsetof(Monitor, plan), READONLY,
+     "ReadPlan of the inputs of the features, in the order of pairs."},
+    {"callback", T_OBJECT, offsetof(Monitor, callback), READONLY,
+     "The callback given to the constructor."},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PySequenceMethods sequence_methods = {
+    (lenfunc)length,           /* sq_length */
+};
+
+PyTypeObject MonitorType =
+{
+    INIT_TYPE_HEAD
+    "sensors.Monitor",         /*tp_name*/
+    sizeof(Monitor),           /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &sequence_methods,         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC, /*tp_flags*/
+    "Monitor(pairs, callback)\n\n"
+    "Evaluate features against the limits of their chip, and call"
+    " callback(chip, feature, old_state, new_state, value) only when the"
+    " state of a feature changes. pairs is a sequence of (ChipName,"
+    " Feature) tuples.", /* tp_doc */
+    (traverseproc)traverse,    /* tp_traverse */
+    (inquiry)clear,            /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    members,                   /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    (initproc)init,            /* tp_init */
+    0,                         /* tp_alloc */
+    0,                         /* tp_new */
+};
+
+
+static int
+init(Monitor *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"pairs", "callback", NULL};
+    PyObject *pairs = NULL;
+    PyObject *callback = NULL;
+    PyObject *inputs = NULL;
+    PyObject *limits = NULL;
+    int *numbers = NULL;
+    Py_ssize_t limit_count = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", kwlist, &pairs,
+                                     &callback))
+    {
+        return -1;
+    }
+
+    if (self->evaluating)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the monitor can't be reinitialized by its callback");
+        return -1;
+    }
+
+    if (!PyCallable_Check(callback))
+    {
+        PyErr_SetString(PyExc_TypeError, "callback must be callable");
+        return -1;
+    }
+
+    PyObject *seq = PySequence_Fast(
+        pairs, "pairs must be a sequence of (ChipName, Feature) tuples");
+
+    if (seq == NULL)
+    {
+        return -1;
+    }
+
+    free_rules(self);
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(seq);
+    self->rules = PyMem_Malloc((size + 1) * sizeof(MonitorRule));
+    self->limit_rules = PyMem_Malloc(
+        (size * LIMIT_COUNT + 1) * sizeof(Py_ssize_t));
+    /* The input, then the limits of each rule, -1 if missing */
+    numbers = PyMem_Malloc(size * (1 + LIMIT_COUNT) * sizeof(int) + 1);
+
+    if (self->rules == NULL || self->limit_rules == NULL || numbers == NULL)
+    {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        PyObject *pair = PySequence_Fast_GET_ITEM(seq, i);
+        MonitorRule *rule = &self->rules[i];
+        ChipName *chip_name = NULL;
+        Feature *feature = NULL;
+
+        if (!PyTuple_Check(pair) ||
+            !PyArg_ParseTuple(pair, "O!O!", &ChipNameType, &chip_name,
+                              &FeatureType, &feature))
+        {
+            PyErr_SetString(PyExc_TypeError,
+                            "pairs must contain (ChipName, Feature) tuples");
+            goto error;
+        }
+
+        Py_INCREF(chip_name);
+        Py_INCREF(feature);
+        rule->chip = (PyObject*)chip_name;
+        rule->feature = (PyObject*)feature;
+        rule->overridden = 0;
+        rule->power_cap = 0;
+        rule->active = 0;
+        rule->state = MONITOR_OK;
+        self->size = i + 1;
+    }
+
+    /* Only look the subfeatures up while the lock is held, without
+     * creating Python objects */
+    LOCK_SENSORS();
+
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        const sensors_chip_name *chip =
+            &((ChipName*)self->rules[i].chip)->chip_name;
+        const sensors_feature *feature =
+            &((Feature*)self->rules[i].feature)->feature;
+        int *rule_numbers = numbers + i * (1 + LIMIT_COUNT);
+        int types[LIMIT_COUNT];
+        const sensors_subfeature *subfeature = sensors_get_subfeature(
+            chip, feature, input_type(feature->type));
+
+        if (subfeature == NULL && feature->type == SENSORS_FEATURE_POWER)
+        {
+            subfeature = sensors_get_subfeature(
+                chip, feature, SENSORS_SUBFEATURE_POWER_AVERAGE);
+        }
+
+        rule_numbers[0] = subfeature == NULL ? -1 : subfeature->number;
+        get_limit_types(feature->type, types);
+
+        for (int limit = 0; limit < LIMIT_COUNT; limit++)
+        {
+            subfeature = types[limit] < 0 ? NULL :
+                sensors_get_subfeature(chip, feature, types[limit]);
+            rule_numbers[1 + limit] =
+                subfeature == NULL || !(subfeature->flags & SENSORS_MODE_R) ?
+                -1 : subfeature->number;
+        }
+
+        /* Use the power cap, if any, when there is no maximum */
+        if (feature->type == SENSORS_FEATURE_POWER &&
+            rule_numbers[1 + LIMIT_MAX] < 0 &&
+            (subfeature = sensors_get_subfeature(
+                chip, feature, SENSORS_SUBFEATURE_POWER_CAP)) != NULL &&
+            (subfeature->flags & SENSORS_MODE_R))
+        {
+            rule_numbers[1 + LIMIT_MAX] = subfeature->number;
+            subfeature = sensors_get_subfeature(
+                chip, feature, SENSORS_SUBFEATURE_POWER_CAP_HYST);
+            rule_numbers[1 + LIMIT_MAX_HYST] =
+                subfeature == NULL || !(subfeature->flags & SENSORS_MODE_R) ?
+                -1 : subfeature->number;
+            self->rules[i].power_cap = 1;
+        }
+    }
+
+    UNLOCK_SENSORS();
+
+    inputs = PyList_New(size);
+    limits = PyList_New(0);
+
+    if (inputs == NULL || limits == NULL)
+    {
+        goto error;
+    }
+
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        int *rule_numbers = numbers + i * (1 + LIMIT_COUNT);
+
+        if (rule_numbers[0] < 0)
+        {
+            PyErr_SetString(SensorsException,
+                            sensors_strerror(-SENSORS_ERR_NO_ENTRY));
+            goto error;
+        }
+
+        PyObject *pair = Py_BuildValue("(Oi)", self->rules[i].chip,
+                                       rule_numbers[0]);
+
+        if (pair == NULL)
+        {
+            goto error;
+        }
+
+        PyList_SET_ITEM(inputs, i, pair);
+
+        for (int limit = 0; limit < LIMIT_COUNT; limit++)
+        {
+            if (rule_numbers[1 + limit] < 0)
+            {
+                continue;
+            }
+
+            pair = Py_BuildValue("(Oi)", self->rules[i].chip,
+                                 rule_numbers[1 + limit]);
+
+            if (pair == NULL || PyList_Append(limits, pair) < 0)
+            {
+                Py_XDECREF(pair);
+                goto error;
+            }
+
+            Py_DECREF(pair);
+            self->limit_rules[limit_count++] = i * LIMIT_COUNT + limit;
+        }
+    }
+
+    self->limit_count = limit_count;
+    self->plan = (ReadPlan*)make_plan(inputs);
+
+    if (self->plan == NULL)
+    {
+        goto error;
+    }
+
+    self->limit_plan = (ReadPlan*)make_plan(limits);
+
+    if (self->limit_plan == NULL || reload_limits(self) < 0)
+    {
+        goto error;
+    }
+
+    Py_INCREF(callback);
+    self->callback = callback;
+    Py_DECREF(inputs);
+    Py_DECREF(limits);
+    Py_DECREF(seq);
+    PyMem_Free(numbers);
+
+    return 0;
+
+error:
+    Py_XDECREF(inputs);
+    Py_XDECREF(limits);
+    Py_DECREF(seq);
+    PyMem_Free(numbers);
+    free_rules(self);
+    return -1;
+}
+
+static void
+dealloc(Monitor *self)
+{
+    PyObject_GC_UnTrack(self);
+    free_rules(self);
+    FREE_OBJECT(self);
+}
+
+static int
+traverse(Monitor *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->callback);
+
+    return 0;
+}
+
+static int
+clear(Monitor *self)
+{
+    Py_CLEAR(self->callback);
+
+    return 0;
+}
+
+static PyObject*
+repr(Monitor *self)
+{
+    return PyString_FromFormat("Monitor(size=%zd)", self->size);
+}
+
+static Py_ssize_t
+length(Monitor *self)
+{
+    return self->size;
+}
+
+static PyObject*
+check(Monitor *self, PyObject *unused)
+{
+    (void)unused;
+
+    if (self->plan == NULL)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "the monitor isn't initialized");
+        return NULL;
+    }
+
+    /* The plan is kept alive in case the callback of another thread
+     * reinitializes the monitor while it's read */
+    ReadPlan *plan = self->plan;
+
+    if (plan->size != self->size)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the plan doesn't match the monitor");
+        return NULL;
+    }
+
+    Readings *readings = readings_new(plan->size);
+    unsigned long generation = 0;
+
+    if (readings == NULL)
+    {
+        return NULL;
+    }
+
+    Py_INCREF(plan);
+    BEGIN_SENSORS_IO
+    generation = sensors_generation;
+    read_plan_read(plan, readings->values, readings->statuses);
+    END_SENSORS_IO
+
+    if (plan != self->plan)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the monitor was reinitialized during check()");
+        Py_DECREF(plan);
+        Py_DECREF(readings);
+        return NULL;
+    }
+
+    Py_DECREF(plan);
+    Py_ssize_t count = -1;
+
+    if (generation == self->generation || reload_limits(self) == 0)
+    {
+        count = apply(self, readings->values, readings->statuses);
+    }
+
+    Py_DECREF(readings);
+
+    return count < 0 ? NULL : PyLong_FromSsize_t(count);
+}
+
+static PyObject*
+evaluate(Monitor *self, PyObject *arg)
+{
+    if (!PyObject_TypeCheck(arg, &ReadingsType))
+    {
+        PyErr_SetString(PyExc_TypeError, "argument must be a Readings");
+        return NULL;
+    }
+
+    Readings *readings = (Readings*)arg;
+
+    if (self->plan == NULL || readings->columns != self->size)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "the readings don't have one column per feature");
+        return NULL;
+    }
+
+    LOCK_SENSORS();
+    unsigned long generation = sensors_generation;
+    UNLOCK_SENSORS();
+
+    if (generation != self->generation && reload_limits(self) < 0)
+    {
+        return NULL;
+    }
+
+    /* The readings can't change while the callback runs, because it
+     * has a reference to them */
+    Py_INCREF(readings);
+    Py_ssize_t count = 0;
+
+    for (Py_ssize_t row = 0; row < readings->rows; row++)
+    {
+        Py_ssize_t changes = apply(
+            self, readings->values + row * readings->columns,
+            readings->statuses + row * readings->columns);
+
+        if (changes < 0)
+        {
+            count = -1;
+            break;
+        }
+
+        count += changes;
+    }
+
+    Py_DECREF(readings);
+
+    return count < 0 ? NULL : PyLong_FromSsize_t(count);
+}
+
+static PyObject*
+get_state(Monitor *self, PyObject *arg)
+{
+    Py_ssize_t index = PyNumber_AsSsize_t(arg, PyExc_IndexError);
+
+    if ((index == -1 && PyErr_Occurred()) || check_index(self, index) < 0)
+    {
+        return NULL;
+    }
+
+    return PyLong_FromLong(self->rules[index].state);
+}
+
+static PyObject*
+get_limits(Monitor *self, PyObject *arg)
+{
+    Py_ssize_t index = PyNumber_AsSsize_t(arg, PyExc_IndexError);
+
+    if ((index == -1 && PyErr_Occurred()) || check_index(self, index) < 0)
+    {
+        return NULL;
+    }
+
+    const MonitorRule *rule = &self->rules[index];
+    PyObject *dict = PyDict_New();
+
+    if (dict == NULL)
+    {
+        return NULL;
+    }
+
+    for (int limit = 0; limit < LIMIT_COUNT; limit++)
+    {
+        double value = get_limit(rule, limit);
+
+        if (isnan(value))
+        {
+            continue;
+        }
+
+        PyObject *item = PyFloat_FromDouble(value);
+
+        if (item == NULL ||
+            PyDict_SetItemString(dict, limit_names[limit], item) < 0)
+        {
+            Py_XDECREF(item);
+            Py_DECREF(dict);
+            return NULL;
+        }
+
+        Py_DECREF(item);
+    }
+
+    return dict;
+}
+
+static PyObject*
+set_limits(Monitor *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"index", "min", "max", "lcrit", "crit", "emergency",
+                      "max_hyst", "crit_hyst", "emergency_hyst", NULL};
+    Py_ssize_t index = 0;
+    PyObject *values[LIMIT_COUNT] = {NULL};
+    double parsed[LIMIT_COUNT];
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|OOOOOOOO", kwlist,
+                                     &index, &values[LIMIT_MIN],
+                                     &values[LIMIT_MAX], &values[LIMIT_LCRIT],
+                                     &values[LIMIT_CRIT],
+                                     &values[LIMIT_EMERGENCY],
+                                     &values[LIMIT_MAX_HYST],
+                                     &values[LIMIT_CRIT_HYST],
+                                     &values[LIMIT_EMERGENCY_HYST]) ||
+        check_index(self, index) < 0)
+    {
+        return NULL;
+    }
+
+    /* Parse everything first, so that nothing changes on error */
+    for (int limit = 0; limit < LIMIT_COUNT; limit++)
+    {
+        if (values[limit] == NULL || values[limit] == Py_None)
+        {
+            continue;
+        }
+
+        parsed[limit] = PyFloat_AsDouble(values[limit]);
+
+        if (parsed[limit] == -1.0 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+    }
+
+    MonitorRule *rule = &self->rules[index];
+
+    for (int limit = 0; limit < LIMIT_COUNT; limit++)
+    {
+        if (values[limit] == Py_None)
+        {
+            rule->overridden &= ~(1 << limit);
+        }
+        else if (values[limit] != NULL)
+        {
+            rule->overrides[limit] = parsed[limit];
+            rule->overridden |= 1 << limit;
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+py_reload_limits(Monitor *self, PyObject *unused)
+{
+    (void)unused;
+
+    if (self->limit_plan == NULL)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "the monitor isn't initialized");
+        return NULL;
+    }
+
+    if (reload_limits(self) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * Return a limit of a rule, taking the overrides into account.
+ */
+static double
+get_limit(const MonitorRule *rule, int limit)
+{
+    return rule->overridden & (1 << limit) ?
+        rule->overrides[limit] : rule->limits[limit];
+}
+
+static int
+check_index(Monitor *self, Py_ssize_t index)
+{
+    if (index < 0 || index >= self->size)
+    {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void
+free_rules(Monitor *self)
+{
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        Py_DECREF(self->rules[i].chip);
+        Py_DECREF(self->rules[i].feature);
+    }
+
+    PyMem_Free(self->rules);
+    PyMem_Free(self->limit_rules);
+    self->rules = NULL;
+    self->limit_rules = NULL;
+    self->size = 0;
+    self->limit_count = 0;
+    Py_CLEAR(self->plan);
+    Py_CLEAR(self->limit_plan);
+    Py_CLEAR(self->callback);
+}
+
+/**
+ * Return the type of the subfeature that holds the value of a feature
+ * of the given type.
+ */
+static int
+input_type(int feature_type)
+{
+    switch (feature_type)
+    {
+    case SENSORS_FEATURE_IN:
+        return SENSORS_SUBFEATURE_IN_INPUT;
+    case SENSORS_FEATURE_FAN:
+        return SENSORS_SUBFEATURE_FAN_INPUT;
+    case SENSORS_FEATURE_TEMP:
+        return SENSORS_SUBFEATURE_TEMP_INPUT;
+    case SENSORS_FEATURE_POWER:
+        return SENSORS_SUBFEATURE_POWER_INPUT;
+    case SENSORS_FEATURE_ENERGY:
+        return SENSORS_SUBFEATURE_ENERGY_INPUT;
+    case SENSORS_FEATURE_CURR:
+        return SENSORS_SUBFEATURE_CURR_INPUT;
+    case SENSORS_FEATURE_HUMIDITY:
+        return SENSORS_SUBFEATURE_HUMIDITY_INPUT;
+    default:
+        return SENSORS_SUBFEATURE_UNKNOWN;
+    }
+}
+
+/**
+ * Store the subfeature type of each limit of a feature of the given
+ * type in types, -1 for the limits that type doesn't have.
+ */
+static void
+get_limit_types(int feature_type, int *types)
+{
+    for (int limit = 0; limit < LIMIT_COUNT; limit++)
+    {
+        types[limit] = -1;
+    }
+
+    switch (feature_type)
+    {
+    case SENSORS_FEATURE_IN:
+        types[LIMIT_MIN] = SENSORS_SUBFEATURE_IN_MIN;
+        types[LIMIT_MAX] = SENSORS_SUBFEATURE_IN_MAX;
+        types[LIMIT_LCRIT] = SENSORS_SUBFEATURE_IN_LCRIT;
+        types[LIMIT_CRIT] = SENSORS_SUBFEATURE_IN_CRIT;
+        break;
+    case SENSORS_FEATURE_FAN:
+        types[LIMIT_MIN] = SENSORS_SUBFEATURE_FAN_MIN;
+        break;
+    case SENSORS_FEATURE_TEMP:
+        types[LIMIT_MIN] = SENSORS_SUBFEATURE_TEMP_MIN;
+        types[LIMIT_MAX] = SENSORS_SUBFEATURE_TEMP_MAX;
+        types[LIMIT_LCRIT] = SENSORS_SUBFEATURE_TEMP_LCRIT;
+        types[LIMIT_CRIT] = SENSORS_SUBFEATURE_TEMP_CRIT;
+        types[LIMIT_EMERGENCY] = SENSORS_SUBFEATURE_TEMP_EMERGENCY;
+        types[LIMIT_MAX_HYST] = SENSORS_SUBFEATURE_TEMP_MAX_HYST;
+        types[LIMIT_CRIT_HYST] = SENSORS_SUBFEATURE_TEMP_CRIT_HYST;
+        types[LIMIT_EMERGENCY_HYST] = SENSORS_SUBFEATURE_TEMP_EMERGENCY_HYST;
+        break;
+    case SENSORS_FEATURE_POWER:
+        types[LIMIT_MAX] = SENSORS_SUBFEATURE_POWER_MAX;
+        types[LIMIT_CRIT] = SENSORS_SUBFEATURE_POWER_CRIT;
+        break;
+    case SENSORS_FEATURE_CURR:
+        types[LIMIT_MIN] = SENSORS_SUBFEATURE_CURR_MIN;
+        types[LIMIT_MAX] = SENSORS_SUBFEATURE_CURR_MAX;
+        types[LIMIT_LCRIT] = SENSORS_SUBFEATURE_CURR_LCRIT;
+        types[LIMIT_CRIT] = SENSORS_SUBFEATURE_CURR_CRIT;
+        break;
+    }
+}
+
+static PyObject*
+make_plan(PyObject *pairs)
+{
+    return PyObject_CallFunctionObjArgs((PyObject*)&ReadPlanType, pairs,
+                                        NULL);
+}
+
+/**
+ * Read the limits of the chips. The limits that can't be read are
+ * ignored.
+ */
+static int
+reload_limits(Monitor *self)
+{
+    ReadPlan *plan = self->limit_plan;
+
+    if (plan->size != self->limit_count)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the limit plan doesn't match the monitor");
+        return -1;
+    }
+
+    Readings *readings = readings_new(plan->size);
+    unsigned long generation = 0;
+
+    if (readings == NULL)
+    {
+        return -1;
+    }
+
+    Py_INCREF(plan);
+    BEGIN_SENSORS_IO
+    generation = sensors_generation;
+    read_plan_read(plan, readings->values, readings->statuses);
+    END_SENSORS_IO
+
+    if (plan != self->limit_plan)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the monitor was reinitialized while reading its"
+                        " limits");
+        Py_DECREF(plan);
+        Py_DECREF(readings);
+        return -1;
+    }
+
+    Py_DECREF(plan);
+    self->generation = generation;
+
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        for (int limit = 0; limit < LIMIT_COUNT; limit++)
+        {
+            self->rules[i].limits[limit] = NAN;
+        }
+    }
+
+    for (Py_ssize_t i = 0; i < readings->size; i++)
+    {
+        Py_ssize_t rule = self->limit_rules[i] / LIMIT_COUNT;
+        int limit = self->limit_rules[i] % LIMIT_COUNT;
+
+        if (readings->statuses[i] == 0)
+        {
+            self->rules[rule].limits[limit] = readings->values[i];
+        }
+    }
+
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        MonitorRule *rule = &self->rules[i];
+
+        /* The hysteresis of a power cap is a margin below it */
+        if (rule->power_cap)
+        {
+            rule->limits[LIMIT_MAX_HYST] =
+                rule->limits[LIMIT_MAX] - rule->limits[LIMIT_MAX_HYST];
+        }
+    }
+
+    Py_DECREF(readings);
+
+    return 0;
+}
+
+/**
+ * Return the state of a limit once it is crossed.
+ */
+static int
+limit_state(int limit)
+{
+    switch (limit)
+    {
+    case LIMIT_MIN:
+    case LIMIT_MAX:
+        return MONITOR_WARN;
+    case LIMIT_LCRIT:
+    case LIMIT_CRIT:
+        return MONITOR_CRIT;
+    default:
+        return MONITOR_EMERGENCY;
+    }
+}
+
+/**
+ * Update the limits a rule has crossed with a new value, and return
+ * its new state, the worst of the limits crossed. An upper limit is
+ * crossed when the value is above it, and stays crossed until the
+ * value is below its hysteresis limit, if any. A limit that is NAN is
+ * never crossed.
+ */
+static int
+update_state(MonitorRule *rule, double value)
+{
+    static const int hysteresis[LIMIT_EMERGENCY + 1] = {
+        -1, LIMIT_MAX_HYST, -1, LIMIT_CRIT_HYST, LIMIT_EMERGENCY_HYST
+    };
+    int active = 0;
+    int state = MONITOR_OK;
+
+    for (int limit = LIMIT_MIN; limit <= LIMIT_EMERGENCY; limit++)
+    {
+        double threshold = get_limit(rule, limit);
+        int crossed = 0;
+
+        if (limit == LIMIT_MIN || limit == LIMIT_LCRIT)
+        {
+            crossed = value < threshold;
+        }
+        else
+        {
+            crossed = value > threshold ||
+                ((rule->active & (1 << limit)) && !isnan(threshold) &&
+                 value >= get_limit(rule, hysteresis[limit]));
+        }
+
+        if (crossed)
+        {
+            active |= 1 << limit;
+
+            if (limit_state(limit) > state)
+            {
+                state = limit_state(limit);
+            }
+        }
+    }
+
+    rule->active = active;
+
+    return state;
+}
+
+/**
+ * Update the state of every rule with a row of values, in the order
+ * of the rules, and call the callback for each change. The rules whose
+ * value couldn't be read keep their state. Return the number of
+ * changes, or -1 if the callback raised an exception.
+ */
+static Py_ssize_t
+apply(Monitor *self, const double *values, const int *statuses)
+{
+    Py_ssize_t count = 0;
+
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        MonitorRule *rule = &self->rules[i];
+
+        if (statuses[i] != 0)
+        {
+            continue;
+        }
+
+        int state = update_state(rule, values[i]);
+
+        if (state == rule->state)
+        {
+            continue;
+        }
+
+        int old_state = rule->state;
+
+        rule->state = state;
+        count++;
+
+        if (self->callback == NULL)
+        {
+            continue;
+        }
+
+        self->evaluating++;
+        PyObject *result = PyObject_CallFunction(
+            self->callback, "OOiid", rule->chip, rule->feature, old_state,
+            state, values[i]);
+        self->evaluating--;
+
+        if (result == NULL)
+        {
+            return -1;
+        }
+
+        Py_DECREF(result);
+    }
+
+    return count;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_MONITOR
+#define H_MONITOR
+
+#include <Python.h>
+
+#include "readplan.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject MonitorType;
+
+
+/* States of a rule, from the best to the worst */
+enum
+{
+    MONITOR_OK,
+    MONITOR_WARN,
+    MONITOR_CRIT,
+    MONITOR_EMERGENCY
+};
+
+/* Limits of a rule, NAN if the feature doesn't have them.  The
+ * hysteresis limits are absolute values, like *_MAX_HYST. */
+enum
+{
+    LIMIT_MIN,
+    LIMIT_MAX,
+    LIMIT_LCRIT,
+    LIMIT_CRIT,
+    LIMIT_EMERGENCY,
+    LIMIT_MAX_HYST,
+    LIMIT_CRIT_HYST,
+    LIMIT_EMERGENCY_HYST,
+    LIMIT_COUNT
+};
+
+typedef struct
+{
+    PyObject *chip;             /* ChipName */
+    PyObject *feature;          /* Feature */
+    double limits[LIMIT_COUNT]; /* As read from the chip */
+    double overrides[LIMIT_COUNT];
+    int overridden;             /* 1 << limit for each override */
+    int power_cap;              /* Whether LIMIT_MAX is a power cap */
+    int active;                 /* 1 << limit for each limit crossed */
+    int state;
+} MonitorRule;
+
+/*
+ * Evaluates the input of features against their limits, and calls a
+ * Python callback only when the state of a feature changes.  Once an
+ * upper limit is crossed, it stays crossed until the value drops below
+ * its hysteresis limit, so that values hovering around a limit don't
+ * change the state at every reading.  The
+ * inputs are read by plan, in the order of the rules, so a Sampler can
+ * read them as well; the limits are read by limit_plan when the
+ * monitor is created and after libsensors is reinitialized, and
+ * limit_rules[i] is the rule * LIMIT_COUNT + limit that entry i of
+ * limit_plan belongs to.  The buffers are sized from size and
+ * limit_count, which must match the sizes of the plans.
+ */
+typedef struct
+{
+    PyObject_HEAD
+    Py_ssize_t size;
+    MonitorRule *rules;
+    PyObject *callback;
+    ReadPlan *plan;
+    ReadPlan *limit_plan;
+    Py_ssize_t *limit_rules;
+    Py_ssize_t limit_count;
+    unsigned long generation;
+    int evaluating;             /* Whether the callback is running */
+} Monitor;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
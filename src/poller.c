@@ -0,0 +1,645 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sensors/sensors.h>
+#include <sensors/error.h>
+
+#include "sensorsmodule.h"
+#include "chipname.h"
+#include "fastread.h"
+#include "readings.h"
+#include "readplan.h"
+#include "poller.h"
+#include "utils.h"
+
+
+static PyObject* new(PyTypeObject*, PyObject*, PyObject*);
+static int init(Poller*, PyObject*, PyObject*);
+static void dealloc(Poller*);
+static PyObject* repr(Poller*);
+static Py_ssize_t length(Poller*);
+static PyObject* poll(Poller*, PyObject*, PyObject*);
+static PyObject* next_deadline(Poller*, PyObject*);
+static PyObject* get_interval(Poller*, PyObject*);
+static PyObject* get_reads(Poller*, void*);
+static int wait_for_deadline(Poller*);
+static int64_t first_deadline(Poller*);
+static Py_ssize_t poll_due(Poller*);
+static void resolve(Poller*);
+static void adapt(Poller*, PollerEntry*, double, int, int64_t);
+static void free_entries(PollerEntry*, Py_ssize_t);
+
+
+static PyMethodDef methods[] = {
+    {"poll", (PyCFunction)poll, METH_VARARGS | METH_KEYWORDS,
+     "Read the subfeatures that are due, after waiting until the first"
+     " one is if wait is true, and return the latest value of every"
+     " subfeature as a Readings object. If out is given, it must be a"
+     " Readings object returned by a previous call; it is filled and"
+     " returned instead of allocating a new one."},
+    {"next_deadline", (PyCFunction)next_deadline, METH_NOARGS,
+     "Return the number of seconds until the next subfeature is due, 0"
+     " if one is already due, or None if there are no subfeatures."},
+    {"get_interval", (PyCFunction)get_interval, METH_O,
+     "Return the current interval of the subfeature at index, in"
+     " seconds."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef members[] =
+{
+    {"min_interval", T_DOUBLE, offsetof(Poller, min_interval), READONLY,
+     "Shortest interval, in seconds."},
+    {"max_interval", T_DOUBLE, offsetof(Poller, max_interval), READONLY,
+     "Longest interval, in seconds."},
+    {"tolerance", T_DOUBLE, offsetof(Poller, tolerance), READONLY,
+     "Largest change that lets the interval grow."},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyGetSetDef getsetters[] = {
+    {"reads", (getter)get_reads, NULL,
+     "Number of subfeatures read so far.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PySequenceMethods sequence_methods = {
+    (lenfunc)length,           /* sq_length */
+};
+
+PyTypeObject PollerType =
+{
+    INIT_TYPE_HEAD
+    "sensors.Poller",          /*tp_name*/
+    sizeof(Poller),            /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &sequence_methods,         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "Poller(pairs, min_interval, max_interval, tolerance=0.0)\n\n"
+    "Read subfeatures at intervals that adapt to how fast they change."
+    " pairs is a sequence of (ChipName, Subfeature) tuples. The interval"
+    " of a subfeature doubles, up to max_interval seconds, every time its"
+    " value changes by at most tolerance, and goes back to min_interval"
+    " when it changes more.", /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    members,                   /* tp_members */
+    getsetters,                /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    (initproc)init,            /* tp_init */
+    0,                         /* tp_alloc */
+    new,                       /* tp_new */
+};
+
+
+static PyObject*
+new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    Poller *self = (Poller*)PyType_GenericNew(type, args, kwargs);
+
+    if (self != NULL)
+    {
+        pthread_mutex_init(&self->lock, NULL);
+    }
+
+    return (PyObject*)self;
+}
+
+static int
+init(Poller *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"pairs", "min_interval", "max_interval", "tolerance",
+                      NULL};
+    PyObject *pairs = NULL;
+    double min_interval = 0.0;
+    double max_interval = 0.0;
+    double tolerance = 0.0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Odd|d", kwlist, &pairs,
+                                     &min_interval, &max_interval,
+                                     &tolerance))
+    {
+        return -1;
+    }
+
+    if (!(min_interval > 0.0) || !(max_interval >= min_interval) ||
+        !isfinite(max_interval) || min_interval * 1e9 < 1.0)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "the intervals must be positive, and min_interval"
+                        " can't be larger than max_interval");
+        return -1;
+    }
+
+    if (!(tolerance >= 0.0))
+    {
+        PyErr_SetString(PyExc_ValueError, "tolerance can't be negative");
+        return -1;
+    }
+
+    PyObject *tuple = PySequence_Tuple(pairs);
+
+    if (tuple == NULL)
+    {
+        return -1;
+    }
+
+    Py_ssize_t size = PyTuple_GET_SIZE(tuple);
+    size_t entry_size = sizeof(PollerEntry) + sizeof(FastReadRequest) +
+        sizeof(double) + sizeof(int);
+
+    if ((size_t)size > PY_SSIZE_T_MAX / entry_size)
+    {
+        Py_DECREF(tuple);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    /* One block: the entries, the requests, the values, then the
+     * statuses */
+    char *block = PyMem_Malloc(size * entry_size + 1);
+
+    if (block == NULL)
+    {
+        Py_DECREF(tuple);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    PollerEntry *entries = (PollerEntry*)block;
+    Py_ssize_t filled = 0;
+
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        ChipName *chip_name = NULL;
+        int number = 0;
+
+        if (read_plan_parse_pair(PyTuple_GET_ITEM(tuple, i), &chip_name,
+                                 &number) < 0)
+        {
+            goto error;
+        }
+
+        if (chip_name_has_wildcards(&chip_name->chip_name))
+        {
+            PyErr_SetString(SensorsException,
+                            sensors_strerror(-SENSORS_ERR_WILDCARDS));
+            goto error;
+        }
+
+        /* Copied, since the prefix of chip_name can be changed by
+         * another thread while poll() reads without the GIL */
+        entries[i].name = chip_name->chip_name;
+        entries[i].name.prefix = strdup(chip_name->chip_name.prefix);
+        entries[i].name.path = NULL;
+
+        if (entries[i].name.prefix == NULL)
+        {
+            PyErr_NoMemory();
+            goto error;
+        }
+
+        filled++;
+        entries[i].number = number;
+        entries[i].chip = NULL;
+        entries[i].fast = NULL;
+        entries[i].interval = (int64_t)(min_interval * 1e9);
+        entries[i].deadline = 0;
+        entries[i].has_last = 0;
+    }
+
+    /* poll() could be running in another thread */
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&self->lock);
+    Py_END_ALLOW_THREADS
+
+    PyObject *old_pairs = self->pairs;
+    PollerEntry *old_entries = self->entries;
+    Py_ssize_t old_size = self->size;
+
+    self->pairs = tuple;
+    self->size = size;
+    self->entries = entries;
+    self->requests = (FastReadRequest*)(entries + size);
+    self->values = (double*)(self->requests + size);
+    self->statuses = (int*)(self->values + size);
+    self->min_interval = min_interval;
+    self->max_interval = max_interval;
+    self->tolerance = tolerance;
+    self->reads = 0;
+    /* Resolve the entries on the first poll */
+    self->resolved_fast = -1;
+
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        self->values[i] = 0.0;
+        self->statuses[i] = -SENSORS_ERR_ACCESS_R;
+    }
+
+    pthread_mutex_unlock(&self->lock);
+    Py_XDECREF(old_pairs);
+    free_entries(old_entries, old_size);
+
+    return 0;
+
+error:
+    Py_DECREF(tuple);
+    free_entries(entries, filled);
+    return -1;
+}
+
+static void
+dealloc(Poller *self)
+{
+    pthread_mutex_destroy(&self->lock);
+    free_entries(self->entries, self->size);
+    self->entries = NULL;
+    Py_XDECREF(self->pairs);
+    FREE_OBJECT(self);
+}
+
+static PyObject*
+repr(Poller *self)
+{
+    return PyString_FromFormat("Poller(size=%zd, reads=%llu)", self->size,
+                               self->reads);
+}
+
+static Py_ssize_t
+length(Poller *self)
+{
+    return self->size;
+}
+
+static PyObject*
+poll(Poller *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"wait", "out", NULL};
+    PyObject *wait = Py_True;
+    Readings *out = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OO!", kwlist, &wait,
+                                     &ReadingsType, &out))
+    {
+        return NULL;
+    }
+
+    int must_wait = PyObject_IsTrue(wait);
+
+    if (must_wait < 0)
+    {
+        return NULL;
+    }
+
+    if (out == NULL)
+    {
+        out = readings_new(self->size);
+
+        if (out == NULL)
+        {
+            return NULL;
+        }
+    }
+    else if (out->size != self->size)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "out doesn't have the same size as the poller");
+        return NULL;
+    }
+    else
+    {
+        Py_INCREF(out);
+    }
+
+    if (must_wait && wait_for_deadline(self) < 0)
+    {
+        Py_DECREF(out);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&self->lock);
+
+    /* The poller could have been reinitialized while waiting */
+    if (out->size == self->size)
+    {
+        pthread_rwlock_rdlock(&sensors_lock);
+        poll_due(self);
+        pthread_rwlock_unlock(&sensors_lock);
+
+        memcpy(out->values, self->values, self->size * sizeof(double));
+        memcpy(out->statuses, self->statuses, self->size * sizeof(int));
+    }
+
+    pthread_mutex_unlock(&self->lock);
+    Py_END_ALLOW_THREADS
+
+    if (out->size != self->size)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the poller was reinitialized during poll()");
+        Py_DECREF(out);
+        return NULL;
+    }
+
+    return (PyObject*)out;
+}
+
+static PyObject*
+next_deadline(Poller *self, PyObject *unused)
+{
+    (void)unused;
+
+    if (self->size == 0)
+    {
+        Py_RETURN_NONE;
+    }
+
+    int64_t deadline = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&self->lock);
+    deadline = first_deadline(self);
+    pthread_mutex_unlock(&self->lock);
+    Py_END_ALLOW_THREADS
+
+    int64_t remaining = deadline - clock_ns(CLOCK_MONOTONIC);
+
+    return PyFloat_FromDouble(remaining > 0 ? remaining / 1e9 : 0.0);
+}
+
+static PyObject*
+get_interval(Poller *self, PyObject *arg)
+{
+    Py_ssize_t index = PyNumber_AsSsize_t(arg, PyExc_IndexError);
+
+    if (index == -1 && PyErr_Occurred())
+    {
+        return NULL;
+    }
+
+    if (index < 0 || index >= self->size)
+    {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        return NULL;
+    }
+
+    int64_t interval = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&self->lock);
+    interval = self->entries[index].interval;
+    pthread_mutex_unlock(&self->lock);
+    Py_END_ALLOW_THREADS
+
+    return PyFloat_FromDouble(interval / 1e9);
+}
+
+static PyObject*
+get_reads(Poller *self, void *closure)
+{
+    unsigned long long reads = 0;
+
+    (void)closure;
+
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&self->lock);
+    reads = self->reads;
+    pthread_mutex_unlock(&self->lock);
+    Py_END_ALLOW_THREADS
+
+    return PyLong_FromUnsignedLongLong(reads);
+}
+
+/**
+ * Sleep until the first subfeature is due, without the GIL. Return -1
+ * if a signal handler raised an exception.
+ */
+static int
+wait_for_deadline(Poller *self)
+{
+    for (;;)
+    {
+        int status = 0;
+
+        Py_BEGIN_ALLOW_THREADS
+        pthread_mutex_lock(&self->lock);
+        int64_t deadline = first_deadline(self);
+        pthread_mutex_unlock(&self->lock);
+
+        struct timespec until = {deadline / 1000000000,
+                                 deadline % 1000000000};
+
+        if (deadline > 0)
+        {
+            status = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until,
+                                     NULL);
+        }
+        Py_END_ALLOW_THREADS
+
+        if (status != EINTR)
+        {
+            return 0;
+        }
+
+        if (PyErr_CheckSignals() < 0)
+        {
+            return -1;
+        }
+    }
+}
+
+/**
+ * Return the earliest deadline, or 0 if there are no subfeatures. lock
+ * must be held.
+ */
+static int64_t
+first_deadline(Poller *self)
+{
+    int64_t deadline = self->size > 0 ? INT64_MAX : 0;
+
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        if (self->entries[i].deadline < deadline)
+        {
+            deadline = self->entries[i].deadline;
+        }
+    }
+
+    return deadline;
+}
+
+/**
+ * Read the subfeatures that are due into values and statuses, and
+ * schedule their next read. Return the number of subfeatures read.
+ * lock and sensors_lock must be held; the GIL isn't needed.
+ */
+static Py_ssize_t
+poll_due(Poller *self)
+{
+    int64_t now = clock_ns(CLOCK_MONOTONIC);
+    Py_ssize_t count = 0;
+
+    if (self->generation != sensors_generation ||
+        self->resolved_fast != fast_read_enabled ||
+        (fast_read_enabled && self->fast_epoch != fast_read_epoch))
+    {
+        resolve(self);
+    }
+
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        PollerEntry *entry = &self->entries[i];
+
+        if (entry->deadline > now)
+        {
+            continue;
+        }
+
+        FastReadRequest *request = &self->requests[count++];
+
+        request->entry = entry->fast;
+        request->chip = entry->chip;
+        request->number = entry->number;
+        request->index = i;
+    }
+
+    fast_read_many(self->requests, count, self->values, self->statuses);
+
+    for (Py_ssize_t k = 0; k < count; k++)
+    {
+        Py_ssize_t i = self->requests[k].index;
+
+        adapt(self, &self->entries[i], self->values[i], self->statuses[i],
+              now);
+    }
+
+    self->reads += count;
+
+    return count;
+}
+
+/**
+ * Look the chips and the fast read entries up again. sensors_lock
+ * must be held.
+ */
+static void
+resolve(Poller *self)
+{
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        PollerEntry *entry = &self->entries[i];
+
+        entry->chip = resolve_chip(&entry->name);
+        entry->fast = entry->chip == NULL || !fast_read_enabled ?
+            NULL : fast_read_lookup(entry->chip, entry->number);
+    }
+
+    self->generation = sensors_generation;
+    self->fast_epoch = fast_read_epoch;
+    self->resolved_fast = fast_read_enabled;
+}
+
+/**
+ * Update the interval of an entry after it was read at now, and
+ * schedule its next read. The interval doesn't change when the value
+ * couldn't be read.
+ */
+static void
+adapt(Poller *self, PollerEntry *entry, double value, int status,
+      int64_t now)
+{
+    int64_t min_interval = (int64_t)(self->min_interval * 1e9);
+    int64_t max_interval = (int64_t)(self->max_interval * 1e9);
+
+    if (status == 0)
+    {
+        if (entry->has_last && fabs(value - entry->last) <= self->tolerance)
+        {
+            entry->interval = entry->interval > max_interval / 2 ?
+                max_interval : entry->interval * 2;
+        }
+        else
+        {
+            entry->interval = min_interval;
+        }
+
+        entry->last = value;
+        entry->has_last = 1;
+    }
+
+    entry->deadline = now + entry->interval;
+}
+
+/*
+ * Free the block of entries, which starts with count entries whose
+ * names were copied.
+ */
+static void
+free_entries(PollerEntry *entries, Py_ssize_t count)
+{
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        free(entries[i].name.prefix);
+    }
+
+    PyMem_Free(entries);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_POLLER
+#define H_POLLER
+
+#include <Python.h>
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <sensors/sensors.h>
+
+#include "fastread.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject PollerType;
+
+
+typedef struct
+{
+    sensors_chip_name name;     /* Copy, with its own prefix */
+    int number;
+    /* Resolved for generation and fast_epoch */
+    const sensors_chip_name *chip;
+    FastReadEntry *fast;
+    int64_t interval;           /* Nanoseconds */
+    int64_t deadline;           /* CLOCK_MONOTONIC, in nanoseconds */
+    double last;                /* Last valid value */
+    int has_last;
+} PollerEntry;
+
+/*
+ * Reads subfeatures at intervals that adapt to how fast they change.
+ * Each subfeature has its own deadline; poll() only reads the ones
+ * that are due.  The interval of a subfeature doubles, up to
+ * max_interval, every time its value moves by at most tolerance, and
+ * goes back to min_interval as soon as it moves more.  lock protects
+ * the entries and the latest values, and is held while reading,
+ * without the GIL.
+ */
+typedef struct
+{
+    PyObject_HEAD
+    PyObject *pairs;            /* Tuple of the pairs given to init */
+    Py_ssize_t size;
+    PollerEntry *entries;
+    double *values;             /* Latest value of each entry */
+    int *statuses;
+    FastReadRequest *requests;  /* size requests, for poll() */
+    double min_interval;        /* Seconds */
+    double max_interval;
+    double tolerance;
+    unsigned long long reads;
+    pthread_mutex_t lock;
+    unsigned long generation;
+    unsigned long fast_epoch;
+    int resolved_fast;          /* Whether the entries use fast_read */
+} Poller;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
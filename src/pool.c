@@ -0,0 +1,192 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * A small pool of native threads, used to run independent reads at
+ * the same time.  The threads are created the first time they are
+ * needed, and stay around afterwards.  They never touch Python
+ * objects, so they don't need the GIL.
+ */
+
+#include <pthread.h>
+
+#include "pool.h"
+
+#define MAX_THREADS 16
+
+
+static void* worker(void*);
+static void run_tasks(void);
+static void reset_after_fork(void);
+
+
+/* Serializes the calls to pool_run() */
+static pthread_mutex_t run_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Protects everything below */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_available = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+static int thread_count = 0;
+static int atfork_registered = 0;
+
+/* The current job */
+static pool_task task = NULL;
+static void *task_arg = NULL;
+static int task_count = 0;
+static int next_task = 0;
+static int pending_tasks = 0;
+
+
+/**
+ * Call task(arg, i) for each i in [0, count), using up to MAX_THREADS
+ * threads in addition to the calling one, and return when they have
+ * all returned. Return -1 if no thread could be created, in which case
+ * the tasks have all been run by the calling thread.
+ */
+int pool_run(pool_task new_task, void *arg, int count)
+{
+    int status = 0;
+
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&run_lock);
+    pthread_mutex_lock(&lock);
+
+    if (!atfork_registered)
+    {
+        pthread_atfork(NULL, NULL, reset_after_fork);
+        atfork_registered = 1;
+    }
+
+    /* The calling thread runs tasks too */
+    while (thread_count < count - 1 && thread_count < MAX_THREADS)
+    {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, worker, NULL) != 0)
+        {
+            if (thread_count == 0)
+            {
+                status = -1;
+            }
+
+            break;
+        }
+
+        pthread_detach(thread);
+        thread_count++;
+    }
+
+    task = new_task;
+    task_arg = arg;
+    task_count = count;
+    next_task = 0;
+    pending_tasks = count;
+    pthread_cond_broadcast(&work_available);
+
+    run_tasks();
+
+    while (pending_tasks > 0)
+    {
+        pthread_cond_wait(&work_done, &lock);
+    }
+
+    task = NULL;
+    task_arg = NULL;
+    pthread_mutex_unlock(&lock);
+    pthread_mutex_unlock(&run_lock);
+
+    return status;
+}
+
+static void*
+worker(void *unused)
+{
+    (void)unused;
+
+    pthread_mutex_lock(&lock);
+
+    while (1)
+    {
+        while (task == NULL || next_task >= task_count)
+        {
+            pthread_cond_wait(&work_available, &lock);
+        }
+
+        run_tasks();
+    }
+
+    return NULL;
+}
+
+/*
+ * Run tasks of the current job until there are none left. lock must
+ * be held; it is released while a task runs.
+ */
+static void
+run_tasks(void)
+{
+    while (next_task < task_count)
+    {
+        int index = next_task++;
+        pool_task current_task = task;
+        void *current_arg = task_arg;
+
+        pthread_mutex_unlock(&lock);
+        current_task(current_arg, index);
+        pthread_mutex_lock(&lock);
+
+        if (--pending_tasks == 0)
+        {
+            pthread_cond_signal(&work_done);
+        }
+    }
+}
+
+/*
+ * Only the thread that called fork() exists in the child, so the pool
+ * has to start over.
+ */
+static void
+reset_after_fork(void)
+{
+    pthread_mutex_init(&run_lock, NULL);
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&work_available, NULL);
+    pthread_cond_init(&work_done, NULL);
+    thread_count = 0;
+    task = NULL;
+    task_arg = NULL;
+    task_count = 0;
+    next_task = 0;
+    pending_tasks = 0;
+}
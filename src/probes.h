@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * USDT probes for perf, bpftrace and SystemTap.  They are only
+ * compiled when SENSORS_USDT is defined, which setup.py does with
+ * "build_ext --usdt" (sys/sdt.h must be installed); otherwise they
+ * expand to nothing.  Even when compiled, a probe is a single nop
+ * until a tracer attaches to it.
+ *
+ * The provider is "sensors".  The probes about a chip pass its
+ * prefix, bus type, bus number and address first (PROBE_CHIP*).
+ */
+
+#ifndef H_PROBES
+#define H_PROBES
+
+#ifdef SENSORS_USDT
+
+#include <sys/sdt.h>
+
+#define PROBE(name) DTRACE_PROBE(sensors, name)
+#define PROBE1(name, a1) DTRACE_PROBE1(sensors, name, a1)
+#define PROBE4(name, a1, a2, a3, a4) \
+    DTRACE_PROBE4(sensors, name, a1, a2, a3, a4)
+#define PROBE5(name, a1, a2, a3, a4, a5) \
+    DTRACE_PROBE5(sensors, name, a1, a2, a3, a4, a5)
+#define PROBE6(name, a1, a2, a3, a4, a5, a6) \
+    DTRACE_PROBE6(sensors, name, a1, a2, a3, a4, a5, a6)
+
+#else
+
+#define PROBE(name) do {} while (0)
+#define PROBE1(name, a1) do {} while (0)
+#define PROBE4(name, a1, a2, a3, a4) do {} while (0)
+#define PROBE5(name, a1, a2, a3, a4, a5) do {} while (0)
+#define PROBE6(name, a1, a2, a3, a4, a5, a6) do {} while (0)
+
+#endif
+
+/* Probes about a sensors_chip_name*, with zero to two more arguments */
+#define PROBE_CHIP(name, chip)                                          \
+    PROBE4(name, (chip)->prefix, (int)(chip)->bus.type,                 \
+           (int)(chip)->bus.nr, (chip)->addr)
+#define PROBE_CHIP1(name, chip, a1)                                     \
+    PROBE5(name, (chip)->prefix, (int)(chip)->bus.type,                 \
+           (int)(chip)->bus.nr, (chip)->addr, a1)
+#define PROBE_CHIP2(name, chip, a1, a2)                                 \
+    PROBE6(name, (chip)->prefix, (int)(chip)->bus.type,                 \
+           (int)(chip)->bus.nr, (chip)->addr, a1, a2)
+
+#endif
@@ -0,0 +1,668 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * profile(): read every readable subfeature over and over for a
+ * while, and summarize the durations of the reads by chip, by adapter
+ * and by subfeature type.
+ *
+ * The reads go through fast_read_get_value(), like
+ * ChipName.get_value(), so what is measured is what polling costs in
+ * the current mode.  A round reads every subfeature once, with the
+ * lock held and the GIL released.  The lock is released between the
+ * rounds, so init() and the writes only wait for one round; if
+ * libsensors was initialized again in the meantime, the chips are gone
+ * and the profile stops.  The durations are kept until the end, so
+ * that the percentiles are exact, which is why the number of reads is
+ * limited to MAX_SAMPLES.
+ */
+
+#include <Python.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sensors/sensors.h>
+
+#include "sensorsmodule.h"
+#include "fastread.h"
+#include "profile.h"
+#include "utils.h"
+
+/* 16 MiB of durations */
+#define MAX_SAMPLES (1 << 22)
+
+
+/* A readable subfeature */
+typedef struct
+{
+    const sensors_chip_name *chip;
+    sensors_bus_id bus;
+    int chip_index;
+    int number;
+    int type;
+    uint64_t errors;
+} Target;
+
+typedef struct
+{
+    Target *targets;
+    int count;
+    /* samples[round * count + target] is a duration in nanoseconds */
+    uint32_t *samples;
+    int rounds;
+    int capacity;               /* In rounds */
+    PyObject *chip_names;       /* list of str, by chip index */
+    PyObject *adapter_names;    /* list of str or None, by chip index */
+} Profile;
+
+/* The ways the reads are grouped in the report */
+typedef enum
+{
+    BY_CHIP,
+    BY_ADAPTER,
+    BY_TYPE
+} Grouping;
+
+/* Used to sort the targets by group */
+typedef struct
+{
+    long key;
+    int target;
+} GroupEntry;
+
+
+static int collect_targets(Profile*, unsigned long*);
+static int grow(Profile*);
+static void read_round(Profile*);
+static PyObject* group(const Profile*, Grouping, uint32_t*);
+static long group_key(const Target*, Grouping);
+static PyObject* group_name(const Profile*, const Target*, Grouping);
+static PyObject* summarize(const Profile*, const GroupEntry*, int,
+                           const Target*, Grouping, uint32_t*);
+static int compare_entries(const void*, const void*);
+static int compare_samples(const void*, const void*);
+
+
+/**
+ * Read every readable subfeature of every detected chip for duration
+ * seconds, at least once, and return the report described in
+ * reference.rst. The GIL must be held.
+ */
+PyObject* profile_run(double duration)
+{
+    Profile p = {NULL, 0, NULL, 0, 0, NULL, NULL};
+    unsigned long generation = 0;
+    uint32_t *scratch = NULL;
+    PyObject *chips = NULL;
+    PyObject *adapters = NULL;
+    PyObject *types = NULL;
+    PyObject *result = NULL;
+    int stale = 0;
+
+    if (!(duration >= 0) || isinf(duration))
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "duration must be a finite number of seconds >= 0");
+        return NULL;
+    }
+
+    if (collect_targets(&p, &generation) < 0)
+    {
+        goto end;
+    }
+
+    int64_t start = clock_ns(CLOCK_MONOTONIC);
+    int64_t deadline = start + (int64_t)(duration * 1e9);
+    int64_t now = start;
+
+    do
+    {
+        int full = grow(&p);
+
+        if (full < 0)
+        {
+            goto end;
+        }
+        else if (full)
+        {
+            break;
+        }
+
+        BEGIN_SENSORS_IO
+        if (sensors_generation != generation)
+        {
+            stale = 1;
+        }
+        else
+        {
+            read_round(&p);
+        }
+        END_SENSORS_IO
+
+        if (stale)
+        {
+            break;
+        }
+
+        p.rounds++;
+        now = clock_ns(CLOCK_MONOTONIC);
+
+        if (PyErr_CheckSignals() < 0)
+        {
+            goto end;
+        }
+    } while (p.count > 0 && now < deadline);
+
+    if (p.rounds == 0)
+    {
+        PyErr_SetString(SensorsException,
+                        "libsensors was initialized again during the"
+                        " profile");
+        goto end;
+    }
+
+    scratch = PyMem_Malloc(((size_t)p.rounds * p.count + 1) *
+                           sizeof *scratch);
+
+    if (scratch == NULL)
+    {
+        PyErr_NoMemory();
+        goto end;
+    }
+
+    chips = group(&p, BY_CHIP, scratch);
+    adapters = chips == NULL ? NULL : group(&p, BY_ADAPTER, scratch);
+    types = adapters == NULL ? NULL : group(&p, BY_TYPE, scratch);
+
+    if (types == NULL)
+    {
+        goto end;
+    }
+
+    result = Py_BuildValue(
+        "{sdsisKsOsOsO}",
+        "duration", (now - start) / 1e9,
+        "rounds", p.rounds,
+        "reads", (unsigned long long)p.rounds * p.count,
+        "chips", chips,
+        "adapters", adapters,
+        "types", types);
+
+end:
+    PyMem_Free(p.targets);
+    PyMem_Free(p.samples);
+    PyMem_Free(scratch);
+    Py_XDECREF(p.chip_names);
+    Py_XDECREF(p.adapter_names);
+    Py_XDECREF(chips);
+    Py_XDECREF(adapters);
+    Py_XDECREF(types);
+    return result;
+}
+
+/*
+ * Fill the targets, the chip names and the adapter names of p, and
+ * set generation to the sensors_generation they belong to. Return -1
+ * with an exception set on error.
+ */
+static int
+collect_targets(Profile *p, unsigned long *generation)
+{
+    const sensors_chip_name *chip = NULL;
+    const sensors_feature *feature = NULL;
+    const sensors_subfeature *subfeature = NULL;
+    int chip_nr = 0;
+    int size = 0;
+    int chip_count = 0;
+    int no_memory = 0;
+    int result = -1;
+    /* Copies of the names, turned into Python strings once the lock is
+     * released */
+    char **chip_texts = NULL;
+    char **adapter_texts = NULL;
+
+    LOCK_SENSORS();
+
+    /* Count the targets first, so that the array is allocated once */
+    while ((chip = sensors_get_detected_chips(NULL, &chip_nr)) != NULL)
+    {
+        int feature_nr = 0;
+
+        chip_count++;
+
+        while ((feature = sensors_get_features(chip, &feature_nr)) != NULL)
+        {
+            int subfeature_nr = 0;
+
+            while ((subfeature = sensors_get_all_subfeatures(
+                        chip, feature, &subfeature_nr)) != NULL)
+            {
+                size += (subfeature->flags & SENSORS_MODE_R) != 0;
+            }
+        }
+    }
+
+    p->targets = PyMem_Malloc((size + 1) * sizeof *p->targets);
+    chip_texts = PyMem_Malloc((chip_count + 1) * sizeof *chip_texts);
+    adapter_texts = PyMem_Malloc((chip_count + 1) * sizeof *adapter_texts);
+
+    if (p->targets == NULL || chip_texts == NULL || adapter_texts == NULL)
+    {
+        no_memory = 1;
+        goto unlock;
+    }
+
+    memset(chip_texts, 0, (chip_count + 1) * sizeof *chip_texts);
+    memset(adapter_texts, 0, (chip_count + 1) * sizeof *adapter_texts);
+
+    int chip_index = 0;
+    chip_nr = 0;
+
+    while ((chip = sensors_get_detected_chips(NULL, &chip_nr)) != NULL)
+    {
+        char buffer[512];
+        int feature_nr = 0;
+        const char *adapter = sensors_get_adapter_name(&chip->bus);
+
+        if (sensors_snprintf_chip_name(buffer, sizeof buffer, chip) < 0)
+        {
+            chip_texts[chip_index] = strdup(chip->prefix);
+        }
+        else
+        {
+            chip_texts[chip_index] = strdup(buffer);
+        }
+
+        if (adapter != NULL)
+        {
+            adapter_texts[chip_index] = strdup(adapter);
+        }
+
+        if (chip_texts[chip_index] == NULL ||
+            (adapter != NULL && adapter_texts[chip_index] == NULL))
+        {
+            no_memory = 1;
+            goto unlock;
+        }
+
+        while ((feature = sensors_get_features(chip, &feature_nr)) != NULL)
+        {
+            int subfeature_nr = 0;
+
+            while ((subfeature = sensors_get_all_subfeatures(
+                        chip, feature, &subfeature_nr)) != NULL &&
+                   p->count < size)
+            {
+                if (!(subfeature->flags & SENSORS_MODE_R))
+                {
+                    continue;
+                }
+
+                Target *target = &p->targets[p->count++];
+                target->chip = chip;
+                target->bus = chip->bus;
+                target->chip_index = chip_index;
+                target->number = subfeature->number;
+                target->type = subfeature->type;
+                target->errors = 0;
+            }
+        }
+
+        chip_index++;
+    }
+
+    *generation = sensors_generation;
+
+unlock:
+    UNLOCK_SENSORS();
+
+    if (no_memory)
+    {
+        PyErr_NoMemory();
+        goto end;
+    }
+
+    p->chip_names = PyList_New(chip_count);
+    p->adapter_names = PyList_New(chip_count);
+
+    if (p->chip_names == NULL || p->adapter_names == NULL)
+    {
+        goto end;
+    }
+
+    for (int c = 0; c < chip_count; c++)
+    {
+        PyObject *chip_name = PyString_FromString(chip_texts[c]);
+        PyObject *adapter_name = Py_None;
+
+        if (adapter_texts[c] == NULL)
+        {
+            Py_INCREF(adapter_name);
+        }
+        else
+        {
+            adapter_name = PyString_FromString(adapter_texts[c]);
+        }
+
+        if (chip_name == NULL || adapter_name == NULL)
+        {
+            Py_XDECREF(chip_name);
+            Py_XDECREF(adapter_name);
+            goto end;
+        }
+
+        PyList_SET_ITEM(p->chip_names, c, chip_name);
+        PyList_SET_ITEM(p->adapter_names, c, adapter_name);
+    }
+
+    result = 0;
+
+end:
+    if (chip_texts != NULL && adapter_texts != NULL)
+    {
+        for (int c = 0; c < chip_count; c++)
+        {
+            free(chip_texts[c]);
+            free(adapter_texts[c]);
+        }
+    }
+
+    PyMem_Free(chip_texts);
+    PyMem_Free(adapter_texts);
+
+    return result;
+}
+
+/*
+ * Make room in p for one more round. Return 1 if MAX_SAMPLES would be
+ * exceeded, and -1 with an exception set if memory couldn't be
+ * allocated.
+ */
+static int
+grow(Profile *p)
+{
+    if (p->rounds < p->capacity || p->count == 0)
+    {
+        return 0;
+    }
+
+    int max_rounds = MAX_SAMPLES / p->count;
+
+    /* The first round is always done */
+    if (p->rounds > 0 && p->rounds >= max_rounds)
+    {
+        return 1;
+    }
+
+    int capacity = p->capacity == 0 ? 16 : p->capacity * 2;
+
+    if (capacity > max_rounds)
+    {
+        capacity = max_rounds > p->rounds ? max_rounds : p->rounds + 1;
+    }
+
+    uint32_t *samples = PyMem_Realloc(
+        p->samples, (size_t)capacity * p->count * sizeof *samples);
+
+    if (samples == NULL)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    p->samples = samples;
+    p->capacity = capacity;
+
+    return 0;
+}
+
+/*
+ * Read every target once. This must be called with sensors_lock held,
+ * and doesn't need the GIL.
+ */
+static void
+read_round(Profile *p)
+{
+    uint32_t *row = p->samples + (size_t)p->rounds * p->count;
+    int64_t before = clock_ns(CLOCK_MONOTONIC);
+
+    for (int i = 0; i < p->count; i++)
+    {
+        Target *target = &p->targets[i];
+        double value = 0;
+
+        if (fast_read_get_value(target->chip, target->number, &value) != 0)
+        {
+            target->errors++;
+        }
+
+        /* The end of a read is the start of the next one, which saves
+         * a call to the clock per read */
+        int64_t after = clock_ns(CLOCK_MONOTONIC);
+        int64_t elapsed = after - before;
+
+        row[i] = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+        before = after;
+    }
+}
+
+/*
+ * Return a dict mapping the name of each group to its summary.
+ * scratch must have room for all the samples.
+ */
+static PyObject*
+group(const Profile *p, Grouping grouping, uint32_t *scratch)
+{
+    PyObject *result = PyDict_New();
+    GroupEntry *entries = PyMem_Malloc((p->count + 1) * sizeof *entries);
+
+    if (result == NULL || entries == NULL)
+    {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (int i = 0; i < p->count; i++)
+    {
+        entries[i].key = group_key(&p->targets[i], grouping);
+        entries[i].target = i;
+    }
+
+    qsort(entries, p->count, sizeof *entries, compare_entries);
+
+    for (int start = 0, end = 0; start < p->count; start = end)
+    {
+        while (end < p->count && entries[end].key == entries[start].key)
+        {
+            end++;
+        }
+
+        const Target *first = &p->targets[entries[start].target];
+        PyObject *name = group_name(p, first, grouping);
+        PyObject *summary = summarize(p, entries + start, end - start,
+                                      first, grouping, scratch);
+
+        if (name == NULL || summary == NULL ||
+            PyDict_SetItem(result, name, summary) < 0)
+        {
+            Py_XDECREF(name);
+            Py_XDECREF(summary);
+            goto error;
+        }
+
+        Py_DECREF(name);
+        Py_DECREF(summary);
+    }
+
+    PyMem_Free(entries);
+
+    return result;
+
+error:
+    PyMem_Free(entries);
+    Py_XDECREF(result);
+    return NULL;
+}
+
+static long
+group_key(const Target *target, Grouping grouping)
+{
+    switch (grouping)
+    {
+    case BY_CHIP:
+        return target->chip_index;
+    case BY_ADAPTER:
+        return (long)target->bus.type << 16 | (unsigned short)target->bus.nr;
+    default:
+        return target->type;
+    }
+}
+
+/* Return a new reference to the key of the group of target */
+static PyObject*
+group_name(const Profile *p, const Target *target, Grouping grouping)
+{
+    PyObject *name = NULL;
+
+    switch (grouping)
+    {
+    case BY_CHIP:
+        name = PyList_GET_ITEM(p->chip_names, target->chip_index);
+        Py_INCREF(name);
+        return name;
+    case BY_ADAPTER:
+        return Py_BuildValue("(ii)", target->bus.type, target->bus.nr);
+    default:
+        return PyLong_FromLong(target->type);
+    }
+}
+
+/*
+ * Return the summary of the reads of the count targets of entries, as
+ * a dict. first is the first of these targets.
+ */
+static PyObject*
+summarize(const Profile *p, const GroupEntry *entries, int count,
+          const Target *first, Grouping grouping, uint32_t *scratch)
+{
+    size_t n = 0;
+    uint64_t total = 0;
+    uint64_t errors = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        int t = entries[i].target;
+
+        errors += p->targets[t].errors;
+
+        for (int r = 0; r < p->rounds; r++)
+        {
+            uint32_t sample = p->samples[(size_t)r * p->count + t];
+
+            scratch[n++] = sample;
+            total += sample;
+        }
+    }
+
+    qsort(scratch, n, sizeof *scratch, compare_samples);
+
+    /* Nearest rank */
+    uint32_t p99 = scratch[(n * 99 + 99) / 100 - 1];
+    PyObject *summary = Py_BuildValue(
+        "{sisKsKsKsIsIsK}",
+        "subfeatures", count,
+        "reads", (unsigned long long)n,
+        "errors", (unsigned long long)errors,
+        "mean_ns", (unsigned long long)(total / n),
+        "p99_ns", (unsigned int)p99,
+        "max_ns", (unsigned int)scratch[n - 1],
+        "round_ns", (unsigned long long)(total / p->rounds));
+
+    if (summary == NULL)
+    {
+        return NULL;
+    }
+
+    PyObject *extra = NULL;
+    const char *extra_name = NULL;
+
+    if (grouping == BY_CHIP)
+    {
+        extra_name = "adapter";
+        extra = group_name(p, first, BY_ADAPTER);
+    }
+    else if (grouping == BY_ADAPTER)
+    {
+        extra_name = "name";
+        extra = PyList_GET_ITEM(p->adapter_names, first->chip_index);
+        Py_INCREF(extra);
+    }
+    else
+    {
+        return summary;
+    }
+
+    if (extra == NULL ||
+        PyDict_SetItemString(summary, extra_name, extra) < 0)
+    {
+        Py_XDECREF(extra);
+        Py_DECREF(summary);
+        return NULL;
+    }
+
+    Py_DECREF(extra);
+
+    return summary;
+}
+
+static int
+compare_entries(const void *a, const void *b)
+{
+    const GroupEntry *x = a;
+    const GroupEntry *y = b;
+
+    if (x->key != y->key)
+    {
+        return x->key < y->key ? -1 : 1;
+    }
+
+    return x->target - y->target;
+}
+
+static int
+compare_samples(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
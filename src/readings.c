@@ -0,0 +1,531 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include <sensors/error.h>
+
+#include "sensorsmodule.h"
+#include "readings.h"
+
+
+static void dealloc(Readings*);
+static PyObject* repr(Readings*);
+static Py_ssize_t length(Readings*);
+static PyObject* item(Readings*, Py_ssize_t);
+static PyObject* get_status(Readings*, PyObject*, PyObject*);
+static PyObject* get_error(Readings*, PyObject*, PyObject*);
+static PyObject* get_timestamp(Readings*, PyObject*, PyObject*);
+static PyObject* get_values(Readings*, void*);
+static PyObject* get_statuses(Readings*, void*);
+static PyObject* get_timestamps(Readings*, void*);
+static int get_buffer(Readings*, Py_buffer*, int);
+static void set_shape(Readings*, Py_ssize_t*, Py_ssize_t*, Py_ssize_t);
+static PyObject* array_view(Readings*, void*, const char*, Py_ssize_t, int);
+static void array_dealloc(ReadingsArray*);
+static int array_get_buffer(ReadingsArray*, Py_buffer*, int);
+static int fill_buffer(Py_buffer*, PyObject*, void*, const char*,
+                       Py_ssize_t, int, Py_ssize_t*, Py_ssize_t*, int);
+static int check_index(Readings*, Py_ssize_t);
+
+
+static PyMethodDef methods[] = {
+    {"get_status", (PyCFunction)get_status, METH_VARARGS | METH_KEYWORDS,
+     "Return 0 if the value at index was read successfully, or the"
+     " (negative) libsensors error code otherwise."},
+    {"get_error", (PyCFunction)get_error, METH_VARARGS | METH_KEYWORDS,
+     "Return the libsensors error message for the value at index, or"
+     " None if it was read successfully."},
+    {"get_timestamp", (PyCFunction)get_timestamp,
+     METH_VARARGS | METH_KEYWORDS,
+     "Return the time at which row was read, in seconds, or None if the"
+     " readings have no timestamps. The time is since the epoch for a"
+     " Sampler, and on CLOCK_MONOTONIC for a History."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef members[] =
+{
+    {"rows", T_PYSSIZET, offsetof(Readings, rows), READONLY,
+     "Number of rows."},
+    {"columns", T_PYSSIZET, offsetof(Readings, columns), READONLY,
+     "Number of values in each row."},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyGetSetDef getsetters[] = {
+    {"values", (getter)get_values, NULL,
+     "memoryview of the values, as doubles.", NULL},
+    {"statuses", (getter)get_statuses, NULL,
+     "memoryview of the statuses, as C ints.", NULL},
+    {"timestamps", (getter)get_timestamps, NULL,
+     "memoryview of the timestamps of the rows, as doubles, or None if"
+     " there are none.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PySequenceMethods sequence_methods = {
+    (lenfunc)length,           /* sq_length */
+    0,                         /* sq_concat */
+    0,                         /* sq_repeat */
+    (ssizeargfunc)item,        /* sq_item */
+};
+
+static PyBufferProcs buffer_procs =
+    INIT_BUFFER_PROCS((getbufferproc)get_buffer, NULL);
+
+static PyBufferProcs array_buffer_procs =
+    INIT_BUFFER_PROCS((getbufferproc)array_get_buffer, NULL);
+
+PyTypeObject ReadingsType =
+{
+    INIT_TYPE_HEAD
+    "sensors.Readings",        /*tp_name*/
+    sizeof(Readings),          /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &sequence_methods,         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    &buffer_procs,             /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | TPFLAGS_NEWBUFFER, /*tp_flags*/
+    "Values returned by a batch read. r[i] is a float, or None if the"
+    " value couldn't be read; get_status() and get_error() tell why."
+    " The values are also exported as doubles by the buffer protocol.",
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    members,                   /* tp_members */
+    getsetters,                /* tp_getset */
+};
+
+PyTypeObject ReadingsArrayType =
+{
+    INIT_TYPE_HEAD
+    "sensors.ReadingsArray",   /*tp_name*/
+    sizeof(ReadingsArray),     /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)array_dealloc, /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    0,                         /*tp_repr*/
+    0,                         /*tp_as_number*/
+    0,                         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    &array_buffer_procs,       /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | TPFLAGS_NEWBUFFER, /*tp_flags*/
+    "Array of a Readings object, exported by the buffer protocol.",
+};
+
+
+/**
+ * Create a Readings object with room for size values, in a single
+ * row. The values are zeroed and all the statuses are set to 0.
+ */
+Readings* readings_new(Py_ssize_t size)
+{
+    Readings *self = PyObject_New(Readings, &ReadingsType);
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    self->size = size;
+    self->rows = 1;
+    self->columns = size;
+    self->values = NULL;
+    self->statuses = NULL;
+    self->timestamps = NULL;
+    self->monotonic = 0;
+
+    if (size > 0)
+    {
+        /* One block for both arrays; the doubles come first so that
+         * they stay aligned. */
+        char *block = PyMem_Malloc(size * (sizeof(double) + sizeof(int)));
+
+        if (block == NULL)
+        {
+            Py_DECREF(self);
+            return (Readings*)PyErr_NoMemory();
+        }
+
+        memset(block, 0, size * (sizeof(double) + sizeof(int)));
+        self->values = (double*)block;
+        self->statuses = (int*)(block + size * sizeof(double));
+    }
+
+    return self;
+}
+
+/**
+ * Create a Readings object with rows rows of columns values, and a
+ * timestamp for each row, which the caller has to set.
+ */
+Readings* readings_new_rows(Py_ssize_t rows, Py_ssize_t columns)
+{
+    Readings *self = readings_new(rows * columns);
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    self->rows = rows;
+    self->columns = columns;
+
+    if (rows > 0)
+    {
+        self->timestamps = PyMem_Malloc(rows * sizeof(double));
+
+        if (self->timestamps == NULL)
+        {
+            Py_DECREF(self);
+            return (Readings*)PyErr_NoMemory();
+        }
+    }
+
+    return self;
+}
+
+static void
+dealloc(Readings *self)
+{
+    PyMem_Free(self->values);
+    PyMem_Free(self->timestamps);
+    self->values = NULL;
+    self->statuses = NULL;
+    self->timestamps = NULL;
+    FREE_OBJECT(self);
+}
+
+static PyObject*
+repr(Readings *self)
+{
+    if (self->timestamps != NULL)
+    {
+        return PyString_FromFormat("Readings(rows=%zd, columns=%zd)",
+                                   self->rows, self->columns);
+    }
+
+    return PyString_FromFormat("Readings(size=%zd)", self->size);
+}
+
+static Py_ssize_t
+length(Readings *self)
+{
+    return self->size;
+}
+
+static PyObject*
+item(Readings *self, Py_ssize_t i)
+{
+    if (check_index(self, i) < 0)
+    {
+        return NULL;
+    }
+
+    if (self->statuses[i] != 0)
+    {
+        Py_RETURN_NONE;
+    }
+
+    return PyFloat_FromDouble(self->values[i]);
+}
+
+static PyObject*
+get_status(Readings *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"index", NULL};
+    Py_ssize_t i = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", kwlist, &i))
+    {
+        return NULL;
+    }
+
+    if (check_index(self, i) < 0)
+    {
+        return NULL;
+    }
+
+    return PyLong_FromLong(self->statuses[i]);
+}
+
+static PyObject*
+get_error(Readings *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"index", NULL};
+    Py_ssize_t i = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", kwlist, &i))
+    {
+        return NULL;
+    }
+
+    if (check_index(self, i) < 0)
+    {
+        return NULL;
+    }
+
+    if (self->statuses[i] == 0)
+    {
+        Py_RETURN_NONE;
+    }
+
+    return PyString_FromString(sensors_strerror(self->statuses[i]));
+}
+
+static PyObject*
+get_timestamp(Readings *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"row", NULL};
+    Py_ssize_t row = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", kwlist, &row))
+    {
+        return NULL;
+    }
+
+    if (row < 0 || row >= self->rows)
+    {
+        PyErr_SetString(PyExc_IndexError, "Readings row out of range");
+        return NULL;
+    }
+
+    if (self->timestamps == NULL)
+    {
+        Py_RETURN_NONE;
+    }
+
+    return PyFloat_FromDouble(self->timestamps[row]);
+}
+
+static PyObject*
+get_values(Readings *self, void *closure)
+{
+    (void)closure;
+
+    return PyMemoryView_FromObject((PyObject*)self);
+}
+
+static PyObject*
+get_statuses(Readings *self, void *closure)
+{
+    (void)closure;
+
+    return array_view(self, self->statuses, "i", sizeof(int), 0);
+}
+
+static PyObject*
+get_timestamps(Readings *self, void *closure)
+{
+    (void)closure;
+
+    if (self->timestamps == NULL)
+    {
+        Py_RETURN_NONE;
+    }
+
+    return array_view(self, self->timestamps, "d", sizeof(double), 1);
+}
+
+/*
+ * The values have one dimension, or two (rows and columns) when the
+ * readings come from a Sampler.
+ */
+static int
+get_buffer(Readings *self, Py_buffer *view, int flags)
+{
+    set_shape(self, self->shape, self->strides, sizeof(double));
+
+    return fill_buffer(view, (PyObject*)self, self->values, "d",
+                       sizeof(double), self->timestamps != NULL ? 2 : 1,
+                       self->shape, self->strides, flags);
+}
+
+static void
+set_shape(Readings *self, Py_ssize_t *shape, Py_ssize_t *strides,
+          Py_ssize_t itemsize)
+{
+    if (self->timestamps != NULL)
+    {
+        shape[0] = self->rows;
+        shape[1] = self->columns;
+        strides[0] = self->columns * itemsize;
+        strides[1] = itemsize;
+    }
+    else
+    {
+        shape[0] = self->size;
+        strides[0] = itemsize;
+    }
+}
+
+/*
+ * Return a memoryview of buf, which belongs to self. If timestamps is
+ * set, buf has one item per row, otherwise it has the shape of the
+ * values.
+ */
+static PyObject*
+array_view(Readings *self, void *buf, const char *format,
+           Py_ssize_t itemsize, int timestamps)
+{
+    ReadingsArray *array = PyObject_New(ReadingsArray, &ReadingsArrayType);
+
+    if (array == NULL)
+    {
+        return NULL;
+    }
+
+    Py_INCREF(self);
+    array->readings = self;
+    array->buf = buf;
+    array->format = format;
+    array->itemsize = itemsize;
+
+    if (timestamps)
+    {
+        array->ndim = 1;
+        array->shape[0] = self->rows;
+        array->strides[0] = itemsize;
+    }
+    else
+    {
+        array->ndim = self->timestamps != NULL ? 2 : 1;
+        set_shape(self, array->shape, array->strides, itemsize);
+    }
+
+    PyObject *view = PyMemoryView_FromObject((PyObject*)array);
+    Py_DECREF(array);
+
+    return view;
+}
+
+static void
+array_dealloc(ReadingsArray *self)
+{
+    Py_XDECREF(self->readings);
+    FREE_OBJECT(self);
+}
+
+static int
+array_get_buffer(ReadingsArray *self, Py_buffer *view, int flags)
+{
+    return fill_buffer(view, (PyObject*)self, self->buf, self->format,
+                       self->itemsize, self->ndim, self->shape,
+                       self->strides, flags);
+}
+
+/*
+ * Fill view with a read-only, C-contiguous array of exporter.
+ */
+static int
+fill_buffer(Py_buffer *view, PyObject *exporter, void *buf,
+            const char *format, Py_ssize_t itemsize, int ndim,
+            Py_ssize_t *shape, Py_ssize_t *strides, int flags)
+{
+    /* Empty readings have no array, but buf can't be NULL */
+    static double empty = 0.0;
+    Py_ssize_t count = 1;
+
+    if (flags & PyBUF_WRITABLE)
+    {
+        PyErr_SetString(PyExc_BufferError, "Readings are read-only");
+        view->obj = NULL;
+        return -1;
+    }
+
+    for (int i = 0; i < ndim; i++)
+    {
+        count *= shape[i];
+    }
+
+    view->buf = buf != NULL ? buf : &empty;
+    view->obj = exporter;
+    Py_INCREF(exporter);
+    view->len = count * itemsize;
+    view->readonly = 1;
+    view->itemsize = itemsize;
+    view->format = (flags & PyBUF_FORMAT) ? (char*)format : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    if ((flags & PyBUF_ND) == PyBUF_ND)
+    {
+        view->ndim = ndim;
+        view->shape = shape;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ?
+            strides : NULL;
+    }
+    else
+    {
+        /* The consumer only wants bytes */
+        view->ndim = 1;
+        view->shape = NULL;
+        view->strides = NULL;
+    }
+
+    return 0;
+}
+
+static int
+check_index(Readings *self, Py_ssize_t i)
+{
+    if (i < 0 || i >= self->size)
+    {
+        PyErr_SetString(PyExc_IndexError, "Readings index out of range");
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_READINGS
+#define H_READINGS
+
+#include <Python.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject ReadingsType;
+extern PyTypeObject ReadingsArrayType;
+
+
+/*
+ * Result of a batch read.  values and statuses are parallel arrays
+ * of size elements; statuses[i] is 0 when values[i] is valid, or the
+ * negative error code returned by libsensors otherwise.  Both arrays
+ * live in the same memory block.
+ *
+ * The values can be split in rows of the same length, for example
+ * one per sample of a Sampler; value j of row i is at index
+ * i * columns + j.  timestamps holds the time of each row, or is NULL
+ * when there are none.  The times are in seconds since the epoch,
+ * unless monotonic is set, in which case they are on CLOCK_MONOTONIC.
+ */
+typedef struct
+{
+    PyObject_HEAD
+    Py_ssize_t size;
+    Py_ssize_t rows;
+    Py_ssize_t columns;
+    double *values;
+    int *statuses;
+    double *timestamps;
+    int monotonic;
+    /* Exported by the buffer protocol */
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+} Readings;
+
+/*
+ * Exports one of the arrays of a Readings object through the buffer
+ * protocol, for the statuses and timestamps properties.
+ */
+typedef struct
+{
+    PyObject_HEAD
+    Readings *readings;
+    void *buf;
+    const char *format;
+    Py_ssize_t itemsize;
+    int ndim;
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+} ReadingsArray;
+
+Readings* readings_new(Py_ssize_t size);
+Readings* readings_new_rows(Py_ssize_t rows, Py_ssize_t columns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
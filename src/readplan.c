@@ -0,0 +1,628 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+
+#include <limits.h>
+
+#include <sensors/sensors.h>
+#include <sensors/error.h>
+
+#include "sensorsmodule.h"
+#include "chipname.h"
+#include "subfeature.h"
+#include "readings.h"
+#include "readplan.h"
+#include "utils.h"
+
+/* Returned by add_chip() when memory couldn't be allocated, besides the
+ * negative libsensors error codes */
+#define NO_MEMORY INT_MIN
+
+
+static PyObject* new(PyTypeObject*, PyObject*, PyObject*);
+static int init(ReadPlan*, PyObject*, PyObject*);
+static void dealloc(ReadPlan*);
+static PyObject* repr(ReadPlan*);
+static Py_ssize_t length(ReadPlan*);
+static PyObject* plan_read(ReadPlan*, PyObject*, PyObject*);
+static int add_chip(ReadPlan*, const sensors_chip_name*);
+static void free_chips(ReadPlan*);
+static void resolve(ReadPlan*);
+static void resolve_fast_read(ReadPlan*);
+static int compute_groups(ReadPlan*);
+static void update_requests(ReadPlan*);
+
+
+static PyMethodDef methods[] = {
+    {"read", (PyCFunction)plan_read, METH_VARARGS | METH_KEYWORDS,
+     "Read all the subfeatures of the plan, and return them as a Readings"
+     " object. If out is given, it must be a Readings object returned by"
+     " a previous call; it is filled and returned instead of allocating"
+     " a new one."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PySequenceMethods sequence_methods = {
+    (lenfunc)length,           /* sq_length */
+};
+
+PyTypeObject ReadPlanType =
+{
+    INIT_TYPE_HEAD
+    "sensors.ReadPlan",        /*tp_name*/
+    sizeof(ReadPlan),          /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &sequence_methods,         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "ReadPlan(pairs, parallel=False)\n\n"
+    "A fixed set of subfeatures to read repeatedly. pairs is a sequence"
+    " of (ChipName, Subfeature) tuples; the subfeature can also be given"
+    " as its number. The chips are looked up once, and they can't"
+    " contain wildcard values. If parallel is true, the chips that are"
+    " on different buses are read at the same time by native threads.",
+    /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    0,                         /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    (initproc)init,            /* tp_init */
+    0,                         /* tp_alloc */
+    new,                       /* tp_new */
+};
+
+
+static PyObject*
+new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    ReadPlan *self = (ReadPlan*)PyType_GenericNew(type, args, kwargs);
+
+    if (self != NULL)
+    {
+        pthread_mutex_init(&self->lock, NULL);
+    }
+
+    return (PyObject*)self;
+}
+
+
+static int
+init(ReadPlan *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"pairs", "parallel", NULL};
+    PyObject *pairs = NULL;
+    PyObject *parallel = Py_False;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, &pairs,
+                                     &parallel))
+    {
+        return -1;
+    }
+
+    /* The users of a plan size their buffers once, from its size */
+    if (self->entries != NULL)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "a read plan can't be reinitialized");
+        return -1;
+    }
+
+    self->parallel = PyObject_IsTrue(parallel);
+
+    if (self->parallel < 0)
+    {
+        return -1;
+    }
+
+    PyObject *seq = PySequence_Fast(
+        pairs, "pairs must be a sequence of (ChipName, Subfeature) tuples");
+
+    /* The parsing may run Python code, which could change a list */
+    if (seq != NULL && PyList_Check(seq))
+    {
+        PyObject *tuple = PyList_AsTuple(seq);
+
+        Py_DECREF(seq);
+        seq = tuple;
+    }
+
+    if (seq == NULL)
+    {
+        return -1;
+    }
+
+    self->group_count = 0;
+    self->size = PySequence_Fast_GET_SIZE(seq);
+    self->entries = PyMem_Malloc((self->size + 1) * sizeof(PlanEntry));
+    self->fast_epoch = 0;
+    /* Copies of the chip names, since LOCK_SENSORS() may release the
+     * GIL, and other threads could then change the ChipName objects */
+    sensors_chip_name *names = PyMem_Malloc(
+        (self->size + 1) * sizeof *names);
+    Py_ssize_t name_count = 0;
+    int error = 0;
+
+    if (self->entries == NULL || names == NULL)
+    {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    /* Parse everything first, since the parsing may run Python code,
+     * which can't be done while holding sensors_lock */
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        ChipName *chip_name = NULL;
+        int number = -1;
+
+        if (read_plan_parse_pair(PySequence_Fast_GET_ITEM(seq, i),
+                                 &chip_name, &number) < 0)
+        {
+            goto error;
+        }
+
+        if (chip_name_has_wildcards(&chip_name->chip_name))
+        {
+            PyErr_SetString(SensorsException,
+                            sensors_strerror(-SENSORS_ERR_WILDCARDS));
+            goto error;
+        }
+
+        if (copy_chip_name(&chip_name->chip_name, &names[i]) < 0)
+        {
+            PyErr_NoMemory();
+            goto error;
+        }
+
+        name_count++;
+        self->entries[i].number = number;
+        self->entries[i].fast = NULL;
+    }
+
+    LOCK_SENSORS();
+    self->generation = sensors_generation;
+
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        int chip = add_chip(self, &names[i]);
+
+        if (chip < 0)
+        {
+            error = chip;
+            break;
+        }
+
+        const sensors_subfeature *subfeature = find_subfeature(
+            self->chips[chip].chip, self->entries[i].number);
+
+        if (subfeature == NULL)
+        {
+            error = -SENSORS_ERR_NO_ENTRY;
+            break;
+        }
+
+        if (!(subfeature->flags & SENSORS_MODE_R))
+        {
+            error = -SENSORS_ERR_ACCESS_R;
+            break;
+        }
+
+        self->entries[i].chip = chip;
+    }
+
+    UNLOCK_SENSORS();
+
+    if (error == NO_MEMORY)
+    {
+        PyErr_NoMemory();
+        goto error;
+    }
+    else if (error != 0)
+    {
+        PyErr_SetString(SensorsException, sensors_strerror(error));
+        goto error;
+    }
+
+    if (compute_groups(self) < 0)
+    {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (Py_ssize_t i = 0; i < name_count; i++)
+    {
+        free_chip_name(&names[i]);
+    }
+
+    PyMem_Free(names);
+    Py_DECREF(seq);
+
+    return 0;
+
+error:
+    for (Py_ssize_t i = 0; i < name_count; i++)
+    {
+        free_chip_name(&names[i]);
+    }
+
+    PyMem_Free(names);
+    Py_DECREF(seq);
+    free_chips(self);
+    PyMem_Free(self->entries);
+    self->entries = NULL;
+    self->size = 0;
+    return -1;
+}
+
+static void
+dealloc(ReadPlan *self)
+{
+    free_chips(self);
+    PyMem_Free(self->entries);
+    self->entries = NULL;
+    PyMem_Free(self->group_starts);
+    self->group_starts = NULL;
+    PyMem_Free(self->requests);
+    self->requests = NULL;
+    pthread_mutex_destroy(&self->lock);
+    FREE_OBJECT(self);
+}
+
+static PyObject*
+repr(ReadPlan *self)
+{
+    return PyString_FromFormat("ReadPlan(size=%zd, chips=%d)", self->size,
+                               self->chip_count);
+}
+
+static Py_ssize_t
+length(ReadPlan *self)
+{
+    return self->size;
+}
+
+static PyObject*
+plan_read(ReadPlan *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"out", NULL};
+    Readings *out = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O!", kwlist,
+                                     &ReadingsType, &out))
+    {
+        return NULL;
+    }
+
+    if (out == NULL)
+    {
+        out = readings_new(self->size);
+
+        if (out == NULL)
+        {
+            return NULL;
+        }
+    }
+    else if (out->size != self->size)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "out doesn't have the same size as the plan");
+        return NULL;
+    }
+    else
+    {
+        Py_INCREF(out);
+    }
+
+    BEGIN_SENSORS_IO
+    read_plan_read(self, out->values, out->statuses);
+    END_SENSORS_IO
+
+    return (PyObject*)out;
+}
+
+/**
+ * Read every entry of the plan into values and statuses, which must
+ * have room for plan->size elements. The statuses are 0 for valid
+ * values, or negative libsensors error codes. sensors_lock must be
+ * held; the GIL isn't needed.
+ */
+void read_plan_read(ReadPlan *plan, double *values, int *statuses)
+{
+    pthread_mutex_lock(&plan->lock);
+
+    int changed = plan->requests_fast != fast_read_enabled;
+
+    if (plan->generation != sensors_generation)
+    {
+        resolve(plan);
+        changed = 1;
+    }
+
+    if (fast_read_enabled && plan->fast_epoch != fast_read_epoch)
+    {
+        resolve_fast_read(plan);
+        changed = 1;
+    }
+
+    if (changed)
+    {
+        update_requests(plan);
+    }
+
+    pthread_mutex_unlock(&plan->lock);
+
+    fast_read_grouped(plan->requests, plan->group_starts, plan->group_count,
+                      plan->parallel, values, statuses);
+}
+
+/**
+ * Get the chip and the subfeature number of a (ChipName, Subfeature)
+ * or (ChipName, int) tuple. The reference to the chip is borrowed from
+ * the tuple. Return -1 and set an exception on failure.
+ */
+int read_plan_parse_pair(PyObject *pair, ChipName **chip_name, int *number)
+{
+    PyObject *py_subfeature = NULL;
+
+    if (!PyTuple_Check(pair) ||
+        !PyArg_ParseTuple(pair, "O!O", &ChipNameType, chip_name,
+                          &py_subfeature))
+    {
+        PyErr_SetString(PyExc_TypeError,
+                        "pairs must contain (ChipName, Subfeature) tuples");
+        return -1;
+    }
+
+    if (PyObject_IsInstance(py_subfeature, (PyObject*)&SubfeatureType))
+    {
+        *number = ((Subfeature*)py_subfeature)->subfeature.number;
+    }
+    else if (parse_subfeature_number(py_subfeature, number) < 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Return the index of name in the chips of the plan, adding it if
+ * needed. -SENSORS_ERR_NO_ENTRY is returned if the chip isn't detected,
+ * and NO_MEMORY if memory couldn't be allocated. No exception is set,
+ * since this is called with sensors_lock held.
+ */
+static int
+add_chip(ReadPlan *self, const sensors_chip_name *name)
+{
+    for (int i = 0; i < self->chip_count; i++)
+    {
+        const sensors_chip_name *other = &self->chips[i].name;
+
+        if (strcmp(name->prefix, other->prefix) == 0 &&
+            name->bus.type == other->bus.type &&
+            name->bus.nr == other->bus.nr &&
+            name->addr == other->addr)
+        {
+            return i;
+        }
+    }
+
+    const sensors_chip_name *chip = resolve_chip(name);
+
+    if (chip == NULL)
+    {
+        return -SENSORS_ERR_NO_ENTRY;
+    }
+
+    PlanChip *chips = PyMem_Realloc(self->chips,
+                                    (self->chip_count + 1) * sizeof(PlanChip));
+
+    if (chips == NULL)
+    {
+        return NO_MEMORY;
+    }
+
+    self->chips = chips;
+
+    PlanChip *plan_chip = &self->chips[self->chip_count];
+    plan_chip->name = *name;
+    plan_chip->name.prefix = strdup(name->prefix);
+    plan_chip->name.path = NULL;
+    plan_chip->chip = chip;
+
+    if (plan_chip->name.prefix == NULL)
+    {
+        return NO_MEMORY;
+    }
+
+    return self->chip_count++;
+}
+
+static void
+free_chips(ReadPlan *self)
+{
+    for (int i = 0; i < self->chip_count; i++)
+    {
+        free(self->chips[i].name.prefix);
+    }
+
+    PyMem_Free(self->chips);
+    self->chips = NULL;
+    self->chip_count = 0;
+}
+
+/*
+ * Look the chips up again, because libsensors has been reinitialized
+ * since the last read.
+ */
+static void
+resolve(ReadPlan *self)
+{
+    for (int i = 0; i < self->chip_count; i++)
+    {
+        self->chips[i].chip = resolve_chip(&self->chips[i].name);
+    }
+
+    self->generation = sensors_generation;
+}
+
+/*
+ * Get the fast read entries of the subfeatures, because the ones we
+ * have were freed.
+ */
+static void
+resolve_fast_read(ReadPlan *self)
+{
+    self->fast_epoch = fast_read_epoch;
+
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        PlanEntry *entry = &self->entries[i];
+        const sensors_chip_name *chip = self->chips[entry->chip].chip;
+
+        entry->fast = chip == NULL ?
+            NULL : fast_read_lookup(chip, entry->number);
+    }
+}
+
+/*
+ * Copy the chips and the fast read entries to the requests, after they
+ * have been looked up again.
+ */
+static void
+update_requests(ReadPlan *self)
+{
+    self->requests_fast = fast_read_enabled;
+
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        FastReadRequest *request = &self->requests[i];
+        const PlanEntry *entry = &self->entries[request->index];
+
+        request->chip = self->chips[entry->chip].chip;
+        request->entry = fast_read_enabled ? entry->fast : NULL;
+    }
+}
+
+/*
+ * Create the requests, sorted by bus, keeping the order of the entries
+ * that are on the same bus. Return -1 if memory couldn't be allocated.
+ */
+static int
+compute_groups(ReadPlan *self)
+{
+    int *chip_groups = PyMem_Malloc((self->chip_count + 1) * sizeof(int));
+    const sensors_chip_name **names = PyMem_Malloc(
+        (self->chip_count + 1) * sizeof *names);
+
+    PyMem_Free(self->group_starts);
+    PyMem_Free(self->requests);
+    self->group_starts = PyMem_Malloc((self->chip_count + 1) * sizeof(int));
+    self->requests = PyMem_Malloc((self->size + 1) * sizeof(FastReadRequest));
+
+    if (chip_groups == NULL || names == NULL || self->group_starts == NULL ||
+        self->requests == NULL)
+    {
+        PyMem_Free(chip_groups);
+        PyMem_Free(names);
+        PyMem_Free(self->group_starts);
+        PyMem_Free(self->requests);
+        self->group_starts = NULL;
+        self->requests = NULL;
+        return -1;
+    }
+
+    for (int i = 0; i < self->chip_count; i++)
+    {
+        names[i] = &self->chips[i].name;
+    }
+
+    self->group_count = group_by_bus(names, self->chip_count, chip_groups);
+    PyMem_Free(names);
+
+    /* Counting sort of the entries by group */
+    memset(self->group_starts, 0, (self->group_count + 1) * sizeof(int));
+
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        self->group_starts[chip_groups[self->entries[i].chip] + 1]++;
+    }
+
+    for (int g = 0; g < self->group_count; g++)
+    {
+        self->group_starts[g + 1] += self->group_starts[g];
+    }
+
+    /* Use group_starts as the insertion point of each group */
+    for (Py_ssize_t i = 0; i < self->size; i++)
+    {
+        int *next = &self->group_starts[chip_groups[self->entries[i].chip]];
+        FastReadRequest *request = &self->requests[(*next)++];
+
+        request->number = self->entries[i].number;
+        request->index = i;
+    }
+
+    /* The insertion points are now the ends of the groups; shift them
+     * back */
+    for (int g = self->group_count; g > 0; g--)
+    {
+        self->group_starts[g] = self->group_starts[g - 1];
+    }
+
+    self->group_starts[0] = 0;
+    PyMem_Free(chip_groups);
+    update_requests(self);
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_READ_PLAN
+#define H_READ_PLAN
+
+#include <Python.h>
+
+#include <pthread.h>
+
+#include <sensors/sensors.h>
+
+#include "chipname.h"
+#include "fastread.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject ReadPlanType;
+
+
+typedef struct
+{
+    /* Our own copy of the name, used to resolve it again after
+     * libsensors is reinitialized */
+    sensors_chip_name name;
+    /* The detected chip, as stored by libsensors, or NULL if it
+     * disappeared */
+    const sensors_chip_name *chip;
+} PlanChip;
+
+typedef struct
+{
+    int chip;                   /* Index in chips */
+    int number;                 /* Subfeature number */
+    FastReadEntry *fast;        /* Only valid for fast_epoch */
+} PlanEntry;
+
+typedef struct
+{
+    PyObject_HEAD
+    Py_ssize_t size;
+    PlanEntry *entries;
+    int chip_count;
+    PlanChip *chips;
+    /* Protects generation, fast_epoch and what depends on them */
+    pthread_mutex_t lock;
+    unsigned long generation;
+    unsigned long fast_epoch;
+    /* The entries sorted by bus: the requests of group g are
+     * requests[group_starts[g]] to requests[group_starts[g + 1] - 1].
+     * When parallel is set, the groups are read at the same time. */
+    int parallel;
+    int group_count;
+    int *group_starts;
+    FastReadRequest *requests;
+    int requests_fast;          /* Whether requests use the entries */
+} ReadPlan;
+
+void read_plan_read(ReadPlan*, double*, int*);
+int read_plan_parse_pair(PyObject*, ChipName**, int*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,566 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "sensorsmodule.h"
+#include "readings.h"
+#include "rollup.h"
+#include "utils.h"
+
+#define DEFAULT_CAPACITY 4096
+/* starts[w] before the first sample */
+#define NO_WINDOW INT64_MIN
+
+
+static PyObject* new(PyTypeObject*, PyObject*, PyObject*);
+static int init(Rollup*, PyObject*, PyObject*);
+static void dealloc(Rollup*);
+static PyObject* repr(Rollup*);
+static PyObject* record(Rollup*, PyObject*, PyObject*);
+static PyObject* drain(Rollup*, PyObject*);
+static PyObject* current(Rollup*, PyObject*);
+static PyObject* get_dropped(Rollup*, void*);
+static PyObject* windows_to_list(Rollup*, const RollupWindow*, Py_ssize_t);
+static void close_windows(Rollup*, int);
+
+
+static PyMethodDef methods[] = {
+    {"record", (PyCFunction)record, METH_VARARGS | METH_KEYWORDS,
+     "Add the values of a Readings object, which must have one column"
+     " per column of the rollup. The values that couldn't be read are"
+     " skipped. The time of each row is time if given, its timestamp if"
+     " the readings have some, or now."},
+    {"drain", (PyCFunction)drain, METH_NOARGS,
+     "Remove the windows that are over, and return them as a list of"
+     " (size, start, column, count, min, max, mean) tuples, oldest"
+     " first."},
+    {"current", (PyCFunction)current, METH_NOARGS,
+     "Return the windows that are still open, in the same format as"
+     " drain(). Windows without samples are left out."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef members[] =
+{
+    {"columns", T_PYSSIZET, offsetof(Rollup, columns), READONLY,
+     "Number of columns."},
+    {"windows", T_OBJECT, offsetof(Rollup, window_sizes), READONLY,
+     "Tuple of the window sizes, in seconds."},
+    {"capacity", T_PYSSIZET, offsetof(Rollup, capacity), READONLY,
+     "Number of windows that are over that can be kept until drained."},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyGetSetDef getsetters[] = {
+    {"dropped", (getter)get_dropped, NULL,
+     "Number of windows that were lost because they weren't drained in"
+     " time.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+PyTypeObject RollupType =
+{
+    INIT_TYPE_HEAD
+    "sensors.Rollup",          /*tp_name*/
+    sizeof(Rollup),            /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    0,                         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "Rollup(columns, windows=(1.0, 60.0, 3600.0), capacity=4096)\n\n"
+    "Running min/max/mean/count aggregates of columns series, over"
+    " windows of the given sizes in seconds.", /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    members,                   /* tp_members */
+    getsetters,                /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    (initproc)init,            /* tp_init */
+    0,                         /* tp_alloc */
+    new,                       /* tp_new */
+};
+
+
+static PyObject*
+new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    Rollup *self = (Rollup*)PyType_GenericNew(type, args, kwargs);
+
+    if (self != NULL)
+    {
+        pthread_mutex_init(&self->lock, NULL);
+    }
+
+    return (PyObject*)self;
+}
+
+static int
+init(Rollup *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"columns", "windows", "capacity", NULL};
+    Py_ssize_t columns = 0;
+    PyObject *windows = NULL;
+    Py_ssize_t capacity = DEFAULT_CAPACITY;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|On", kwlist,
+                                     &columns, &windows, &capacity))
+    {
+        return -1;
+    }
+
+    if (columns < 0 || capacity <= 0)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "columns can't be negative and capacity must be"
+                        " positive");
+        return -1;
+    }
+
+    PyObject *sizes = windows == NULL ?
+        Py_BuildValue("(ddd)", 1.0, 60.0, 3600.0) :
+        PySequence_Tuple(windows);
+
+    if (sizes == NULL)
+    {
+        return -1;
+    }
+
+    Py_ssize_t window_count = PyTuple_GET_SIZE(sizes);
+
+    if (window_count == 0 || window_count > INT_MAX)
+    {
+        PyErr_SetString(PyExc_ValueError, "windows can't be empty");
+        Py_DECREF(sizes);
+        return -1;
+    }
+
+    if ((size_t)capacity > PY_SSIZE_T_MAX / 2 / sizeof(RollupWindow) ||
+        (size_t)columns > PY_SSIZE_T_MAX / 2 / sizeof(RollupAggregate) /
+        window_count)
+    {
+        Py_DECREF(sizes);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    size_t size = window_count * 2 * sizeof(int64_t) +
+        window_count * columns * sizeof(RollupAggregate) +
+        capacity * sizeof(RollupWindow);
+    /* sizes, starts, current and closed share the same block */
+    char *block = PyMem_Malloc(size);
+
+    if (block == NULL)
+    {
+        Py_DECREF(sizes);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    int64_t *ns = (int64_t*)block;
+
+    for (Py_ssize_t w = 0; w < window_count; w++)
+    {
+        double seconds = PyFloat_AsDouble(PyTuple_GET_ITEM(sizes, w));
+
+        if (seconds == -1.0 && PyErr_Occurred())
+        {
+            goto error;
+        }
+
+        if (!(seconds > 0.0) || !isfinite(seconds) || seconds * 1e9 < 1.0)
+        {
+            PyErr_SetString(PyExc_ValueError,
+                            "window sizes must be positive");
+            goto error;
+        }
+
+        ns[w] = (int64_t)(seconds * 1e9);
+    }
+
+    pthread_mutex_lock(&self->lock);
+    PyMem_Free(self->sizes);
+    Py_XDECREF(self->window_sizes);
+    self->window_sizes = sizes;
+    self->columns = columns;
+    self->window_count = (int)window_count;
+    self->sizes = ns;
+    self->starts = self->sizes + window_count;
+    self->current = (RollupAggregate*)(self->starts + window_count);
+    self->closed = (RollupWindow*)(self->current + window_count * columns);
+    self->capacity = capacity;
+    self->closed_start = 0;
+    self->closed_count = 0;
+    self->dropped = 0;
+
+    for (Py_ssize_t w = 0; w < window_count; w++)
+    {
+        self->starts[w] = NO_WINDOW;
+    }
+
+    memset(self->current, 0,
+           window_count * columns * sizeof(RollupAggregate));
+    pthread_mutex_unlock(&self->lock);
+
+    return 0;
+
+error:
+    PyMem_Free(block);
+    Py_DECREF(sizes);
+    return -1;
+}
+
+static void
+dealloc(Rollup *self)
+{
+    pthread_mutex_destroy(&self->lock);
+    PyMem_Free(self->sizes);
+    self->sizes = NULL;
+    Py_XDECREF(self->window_sizes);
+    FREE_OBJECT(self);
+}
+
+static PyObject*
+repr(Rollup *self)
+{
+    return PyString_FromFormat("Rollup(columns=%zd, windows=%d)",
+                               self->columns, self->window_count);
+}
+
+/**
+ * Add a sample of every column, read at time (CLOCK_MONOTONIC, in
+ * nanoseconds). statuses[i] is non-zero when values[i] couldn't be
+ * read. Nothing is done if columns isn't the number of columns of the
+ * rollup, which can change if it is reinitialized. The GIL isn't
+ * needed.
+ */
+void rollup_add(Rollup *self, int64_t time, const double *values,
+                const int *statuses, Py_ssize_t columns)
+{
+    pthread_mutex_lock(&self->lock);
+
+    if (columns != self->columns)
+    {
+        pthread_mutex_unlock(&self->lock);
+        return;
+    }
+
+    for (int w = 0; w < self->window_count; w++)
+    {
+        int64_t offset = time % self->sizes[w];
+        int64_t start = time - (offset < 0 ? offset + self->sizes[w] : offset);
+
+        if (self->starts[w] == NO_WINDOW)
+        {
+            self->starts[w] = start;
+        }
+        else if (start > self->starts[w])
+        {
+            close_windows(self, w);
+            self->starts[w] = start;
+        }
+        else if (start < self->starts[w])
+        {
+            /* That window is over */
+            continue;
+        }
+
+        RollupAggregate *aggregates = self->current + w * self->columns;
+
+        for (Py_ssize_t c = 0; c < self->columns; c++)
+        {
+            RollupAggregate *aggregate = &aggregates[c];
+            double value = values[c];
+
+            if (statuses[c] != 0)
+            {
+                continue;
+            }
+
+            if (aggregate->count == 0 || value < aggregate->min)
+            {
+                aggregate->min = value;
+            }
+
+            if (aggregate->count == 0 || value > aggregate->max)
+            {
+                aggregate->max = value;
+            }
+
+            aggregate->sum += value;
+            aggregate->count++;
+        }
+    }
+
+    pthread_mutex_unlock(&self->lock);
+}
+
+static PyObject*
+record(Rollup *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"readings", "time", NULL};
+    Readings *readings = NULL;
+    PyObject *py_time = Py_None;
+    int64_t time = 0;
+    int64_t offset = 0;
+    int use_timestamps = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|O", kwlist,
+                                     &ReadingsType, &readings, &py_time))
+    {
+        return NULL;
+    }
+
+    if (readings->columns != self->columns)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "the readings don't have the same number of"
+                        " columns as the rollup");
+        return NULL;
+    }
+
+    if (parse_monotonic_time(py_time, &time) < 0)
+    {
+        return NULL;
+    }
+
+    if (py_time == Py_None && readings->timestamps != NULL)
+    {
+        use_timestamps = 1;
+
+        /* Converted as in History.record() */
+        if (!readings->monotonic)
+        {
+            offset = clock_ns(CLOCK_MONOTONIC) - clock_ns(CLOCK_REALTIME);
+        }
+    }
+
+    for (Py_ssize_t row = 0; row < readings->rows; row++)
+    {
+        int64_t row_time = time;
+
+        if (use_timestamps)
+        {
+            row_time = (int64_t)(readings->timestamps[row] * 1e9 + 0.5) +
+                offset;
+        }
+
+        rollup_add(self, row_time, readings->values + row * self->columns,
+                   readings->statuses + row * self->columns,
+                   readings->columns);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+drain(Rollup *self, PyObject *unused)
+{
+    (void)unused;
+
+    /* Copy the windows first, so that the lock isn't held while Python
+     * objects are created */
+    pthread_mutex_lock(&self->lock);
+
+    Py_ssize_t count = self->closed_count;
+    RollupWindow *windows = PyMem_Malloc((count + 1) * sizeof *windows);
+
+    if (windows == NULL)
+    {
+        pthread_mutex_unlock(&self->lock);
+        return PyErr_NoMemory();
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        windows[i] = self->closed[(self->closed_start + i) % self->capacity];
+    }
+
+    self->closed_start = 0;
+    self->closed_count = 0;
+    pthread_mutex_unlock(&self->lock);
+
+    PyObject *list = windows_to_list(self, windows, count);
+    PyMem_Free(windows);
+
+    return list;
+}
+
+static PyObject*
+current(Rollup *self, PyObject *unused)
+{
+    (void)unused;
+
+    pthread_mutex_lock(&self->lock);
+
+    Py_ssize_t count = 0;
+    RollupWindow *windows = PyMem_Malloc(
+        (self->window_count * self->columns + 1) * sizeof *windows);
+
+    if (windows == NULL)
+    {
+        pthread_mutex_unlock(&self->lock);
+        return PyErr_NoMemory();
+    }
+
+    for (int w = 0; w < self->window_count; w++)
+    {
+        for (Py_ssize_t c = 0; c < self->columns; c++)
+        {
+            RollupAggregate *aggregate = &self->current[w * self->columns + c];
+
+            if (aggregate->count > 0)
+            {
+                windows[count].start = self->starts[w];
+                windows[count].window = w;
+                windows[count].column = (int)c;
+                windows[count].aggregate = *aggregate;
+                count++;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&self->lock);
+
+    PyObject *list = windows_to_list(self, windows, count);
+    PyMem_Free(windows);
+
+    return list;
+}
+
+static PyObject*
+get_dropped(Rollup *self, void *closure)
+{
+    (void)closure;
+
+    pthread_mutex_lock(&self->lock);
+    unsigned long dropped = self->dropped;
+    pthread_mutex_unlock(&self->lock);
+
+    return PyLong_FromUnsignedLong(dropped);
+}
+
+static PyObject*
+windows_to_list(Rollup *self, const RollupWindow *windows, Py_ssize_t count)
+{
+    PyObject *list = PyList_New(count);
+
+    if (list == NULL)
+    {
+        return NULL;
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        const RollupWindow *window = &windows[i];
+        const RollupAggregate *aggregate = &window->aggregate;
+        PyObject *item = Py_BuildValue(
+            "(OLiLddd)",
+            PyTuple_GET_ITEM(self->window_sizes, window->window),
+            (long long)window->start, window->column,
+            (long long)aggregate->count, aggregate->min, aggregate->max,
+            aggregate->sum / aggregate->count);
+
+        if (item == NULL)
+        {
+            Py_DECREF(list);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(list, i, item);
+    }
+
+    return list;
+}
+
+/*
+ * Move the current windows of size w to the ring of windows that are
+ * over, and reset them. The oldest windows are overwritten if the
+ * ring is full.
+ */
+static void
+close_windows(Rollup *self, int w)
+{
+    RollupAggregate *aggregates = self->current + w * self->columns;
+
+    for (Py_ssize_t c = 0; c < self->columns; c++)
+    {
+        RollupWindow *window = NULL;
+
+        if (aggregates[c].count == 0)
+        {
+            continue;
+        }
+
+        if (self->closed_count == self->capacity)
+        {
+            window = &self->closed[self->closed_start];
+            self->closed_start = (self->closed_start + 1) % self->capacity;
+            self->dropped++;
+        }
+        else
+        {
+            window = &self->closed[(self->closed_start + self->closed_count) %
+                                   self->capacity];
+            self->closed_count++;
+        }
+
+        window->start = self->starts[w];
+        window->window = w;
+        window->column = (int)c;
+        window->aggregate = aggregates[c];
+        memset(&aggregates[c], 0, sizeof aggregates[c]);
+    }
+}
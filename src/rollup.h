@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_ROLLUP
+#define H_ROLLUP
+
+#include <Python.h>
+
+#include <pthread.h>
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject RollupType;
+
+
+typedef struct
+{
+    int64_t count;
+    double min;
+    double max;
+    double sum;
+} RollupAggregate;
+
+/* A window that is over */
+typedef struct
+{
+    int64_t start;              /* CLOCK_MONOTONIC, in nanoseconds */
+    int window;                 /* Index in sizes */
+    int column;
+    RollupAggregate aggregate;
+} RollupWindow;
+
+/*
+ * Running min/max/mean/count aggregates of columns series, over
+ * windows of several sizes.  The windows are aligned on multiples of
+ * their size.  Only the current window of each size and column is
+ * kept, plus a ring of the windows that are over until they are
+ * drained, so the memory doesn't depend on the number of samples.
+ * lock protects everything, because a Sampler can feed a Rollup from
+ * its own thread.
+ */
+typedef struct
+{
+    PyObject_HEAD
+    pthread_mutex_t lock;
+    Py_ssize_t columns;
+    int window_count;
+    PyObject *window_sizes;     /* Tuple of the sizes in seconds */
+    int64_t *sizes;             /* In nanoseconds */
+    int64_t *starts;            /* Start of the current windows */
+    RollupAggregate *current;   /* window_count * columns aggregates */
+    RollupWindow *closed;
+    Py_ssize_t capacity;
+    Py_ssize_t closed_start;
+    Py_ssize_t closed_count;
+    unsigned long dropped;
+} Rollup;
+
+void rollup_add(Rollup*, int64_t, const double*, const int*, Py_ssize_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
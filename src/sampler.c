@@ -0,0 +1,635 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sensorsmodule.h"
+#include "readings.h"
+#include "readplan.h"
+#include "rollup.h"
+#include "sampler.h"
+#include "utils.h"
+
+#define DEFAULT_CAPACITY 1024
+
+
+static PyObject* new(PyTypeObject*, PyObject*, PyObject*);
+static int init(Sampler*, PyObject*, PyObject*);
+static void dealloc(Sampler*);
+static PyObject* repr(Sampler*);
+static PyObject* start(Sampler*, PyObject*);
+static PyObject* stop(Sampler*, PyObject*);
+static PyObject* drain(Sampler*, PyObject*, PyObject*);
+static PyObject* fileno_(Sampler*, PyObject*);
+static PyObject* enter(Sampler*, PyObject*);
+static PyObject* exit_(Sampler*, PyObject*);
+static PyObject* get_running(Sampler*, void*);
+static PyObject* get_dropped(Sampler*, void*);
+static int is_running(Sampler*);
+static void join(Sampler*);
+static void* run(void*);
+static void sample(Sampler*);
+static void signal_event(Sampler*);
+
+
+static PyMethodDef methods[] = {
+    {"start", (PyCFunction)start, METH_NOARGS,
+     "Start the sampling thread."},
+    {"stop", (PyCFunction)stop, METH_NOARGS,
+     "Stop the sampling thread, and wait until it has stopped. The"
+     " samples that haven't been drained are kept."},
+    {"drain", (PyCFunction)drain, METH_VARARGS | METH_KEYWORDS,
+     "Remove the samples from the buffer, oldest first, and return them"
+     " as a Readings object with one row per sample. At most max_rows"
+     " samples are returned if it is given."},
+    {"fileno", (PyCFunction)fileno_, METH_NOARGS,
+     "Return a file descriptor that is readable when samples can be"
+     " drained, for use with select() or an event loop."},
+    {"__enter__", (PyCFunction)enter, METH_NOARGS,
+     "Start the sampling thread, and return the sampler."},
+    {"__exit__", (PyCFunction)exit_, METH_VARARGS,
+     "Stop the sampling thread."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef members[] =
+{
+    {"plan", T_OBJECT, offsetof(Sampler, plan), READONLY,
+     "The ReadPlan that is sampled."},
+    {"rollup", T_OBJECT, offsetof(Sampler, rollup), READONLY,
+     "The Rollup that is fed every sample, or None."},
+    {"interval", T_DOUBLE, offsetof(Sampler, interval), READONLY,
+     "Time between two samples, in seconds."},
+    {"capacity", T_PYSSIZET, offsetof(Sampler, capacity), READONLY,
+     "Number of samples the buffer can hold."},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyGetSetDef getsetters[] = {
+    {"running", (getter)get_running, NULL,
+     "Whether the sampling thread is running.", NULL},
+    {"dropped", (getter)get_dropped, NULL,
+     "Number of samples that were skipped because the buffer was full.",
+     NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+PyTypeObject SamplerType =
+{
+    INIT_TYPE_HEAD
+    "sensors.Sampler",         /*tp_name*/
+    sizeof(Sampler),           /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    0,                         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "Sampler(plan, interval, capacity=1024, rollup=None)\n\n"
+    "Read a ReadPlan every interval seconds from a native thread, which"
+    " doesn't need the GIL, and keep the last samples in a buffer of"
+    " capacity rows until they are drained. Every sample is also added"
+    " to rollup if it is given, even when the buffer is full.", /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    members,                   /* tp_members */
+    getsetters,                /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    (initproc)init,            /* tp_init */
+    0,                         /* tp_alloc */
+    new,                       /* tp_new */
+};
+
+
+static PyObject*
+new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    Sampler *self = (Sampler*)PyType_GenericNew(type, args, kwargs);
+    pthread_condattr_t attr;
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    /* The deadlines are on the monotonic clock, so that they don't
+     * move when the time of day is changed */
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&self->stop_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&self->stop_lock, NULL);
+    self->event_fd = -1;
+
+    return (PyObject*)self;
+}
+
+static int
+init(Sampler *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"plan", "interval", "capacity", "rollup", NULL};
+    ReadPlan *plan = NULL;
+    double interval = 0.0;
+    Py_ssize_t capacity = DEFAULT_CAPACITY;
+    PyObject *rollup = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!d|nO", kwlist,
+                                     &ReadPlanType, &plan, &interval,
+                                     &capacity, &rollup))
+    {
+        return -1;
+    }
+
+    if (rollup == Py_None)
+    {
+        rollup = NULL;
+    }
+    else if (!PyObject_TypeCheck(rollup, &RollupType))
+    {
+        PyErr_SetString(PyExc_TypeError, "rollup must be a Rollup or None");
+        return -1;
+    }
+    else if (((Rollup*)rollup)->columns != plan->size)
+    {
+        PyErr_SetString(PyExc_ValueError,
+                        "the rollup doesn't have the same number of columns"
+                        " as the plan");
+        return -1;
+    }
+
+    if (is_running(self))
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the sampler can't be reinitialized while running");
+        return -1;
+    }
+
+    if (!(interval > 0.0) || !isfinite(interval))
+    {
+        PyErr_SetString(PyExc_ValueError, "interval must be positive");
+        return -1;
+    }
+
+    if (capacity <= 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "capacity must be positive");
+        return -1;
+    }
+
+    if (self->event_fd < 0)
+    {
+        self->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (self->event_fd < 0)
+        {
+            PyErr_SetFromErrno(PyExc_OSError);
+            return -1;
+        }
+    }
+
+    Py_ssize_t columns = plan->size;
+    size_t row_size = sizeof(double) + columns * (sizeof(double) + sizeof(int));
+
+    if ((size_t)capacity >= PY_SSIZE_T_MAX / row_size)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    /* One block for the three arrays, doubles first so that they stay
+     * aligned, plus the spare row */
+    char *block = PyMem_Malloc((capacity + 1) * row_size);
+
+    if (block == NULL)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    PyMem_Free(self->timestamps);
+    Py_INCREF(plan);
+    Py_XDECREF(self->plan);
+    self->plan = plan;
+    Py_XINCREF(rollup);
+    Py_XDECREF(self->rollup);
+    self->rollup = (Rollup*)rollup;
+    self->columns = columns;
+    self->capacity = capacity;
+    self->interval = interval;
+    self->timestamps = (double*)block;
+    self->values = self->timestamps + capacity + 1;
+    self->statuses = (int*)(self->values + (capacity + 1) * columns);
+    self->head = 0;
+    self->tail = 0;
+    self->dropped = 0;
+
+    /* The samples of the previous plan are gone */
+    uint64_t count;
+
+    if (read(self->event_fd, &count, sizeof(count)) < 0)
+    {
+        /* Nothing was pending */
+    }
+
+    return 0;
+}
+
+static void
+dealloc(Sampler *self)
+{
+    if (is_running(self))
+    {
+        join(self);
+    }
+
+    pthread_cond_destroy(&self->stop_cond);
+    pthread_mutex_destroy(&self->stop_lock);
+
+    if (self->event_fd >= 0)
+    {
+        close(self->event_fd);
+    }
+
+    PyMem_Free(self->timestamps);
+    self->timestamps = NULL;
+    Py_XDECREF(self->plan);
+    Py_XDECREF(self->rollup);
+    FREE_OBJECT(self);
+}
+
+static PyObject*
+repr(Sampler *self)
+{
+    /* PyString_FromFormat() doesn't support %f */
+    int milliseconds = (int)(self->interval * 1000.0 + 0.5);
+
+    return PyString_FromFormat(
+        "Sampler(columns=%zd, interval_ms=%d, capacity=%zd, running=%s)",
+        self->columns, milliseconds, self->capacity,
+        is_running(self) ? "True" : "False");
+}
+
+static PyObject*
+start(Sampler *self, PyObject *unused)
+{
+    sigset_t all;
+    sigset_t old;
+    int error = 0;
+
+    (void)unused;
+
+    if (self->plan == NULL)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "the sampler isn't initialized");
+        return NULL;
+    }
+
+    if (is_running(self))
+    {
+        PyErr_SetString(PyExc_RuntimeError, "the sampler is already running");
+        return NULL;
+    }
+
+    self->stopping = 0;
+
+    /* The signals are handled by the Python threads, not this one */
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    error = pthread_create(&self->thread, NULL, run, self);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (error != 0)
+    {
+        errno = error;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    self->thread_pid = getpid();
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+stop(Sampler *self, PyObject *unused)
+{
+    (void)unused;
+
+    if (is_running(self))
+    {
+        join(self);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+drain(Sampler *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"max_rows", NULL};
+    Py_ssize_t max_rows = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", kwlist, &max_rows))
+    {
+        return NULL;
+    }
+
+    /* Reset the event before looking at head: a row published after
+     * this signals it again, so it's never lost */
+    uint64_t count;
+
+    if (read(self->event_fd, &count, sizeof(count)) < 0)
+    {
+        /* Nothing was pending */
+    }
+
+    size_t tail = self->tail;
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    Py_ssize_t rows = (Py_ssize_t)(head - tail);
+
+    if (max_rows >= 0 && rows > max_rows)
+    {
+        rows = max_rows;
+        /* The rows that are left can still be drained */
+        signal_event(self);
+    }
+
+    Readings *readings = readings_new_rows(rows, self->columns);
+
+    if (readings == NULL)
+    {
+        return NULL;
+    }
+
+    for (Py_ssize_t i = 0; i < rows; i++)
+    {
+        size_t slot = (tail + i) % self->capacity;
+
+        readings->timestamps[i] = self->timestamps[slot];
+        memcpy(readings->values + i * self->columns,
+               self->values + slot * self->columns,
+               self->columns * sizeof(double));
+        memcpy(readings->statuses + i * self->columns,
+               self->statuses + slot * self->columns,
+               self->columns * sizeof(int));
+    }
+
+    /* The rows can now be reused by the thread */
+    __atomic_store_n(&self->tail, tail + rows, __ATOMIC_RELEASE);
+
+    return (PyObject*)readings;
+}
+
+static PyObject*
+fileno_(Sampler *self, PyObject *unused)
+{
+    (void)unused;
+
+    if (self->event_fd < 0)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "the sampler isn't initialized");
+        return NULL;
+    }
+
+    return PyLong_FromLong(self->event_fd);
+}
+
+static PyObject*
+enter(Sampler *self, PyObject *unused)
+{
+    PyObject *result = start(self, unused);
+
+    if (result == NULL)
+    {
+        return NULL;
+    }
+
+    Py_DECREF(result);
+    Py_INCREF(self);
+
+    return (PyObject*)self;
+}
+
+static PyObject*
+exit_(Sampler *self, PyObject *args)
+{
+    (void)args;
+
+    return stop(self, NULL);
+}
+
+static PyObject*
+get_running(Sampler *self, void *closure)
+{
+    (void)closure;
+
+    return PyBool_FromLong(is_running(self));
+}
+
+static PyObject*
+get_dropped(Sampler *self, void *closure)
+{
+    (void)closure;
+
+    return PyLong_FromUnsignedLong(
+        __atomic_load_n(&self->dropped, __ATOMIC_RELAXED));
+}
+
+/*
+ * Return 1 if the thread has been started and not stopped. After
+ * fork(), the thread only exists in the parent.
+ */
+static int
+is_running(Sampler *self)
+{
+    return self->thread_pid != 0 && self->thread_pid == getpid();
+}
+
+/*
+ * Tell the thread to stop, and wait for it. The GIL is released, since
+ * the thread may be waiting for sensors_lock, and whoever holds it may
+ * need the GIL.
+ */
+static void
+join(Sampler *self)
+{
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&self->stop_lock);
+    self->stopping = 1;
+    pthread_cond_signal(&self->stop_cond);
+    pthread_mutex_unlock(&self->stop_lock);
+    pthread_join(self->thread, NULL);
+    Py_END_ALLOW_THREADS
+
+    self->thread_pid = 0;
+}
+
+static void*
+run(void *arg)
+{
+    Sampler *self = arg;
+    struct timespec deadline;
+    long long step = (long long)(self->interval * 1e9);
+
+    if (step <= 0)
+    {
+        step = 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    pthread_mutex_lock(&self->stop_lock);
+
+    while (!self->stopping)
+    {
+        struct timespec now;
+
+        pthread_mutex_unlock(&self->stop_lock);
+        sample(self);
+
+        /* The deadlines are fixed, so that the time spent reading
+         * doesn't accumulate; when a read takes longer than the
+         * interval, the samples that are late are skipped. */
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        long long next = deadline.tv_sec * 1000000000LL + deadline.tv_nsec;
+        long long current = now.tv_sec * 1000000000LL + now.tv_nsec;
+
+        next += step;
+
+        if (next <= current)
+        {
+            next += ((current - next) / step + 1) * step;
+        }
+
+        deadline.tv_sec = next / 1000000000LL;
+        deadline.tv_nsec = next % 1000000000LL;
+
+        pthread_mutex_lock(&self->stop_lock);
+
+        while (!self->stopping &&
+               pthread_cond_timedwait(&self->stop_cond, &self->stop_lock,
+                                      &deadline) != ETIMEDOUT)
+        {
+        }
+    }
+
+    pthread_mutex_unlock(&self->stop_lock);
+
+    return NULL;
+}
+
+/*
+ * Read the plan into the next free row, unless the ring is full.
+ */
+static void
+sample(Sampler *self)
+{
+    size_t head = self->head;
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+    int full = head - tail >= (size_t)self->capacity;
+    size_t slot = head % self->capacity;
+
+    if (full)
+    {
+        __atomic_add_fetch(&self->dropped, 1, __ATOMIC_RELAXED);
+
+        if (self->rollup == NULL)
+        {
+            return;
+        }
+
+        slot = self->capacity;
+    }
+
+    double *values = self->values + slot * self->columns;
+    int *statuses = self->statuses + slot * self->columns;
+
+    self->timestamps[slot] = clock_ns(CLOCK_REALTIME) / 1e9;
+    int64_t monotonic = clock_ns(CLOCK_MONOTONIC);
+
+    pthread_rwlock_rdlock(&sensors_lock);
+    read_plan_read(self->plan, values, statuses);
+    pthread_rwlock_unlock(&sensors_lock);
+
+    if (self->rollup != NULL)
+    {
+        rollup_add(self->rollup, monotonic, values, statuses, self->columns);
+    }
+
+    if (!full)
+    {
+        /* Publish the row */
+        __atomic_store_n(&self->head, head + 1, __ATOMIC_RELEASE);
+        signal_event(self);
+    }
+}
+
+/*
+ * Make event_fd readable. This only fails when the counter would
+ * overflow, in which case it's readable anyway.
+ */
+static void
+signal_event(Sampler *self)
+{
+    uint64_t one = 1;
+
+    if (write(self->event_fd, &one, sizeof(one)) < 0)
+    {
+        /* Already readable */
+    }
+}
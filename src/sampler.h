@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_SAMPLER
+#define H_SAMPLER
+
+#include <Python.h>
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "readplan.h"
+#include "rollup.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject SamplerType;
+
+
+/*
+ * Reads a ReadPlan at a fixed interval from a native thread, into a
+ * ring of capacity rows.  The thread is the only producer and drain()
+ * the only consumer (it runs with the GIL), so the ring needs no lock:
+ * the thread publishes a row by incrementing head, and drain() frees
+ * rows by incrementing tail.  Both only increase; the row of index i
+ * is stored at slot i % capacity.  An extra row at the end is used to
+ * feed the rollup, if any, when the ring is full.  The thread signals
+ * event_fd every time it publishes a row, so that an event loop can
+ * wait for the samples instead of polling drain().
+ */
+typedef struct
+{
+    PyObject_HEAD
+    ReadPlan *plan;
+    Rollup *rollup;             /* NULL if there isn't one */
+    Py_ssize_t columns;
+    Py_ssize_t capacity;
+    double interval;            /* Seconds */
+
+    double *timestamps;         /* capacity timestamps */
+    double *values;             /* capacity * columns values */
+    int *statuses;              /* capacity * columns statuses */
+    size_t head;
+    size_t tail;
+    unsigned long dropped;      /* Samples lost because the ring was full */
+    int event_fd;               /* eventfd, -1 until initialized */
+
+    pthread_t thread;
+    pid_t thread_pid;           /* 0 when the thread isn't running */
+    pthread_mutex_t stop_lock;  /* Protects stopping */
+    pthread_cond_t stop_cond;
+    int stopping;
+} Sampler;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
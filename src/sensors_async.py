@@ -0,0 +1,133 @@
+# -*- coding: utf-8 -*-
+
+# Copyright 2026 Bastien Léonard. All rights reserved.
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+
+#    1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+
+#    2. Redistributions in binary form must reproduce the above
+#    copyright notice, this list of conditions and the following
+#    disclaimer in the documentation and/or other materials provided
+#    with the distribution.
+
+# THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+# USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+# OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+
+"""asyncio wrappers for the sensors module.
+
+The reads happen on native threads that signal a file descriptor when
+they are done, and the event loop waits on that descriptor, so no
+executor thread is involved.
+"""
+
+import asyncio
+import weakref
+
+import sensors
+
+
+class _Reader(object):
+    """Dispatch the results of an AsyncReader to the futures of a
+    loop."""
+
+    def __init__(self, loop):
+        self.reader = sensors.AsyncReader()
+        self.futures = {}
+        # The loop keeps the reader alive through the callback, so the
+        # reader mustn't keep the loop alive
+        self.loop = weakref.ref(loop)
+        loop.add_reader(self.reader.fileno(), self.complete)
+
+    def read(self, chip, subfeature):
+        future = self.loop().create_future()
+        self.futures[self.reader.submit(chip, subfeature)] = future
+
+        return future
+
+    def complete(self):
+        for token, value, error in self.reader.results():
+            future = self.futures.pop(token, None)
+
+            if future is None or future.done():
+                continue
+
+            if error is None:
+                future.set_result(value)
+            else:
+                future.set_exception(sensors.SensorsException(error))
+
+
+_readers = weakref.WeakKeyDictionary()
+
+
+def _get_reader(loop):
+    reader = _readers.get(loop)
+
+    if reader is None:
+        reader = _Reader(loop)
+        _readers[loop] = reader
+
+    return reader
+
+
+async def get_value(chip, subfeature):
+    """Read subfeature, a Subfeature or a subfeature number, for
+    chip."""
+    return await _get_reader(asyncio.get_event_loop()).read(chip, subfeature)
+
+
+def _set_ready(future):
+    if not future.done():
+        future.set_result(None)
+
+
+async def _wait_readable(loop, fd):
+    future = loop.create_future()
+    loop.add_reader(fd, _set_ready, future)
+
+    try:
+        await future
+    finally:
+        loop.remove_reader(fd)
+
+
+async def watch(plan, interval, capacity=1024, rollup=None):
+    """Sample plan every interval seconds with a Sampler, and yield the
+    new samples as Readings objects."""
+    loop = asyncio.get_event_loop()
+
+    with sensors.Sampler(plan, interval, capacity, rollup) as sampler:
+        while True:
+            await _wait_readable(loop, sampler.fileno())
+            batch = sampler.drain()
+
+            if batch.rows > 0:
+                yield batch
+
+
+async def alarms(chip, subfeatures=None):
+    """Wait for the alarms of chip with an AlarmWatcher, and yield the
+    lists of (Subfeature, value) tuples that it returns."""
+    loop = asyncio.get_event_loop()
+
+    with sensors.AlarmWatcher(chip, subfeatures) as watcher:
+        while True:
+            await _wait_readable(loop, watcher.fileno())
+            changes = watcher.wait(0)
+
+            if changes:
+                yield changes
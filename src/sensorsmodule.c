@@ -36,6 +36,22 @@
 #include "chipname.h"
 #include "feature.h"
 #include "subfeature.h"
+#include "readings.h"
+#include "snapshot.h"
+#include "readplan.h"
+#include "sampler.h"
+#include "history.h"
+#include "rollup.h"
+#include "monitor.h"
+#include "poller.h"
+#include "alarmwatcher.h"
+#include "asyncreader.h"
+#include "computes.h"
+#include "fastread.h"
+#include "probes.h"
+#include "profile.h"
+#include "stats.h"
+#include "utils.h"
 
 #ifdef IS_PY3K
 #define INIT_ERROR return NULL
@@ -47,6 +63,17 @@ static PyObject * init(PyObject*, PyObject*, PyObject*);
 static PyObject* cleanup(PyObject*, PyObject*);
 static PyObject* get_detected_chips(PyObject*, PyObject*, PyObject*);
 static PyObject* get_adapter_name(PyObject*, PyObject*, PyObject*);
+static PyObject* snapshot(PyObject*, PyObject*, PyObject*);
+static PyObject* read_many(PyObject*, PyObject*, PyObject*);
+static FastReadRequest* snapshot_requests(const int*,
+                                          const sensors_chip_name**, int,
+                                          const Py_ssize_t*, int*, int*,
+                                          int*);
+static PyObject* set_fast_read(PyObject*, PyObject*, PyObject*);
+static PyObject* watch(PyObject*, PyObject*, PyObject*);
+static PyObject* get_stats(PyObject*, PyObject*);
+static PyObject* reset_stats(PyObject*, PyObject*);
+static PyObject* profile(PyObject*, PyObject*, PyObject*);
 static void add_constants(PyObject *module);
 static PyObject* replace_parse_error_handler(PyObject*, PyObject*, PyObject*);
 static void c_parse_error_handler(const char*, const char*, int);
@@ -68,6 +95,8 @@ PyMODINIT_FUNC PyInit_sensors(void);
 
 
 PyObject *SensorsException = NULL;
+pthread_rwlock_t sensors_lock;
+unsigned long sensors_generation = 1;
 static PyObject *py_parse_error_handler = NULL;
 static PyObject *py_fatal_error_handler = NULL;
 
@@ -96,6 +125,45 @@ static PyMethodDef sensors_methods[] =
     {"get_adapter_name", (PyCFunction)get_adapter_name,
      METH_VARARGS | METH_KEYWORDS,
      "Return the name of the bus, or None if it can't be found."},
+    {"snapshot", (PyCFunction)snapshot, METH_VARARGS | METH_KEYWORDS,
+     "Read all the subfeatures of all the detected chips, and return"
+     " them as a Snapshot object. This is much faster than walking"
+     " get_detected_chips(), get_features() and get_all_subfeatures()"
+     " from Python. If parallel is true, the chips that are on"
+     " different buses are read at the same time by native threads."},
+    {"read_many", (PyCFunction)read_many, METH_VARARGS | METH_KEYWORDS,
+     "Read a sequence of (ChipName, Subfeature) tuples, and return the"
+     " values as a Readings object. The sysfs attributes are opened"
+     " once, kept open as in the fast read mode, and read all at once"
+     " with io_uring when it is available, or with pread() otherwise."},
+    {"set_fast_read", (PyCFunction)set_fast_read, METH_VARARGS | METH_KEYWORDS,
+     "Enable or disable the fast read mode, and return whether it was"
+     " enabled. In this mode, the sysfs attributes read by"
+     " ChipName.get_value() and the other read functions are kept open"
+     " and read with pread(), instead of being opened and closed by"
+     " libsensors on every read. It is disabled by default."},
+    {"watch", (PyCFunction)watch, METH_VARARGS | METH_KEYWORDS,
+     "watch(plan, interval, capacity=1024, rollup=None)\n\n"
+     "Return an asynchronous iterator that samples plan every interval"
+     " seconds, and yields the new samples as Readings objects. This is"
+     " sensors_async.watch(); it requires asyncio."},
+    {"stats", get_stats, METH_NOARGS,
+     "Return the counters of the calls to get_value(), set_value(),"
+     " get_detected_chips() and the enumeration functions, as a dict"
+     " of dicts: chip name (None for get_detected_chips()), then"
+     " function name, then calls, total_ns, errors (a dict of counts by"
+     " error message) and histogram (a list of (bound, count) tuples,"
+     " where count calls took less than bound nanoseconds and at least"
+     " half of it)."},
+    {"reset_stats", reset_stats, METH_NOARGS,
+     "Set all the counters returned by stats() to 0."},
+    {"profile", (PyCFunction)profile, METH_VARARGS | METH_KEYWORDS,
+     "Read every readable subfeature of every detected chip over and"
+     " over for duration seconds, at least once, and return a report of"
+     " the read durations as a dict: duration, rounds, reads, then chips,"
+     " adapters and types, which map each chip name, (bus_type, bus_nr)"
+     " and subfeature type to the subfeatures, reads, errors, mean_ns,"
+     " p99_ns, max_ns and round_ns of its reads."},
     {"replace_parse_error_handler", (PyCFunction)replace_parse_error_handler,
      METH_VARARGS | METH_KEYWORDS,
      "handler will be called when a parse error occurs. It will be"
@@ -133,13 +201,30 @@ PyInit_sensors(void)
 {
     PyObject *module = NULL;
 
+#ifndef IS_PY3K
+    PyEval_InitThreads();
+#endif
+
     ChipNameType.tp_new = PyType_GenericNew;
     FeatureType.tp_new = PyType_GenericNew;
     SubfeatureType.tp_new = PyType_GenericNew;
+    HistoryType.tp_new = PyType_GenericNew;
+    MonitorType.tp_new = PyType_GenericNew;
 
     if (PyType_Ready(&ChipNameType) < 0 ||
         PyType_Ready(&FeatureType) < 0 ||
-        PyType_Ready(&SubfeatureType))
+        PyType_Ready(&SubfeatureType) < 0 ||
+        PyType_Ready(&ReadingsType) < 0 ||
+        PyType_Ready(&ReadingsArrayType) < 0 ||
+        PyType_Ready(&SnapshotType) < 0 ||
+        PyType_Ready(&ReadPlanType) < 0 ||
+        PyType_Ready(&SamplerType) < 0 ||
+        PyType_Ready(&HistoryType) < 0 ||
+        PyType_Ready(&RollupType) < 0 ||
+        PyType_Ready(&MonitorType) < 0 ||
+        PyType_Ready(&PollerType) < 0 ||
+        PyType_Ready(&AlarmWatcherType) < 0 ||
+        PyType_Ready(&AsyncReaderType) < 0)
     {
         PyErr_SetString(PyExc_ImportError, "One or more PyType_Ready() failed");
         INIT_ERROR;
@@ -173,7 +258,58 @@ PyInit_sensors(void)
         Py_INCREF(&FeatureType);
         PyModule_AddObject(module, "Subfeature", (PyObject*)&SubfeatureType);
 
+        Py_INCREF(&ReadingsType);
+        PyModule_AddObject(module, "Readings", (PyObject*)&ReadingsType);
+
+        Py_INCREF(&SnapshotType);
+        PyModule_AddObject(module, "Snapshot", (PyObject*)&SnapshotType);
+
+        Py_INCREF(&ReadPlanType);
+        PyModule_AddObject(module, "ReadPlan", (PyObject*)&ReadPlanType);
+
+        Py_INCREF(&SamplerType);
+        PyModule_AddObject(module, "Sampler", (PyObject*)&SamplerType);
+
+        Py_INCREF(&HistoryType);
+        PyModule_AddObject(module, "History", (PyObject*)&HistoryType);
+
+        Py_INCREF(&RollupType);
+        PyModule_AddObject(module, "Rollup", (PyObject*)&RollupType);
+
+        Py_INCREF(&MonitorType);
+        PyModule_AddObject(module, "Monitor", (PyObject*)&MonitorType);
+
+        Py_INCREF(&PollerType);
+        PyModule_AddObject(module, "Poller", (PyObject*)&PollerType);
+
+        Py_INCREF(&AlarmWatcherType);
+        PyModule_AddObject(module, "AlarmWatcher",
+                           (PyObject*)&AlarmWatcherType);
+
+        Py_INCREF(&AsyncReaderType);
+        PyModule_AddObject(module, "AsyncReader",
+                           (PyObject*)&AsyncReaderType);
+
+        pthread_rwlockattr_t lock_attr;
+        pthread_rwlockattr_init(&lock_attr);
+        /* Otherwise init() could wait forever while other threads
+         * keep reading */
+        pthread_rwlockattr_setkind_np(
+            &lock_attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+
+        if (pthread_rwlock_init(&sensors_lock, &lock_attr) != 0)
+        {
+            pthread_rwlockattr_destroy(&lock_attr);
+            PyErr_SetString(PyExc_ImportError, "Couldn't create a lock");
+            INIT_ERROR;
+        }
+
+        pthread_rwlockattr_destroy(&lock_attr);
+
+        PROBE1(init__entry, (const char*)NULL);
         int status = sensors_init(NULL);
+        computes_load_default();
+        PROBE1(init__return, status);
 
         /* TODO: document that the error can be thrown when importing
          * the module */
@@ -367,6 +503,10 @@ static void add_constants(PyObject *module)
                             SENSORS_SUBFEATURE_BEEP_ENABLE);
     PyModule_AddIntConstant(module, "SUBFEATURE_UNKNOWN",
                             SENSORS_SUBFEATURE_UNKNOWN);
+    PyModule_AddIntConstant(module, "STATE_OK", MONITOR_OK);
+    PyModule_AddIntConstant(module, "STATE_WARN", MONITOR_WARN);
+    PyModule_AddIntConstant(module, "STATE_CRIT", MONITOR_CRIT);
+    PyModule_AddIntConstant(module, "STATE_EMERGENCY", MONITOR_EMERGENCY);
 }
 
 static PyObject*
@@ -390,9 +530,19 @@ init(PyObject *self, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
+    int status = 0;
+
+    /* The parse error handler acquires the GIL itself */
+    BEGIN_SENSORS_WRITE
+    PROBE1(init__entry, filename);
+    fast_read_clear();
     sensors_cleanup();
-    int status = sensors_init(file);
+    status = sensors_init(file);
+    computes_load(file);
     fclose(file);
+    sensors_generation++;
+    PROBE1(init__return, status);
+    END_SENSORS_WRITE
 
     if (status != 0)
     {
@@ -409,7 +559,14 @@ cleanup(PyObject *self, PyObject *args)
     (void)self;
     (void)args;
 
+    BEGIN_SENSORS_WRITE
+    PROBE(cleanup__entry);
+    fast_read_clear();
     sensors_cleanup();
+    computes_clear();
+    sensors_generation++;
+    PROBE(cleanup__return);
+    END_SENSORS_WRITE
 
     Py_RETURN_NONE;
 }
@@ -419,8 +576,11 @@ get_detected_chips(PyObject *self, PyObject *args, PyObject *kwargs)
 {
     char *kwlist[] = {"match", NULL};
     ChipName *match = NULL;
-    PyObject *list = PyList_New(0);
+    PyObject *list = NULL;
     const sensors_chip_name *name = NULL;
+    sensors_chip_name *names = NULL;
+    int count = 0;
+    int capacity = 0;
     int n = 0;
 
     (void)self;
@@ -428,75 +588,680 @@ get_detected_chips(PyObject *self, PyObject *args, PyObject *kwargs)
     if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O!", kwlist,
                                      &ChipNameType, &match))
     {
-        goto error;
+        return NULL;
     }
 
-    while (1)
+    /* The chips are scanned by sensors_init(), so this doesn't do any
+     * I/O; we only have to keep other threads out of libsensors.  The
+     * names are copied while the lock is held, and the ChipName
+     * objects are created once it's released, since creating them may
+     * run a garbage collection. */
+    LOCK_SENSORS();
+    int64_t start = stats_start(STATS_GET_DETECTED_CHIPS);
+    PROBE(get_detected_chips__entry);
+
+    while ((name = sensors_get_detected_chips(
+                match == NULL ? NULL : &match->chip_name, &n)) != NULL)
     {
-        name = sensors_get_detected_chips(
-            match == NULL ? NULL : &match->chip_name,
-            &n);
+        if (count == capacity)
+        {
+            int new_capacity = capacity == 0 ? 16 : capacity * 2;
+            sensors_chip_name *new_names = PyMem_Realloc(
+                names, new_capacity * sizeof *names);
 
-        if (name == NULL)
+            if (new_names == NULL)
+            {
+                break;
+            }
+
+            names = new_names;
+            capacity = new_capacity;
+        }
+
+        if (copy_chip_name(name, &names[count]) < 0)
         {
             break;
         }
+
+        count++;
+    }
+
+    int failed = name != NULL;
+
+    stats_record(NULL, STATS_GET_DETECTED_CHIPS, stats_stop(start),
+                 failed ? STATS_FAILED : 0);
+    PROBE1(get_detected_chips__return, failed ? -1 : count);
+    UNLOCK_SENSORS();
+
+    if (failed)
+    {
+        PyErr_NoMemory();
+    }
+    else
+    {
+        list = PyList_New(count);
+    }
+
+    for (int i = 0; i < count && list != NULL; i++)
+    {
+        PyObject *py_name = (PyObject*)chip_name_new(&names[i]);
+
+        if (py_name == NULL)
+        {
+            Py_CLEAR(list);
+            break;
+        }
+
+        PyList_SET_ITEM(list, i, py_name);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        free_chip_name(&names[i]);
+    }
+
+    PyMem_Free(names);
+
+    return list;
+}
+
+static PyObject*
+get_adapter_name(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"bus_type", "bus_nr", NULL};
+    const sensors_bus_id bus = {-1, -1};
+
+    (void)self;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "hh", kwlist,
+                                      &bus.type, &bus.nr))
+    {
+        return NULL;
+    }
+
+    LOCK_SENSORS();
+    const char *adapter_name = sensors_get_adapter_name(&bus);
+    /* Copied, since the string is created once the lock is released */
+    char *copy = adapter_name == NULL ? NULL : strdup(adapter_name);
+    UNLOCK_SENSORS();
+
+    if (adapter_name == NULL)
+    {
+        Py_RETURN_NONE;
+    }
+
+    if (copy == NULL)
+    {
+        return PyErr_NoMemory();
+    }
+
+    PyObject *py_adapter_name = PyString_FromString(copy);
+    free(copy);
+
+    return py_adapter_name;
+}
+
+static PyObject*
+snapshot(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"parallel", NULL};
+    PyObject *py_parallel = Py_False;
+    const sensors_chip_name *chip = NULL;
+    const sensors_feature *feature = NULL;
+    const sensors_subfeature *subfeature = NULL;
+    int chip_nr = 0;
+    int chip_count = 0;
+    int feature_count = 0;
+    Py_ssize_t size = 0;
+    Snapshot *snap = NULL;
+    PyObject *feature_names = NULL;
+    PyObject *feature_indices = NULL;
+    /* The numbers, types, chips and features of the subfeatures, as in
+     * Snapshot, except that the features are numbered per chip */
+    int *block = NULL;
+    double *values = NULL;
+    int *statuses = NULL;
+    char **chip_texts = NULL;
+    char **feature_texts = NULL;
+    const sensors_chip_name **chips = NULL;
+    Py_ssize_t *chip_starts = NULL;
+    int *chip_groups = NULL;
+    int *group_starts = NULL;
+    FastReadRequest *requests = NULL;
+    int locked = 0;
+
+    (void)self;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist,
+                                     &py_parallel))
+    {
+        return NULL;
+    }
+
+    int parallel = PyObject_IsTrue(py_parallel);
+
+    if (parallel < 0)
+    {
+        return NULL;
+    }
+
+    /* No Python object is created while the lock is held, since that
+     * may run a garbage collection: the names are copied, and the
+     * objects are built once the lock is released. */
+    LOCK_SENSORS();
+    locked = 1;
+
+    /* Count the subfeatures first, so that the arrays are allocated
+     * only once. */
+    while ((chip = sensors_get_detected_chips(NULL, &chip_nr)) != NULL)
+    {
+        int feature_nr = 0;
+
+        chip_count++;
+
+        while ((feature = sensors_get_features(chip, &feature_nr)) != NULL)
+        {
+            int subfeature_nr = 0;
+
+            feature_count++;
+
+            while (sensors_get_all_subfeatures(chip, feature,
+                                               &subfeature_nr) != NULL)
+            {
+                size++;
+            }
+        }
+    }
+
+    block = PyMem_Malloc((4 * size + 1) * sizeof *block);
+    values = PyMem_Malloc((size + 1) * sizeof *values);
+    statuses = PyMem_Malloc((size + 1) * sizeof *statuses);
+    chip_texts = PyMem_Malloc((chip_count + 1) * sizeof *chip_texts);
+    feature_texts = PyMem_Malloc((feature_count + 1) * sizeof *feature_texts);
+    chips = PyMem_Malloc((chip_count + 1) * sizeof *chips);
+    chip_starts = PyMem_Malloc((chip_count + 1) * sizeof *chip_starts);
+    chip_groups = PyMem_Malloc((chip_count + 1) * sizeof *chip_groups);
+    group_starts = PyMem_Malloc((chip_count + 1) * sizeof *group_starts);
+
+    if (block == NULL || values == NULL || statuses == NULL ||
+        chip_texts == NULL || feature_texts == NULL || chips == NULL ||
+        chip_starts == NULL || chip_groups == NULL || group_starts == NULL)
+    {
+        /* Nothing to free in the texts */
+        chip_count = 0;
+        feature_count = 0;
+        goto error;
+    }
+
+    memset(chip_texts, 0, (chip_count + 1) * sizeof *chip_texts);
+    memset(feature_texts, 0, (feature_count + 1) * sizeof *feature_texts);
+
+    int *numbers = block;
+    int *types = block + size;
+    int *chip_indices = block + 2 * size;
+    int *features = block + 3 * size;
+    Py_ssize_t i = 0;
+    int chip_index = 0;
+    int feature_index = 0;
+    chip_nr = 0;
+
+    while ((chip = sensors_get_detected_chips(NULL, &chip_nr)) != NULL &&
+           chip_index < chip_count)
+    {
+        char buffer[512];
+        int feature_nr = 0;
+
+        if (sensors_snprintf_chip_name(buffer, sizeof buffer, chip) < 0)
+        {
+            chip_texts[chip_index] = strdup(chip->prefix);
+        }
         else
         {
-            PyObject *chip_name_args = Py_BuildValue(
-                "shhis", name->prefix, name->bus.type, name->bus.nr, name->addr,
-                name->path);
+            chip_texts[chip_index] = strdup(buffer);
+        }
+
+        if (chip_texts[chip_index] == NULL)
+        {
+            goto error;
+        }
+
+        chips[chip_index] = chip;
+        chip_starts[chip_index] = i;
+
+        while ((feature = sensors_get_features(chip, &feature_nr)) != NULL &&
+               feature_index < feature_count)
+        {
+            int subfeature_nr = 0;
 
-            if (chip_name_args == NULL)
+            feature_texts[feature_index] = strdup(feature->name);
+
+            if (feature_texts[feature_index] == NULL)
             {
                 goto error;
             }
 
-            PyObject *py_name = PyObject_CallObject((PyObject*)&ChipNameType,
-                                                    chip_name_args);
-            Py_DECREF(chip_name_args);
+            while ((subfeature = sensors_get_all_subfeatures(
+                        chip, feature, &subfeature_nr)) != NULL &&
+                   i < size)
+            {
+                numbers[i] = subfeature->number;
+                types[i] = subfeature->type;
+                chip_indices[i] = chip_index;
+                features[i] = feature_index;
+                i++;
+            }
+
+            feature_index++;
+        }
+
+        chip_index++;
+    }
+
+    chip_starts[chip_index] = i;
+
+    int group_count = 0;
+
+    requests = snapshot_requests(numbers, chips, chip_index, chip_starts,
+                                 chip_groups, group_starts, &group_count);
+
+    if (requests == NULL)
+    {
+        goto error;
+    }
+
+    /* The values are read without the GIL.  We keep the lock, so that
+     * the chips stay valid. */
+    Py_BEGIN_ALLOW_THREADS
+    if (fast_read_enabled)
+    {
+        for (i = 0; i < size; i++)
+        {
+            requests[i].entry = fast_read_lookup(requests[i].chip,
+                                                 requests[i].number);
+        }
+    }
+
+    fast_read_grouped(requests, group_starts, group_count, parallel,
+                      values, statuses);
+    Py_END_ALLOW_THREADS
+
+    UNLOCK_SENSORS();
+    locked = 0;
+
+    snap = snapshot_new(size);
+
+    if (snap == NULL)
+    {
+        goto error;
+    }
+
+    if (size > 0)
+    {
+        memcpy(snap->numbers, block, 4 * size * sizeof *block);
+        memcpy(snap->readings->values, values, size * sizeof *values);
+        memcpy(snap->readings->statuses, statuses, size * sizeof *statuses);
+    }
+
+    snap->chip_names = PyTuple_New(chip_count);
+    /* Maps each feature name to its index in feature_names */
+    feature_indices = PyDict_New();
+    feature_names = PyList_New(0);
+
+    if (snap->chip_names == NULL || feature_indices == NULL ||
+        feature_names == NULL)
+    {
+        goto error;
+    }
+
+    for (int c = 0; c < chip_count; c++)
+    {
+        PyObject *chip_name = PyString_FromString(chip_texts[c]);
+
+        if (chip_name == NULL)
+        {
+            goto error;
+        }
+
+        PyTuple_SET_ITEM(snap->chip_names, c, chip_name);
+    }
 
-            if (py_name == NULL)
+    /* Number the features by name rather than per chip, reusing the
+     * chip groups as the mapping from one to the other */
+    int *feature_map = PyMem_Realloc(chip_groups,
+                                     (feature_count + 1) * sizeof(int));
+
+    if (feature_map == NULL)
+    {
+        goto error;
+    }
+
+    chip_groups = feature_map;
+
+    for (int f = 0; f < feature_count; f++)
+    {
+        PyObject *name = PyString_FromString(feature_texts[f]);
+
+        if (name == NULL)
+        {
+            goto error;
+        }
+
+        PyObject *py_index = PyDict_GetItem(feature_indices, name);
+
+        if (py_index != NULL)
+        {
+            feature_map[f] = (int)PyLong_AsLong(py_index);
+        }
+        else
+        {
+            feature_map[f] = (int)PyList_GET_SIZE(feature_names);
+            py_index = PyLong_FromLong(feature_map[f]);
+
+            if (py_index == NULL ||
+                PyDict_SetItem(feature_indices, name, py_index) < 0 ||
+                PyList_Append(feature_names, name) < 0)
             {
+                Py_XDECREF(py_index);
+                Py_DECREF(name);
                 goto error;
             }
 
-            PyList_Append(list, py_name);
-            Py_DECREF(py_name);
+            Py_DECREF(py_index);
         }
+
+        Py_DECREF(name);
     }
 
-    return list;
+    for (i = 0; i < size; i++)
+    {
+        snap->features[i] = feature_map[snap->features[i]];
+    }
+
+    snap->feature_names = PyList_AsTuple(feature_names);
+
+    if (snap->feature_names == NULL)
+    {
+        goto error;
+    }
+
+    goto end;
 
 error:
-    Py_DECREF(list);
+    if (locked)
+    {
+        UNLOCK_SENSORS();
+    }
+
+    if (!PyErr_Occurred())
+    {
+        PyErr_NoMemory();
+    }
+
+    Py_CLEAR(snap);
+
+end:
+    for (int c = 0; c < chip_count; c++)
+    {
+        free(chip_texts[c]);
+    }
+
+    for (int f = 0; f < feature_count; f++)
+    {
+        free(feature_texts[f]);
+    }
+
+    PyMem_Free(block);
+    PyMem_Free(values);
+    PyMem_Free(statuses);
+    PyMem_Free(chip_texts);
+    PyMem_Free(feature_texts);
+    PyMem_Free(chips);
+    PyMem_Free(chip_starts);
+    PyMem_Free(chip_groups);
+    PyMem_Free(group_starts);
+    PyMem_Free(requests);
+    Py_XDECREF(feature_names);
+    Py_XDECREF(feature_indices);
+
+    return (PyObject*)snap;
+}
+
+/*
+ * Return the requests to read the subfeatures whose numbers are given,
+ * sorted by bus, and set group_starts and group_count as
+ * fast_read_grouped() expects them. The subfeatures of chip c are
+ * chip_starts[c] to chip_starts[c + 1] - 1, and chip_groups is used to
+ * store the bus of each chip. NULL is returned if memory couldn't be allocated.
+ */
+static FastReadRequest*
+snapshot_requests(const int *numbers, const sensors_chip_name **chips,
+                  int chip_count, const Py_ssize_t *chip_starts,
+                  int *chip_groups, int *group_starts, int *group_count)
+{
+    FastReadRequest *requests = PyMem_Malloc(
+        (chip_starts[chip_count] + 1) * sizeof *requests);
+    Py_ssize_t k = 0;
+
+    if (requests == NULL)
+    {
+        return NULL;
+    }
+
+    *group_count = group_by_bus(chips, chip_count, chip_groups);
+
+    for (int g = 0; g < *group_count; g++)
+    {
+        group_starts[g] = (int)k;
+
+        for (int c = 0; c < chip_count; c++)
+        {
+            if (chip_groups[c] != g)
+            {
+                continue;
+            }
+
+            for (Py_ssize_t i = chip_starts[c]; i < chip_starts[c + 1]; i++)
+            {
+                requests[k].entry = NULL;
+                requests[k].chip = chips[c];
+                requests[k].number = numbers[i];
+                requests[k].index = i;
+                k++;
+            }
+        }
+    }
+
+    group_starts[*group_count] = (int)k;
+
+    return requests;
+}
+
+static PyObject*
+read_many(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"pairs", NULL};
+    PyObject *pairs = NULL;
+    Readings *readings = NULL;
+    FastReadRequest *requests = NULL;
+    sensors_chip_name *names = NULL;
+    Py_ssize_t name_count = 0;
+
+    (void)self;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &pairs))
+    {
+        return NULL;
+    }
+
+    PyObject *seq = PySequence_Fast(
+        pairs, "pairs must be a sequence of (ChipName, Subfeature) tuples");
+
+    /* The parsing may run Python code, which could change a list */
+    if (seq != NULL && PyList_Check(seq))
+    {
+        PyObject *tuple = PyList_AsTuple(seq);
+
+        Py_DECREF(seq);
+        seq = tuple;
+    }
+
+    if (seq == NULL)
+    {
+        return NULL;
+    }
+
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(seq);
+
+    readings = readings_new(size);
+    requests = PyMem_Malloc((size + 1) * sizeof *requests);
+    names = PyMem_Malloc((size + 1) * sizeof *names);
+
+    if (readings == NULL || requests == NULL || names == NULL)
+    {
+        if (readings != NULL)
+        {
+            PyErr_NoMemory();
+        }
+
+        goto error;
+    }
+
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        ChipName *chip_name = NULL;
+
+        if (read_plan_parse_pair(PySequence_Fast_GET_ITEM(seq, i),
+                                 &chip_name, &requests[i].number) < 0)
+        {
+            goto error;
+        }
+
+        /* Copied, since other threads can change or free the ChipName
+         * objects while the GIL is released */
+        if (copy_chip_name(&chip_name->chip_name, &names[i]) < 0)
+        {
+            PyErr_NoMemory();
+            goto error;
+        }
+
+        name_count++;
+        requests[i].index = i;
+    }
+
+    BEGIN_SENSORS_IO
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        const sensors_chip_name *chip = resolve_chip(&names[i]);
+
+        requests[i].chip = chip;
+        requests[i].entry = chip == NULL ?
+            NULL : fast_read_lookup(chip, requests[i].number);
+    }
+
+    fast_read_many(requests, size, readings->values, readings->statuses);
+    END_SENSORS_IO
+
+    for (Py_ssize_t i = 0; i < name_count; i++)
+    {
+        free_chip_name(&names[i]);
+    }
+
+    PyMem_Free(requests);
+    PyMem_Free(names);
+    Py_DECREF(seq);
+
+    return (PyObject*)readings;
+
+error:
+    for (Py_ssize_t i = 0; i < name_count; i++)
+    {
+        free_chip_name(&names[i]);
+    }
+
+    PyMem_Free(requests);
+    PyMem_Free(names);
+    Py_DECREF(seq);
+    Py_XDECREF(readings);
     return NULL;
 }
 
+
 static PyObject*
-get_adapter_name(PyObject *self, PyObject *args, PyObject *kwargs)
+set_fast_read(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    char *kwlist[] = {"bus_type", "bus_nr", NULL};
-    const sensors_bus_id bus = {-1, -1};
+    char *kwlist[] = {"enabled", NULL};
+    PyObject *enabled = NULL;
 
     (void)self;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "hh", kwlist,
-                                      &bus.type, &bus.nr))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &enabled))
     {
         return NULL;
     }
 
-    const char *adapter_name = sensors_get_adapter_name(&bus);
+    int was_enabled = fast_read_enabled;
+    int is_true = PyObject_IsTrue(enabled);
 
-    if (adapter_name == NULL)
+    if (is_true < 0)
     {
-        Py_RETURN_NONE;
+        return NULL;
     }
-    else
+
+    BEGIN_SENSORS_WRITE
+    fast_read_enabled = is_true;
+
+    if (!fast_read_enabled)
     {
-        return PyString_FromString(adapter_name);
+        fast_read_clear();
     }
+    END_SENSORS_WRITE
+
+    return PyBool_FromLong(was_enabled);
+}
+
+static PyObject*
+watch(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    (void)self;
+
+    return call_async("watch", args, kwargs);
+}
+
+static PyObject*
+get_stats(PyObject *self, PyObject *args)
+{
+    (void)self;
+    (void)args;
+
+    return stats_get();
+}
+
+static PyObject*
+reset_stats(PyObject *self, PyObject *args)
+{
+    (void)self;
+    (void)args;
+
+    stats_reset();
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+profile(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    char *kwlist[] = {"duration", NULL};
+    double duration = 1.0;
+
+    (void)self;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|d", kwlist,
+                                     &duration))
+    {
+        return NULL;
+    }
+
+    return profile_run(duration);
 }
 
 static PyObject*
@@ -547,8 +1312,11 @@ static void c_parse_error_handler(const char *err, const char *filename,
     }
     else
     {
+        /* libsensors may call us from a thread that released the GIL */
+        PyGILState_STATE gil_state = PyGILState_Ensure();
         PyObject *args = Py_BuildValue("(ssi)", err, filename, lineno);
         PyObject_CallObject(py_parse_error_handler, args);
+        PyGILState_Release(gil_state);
     }
 }
 
@@ -584,6 +1352,9 @@ replace_fatal_error_handler(PyObject *self, PyObject *args, PyObject *kwargs)
 static void
 c_fatal_error_handler(const char *proc, const char *err)
 {
+    /* libsensors may call us from a thread that released the GIL */
+    PyGILState_Ensure();
+
     if (py_fatal_error_handler == NULL)
     {
         fprintf(stderr, "Fatal error in `%s': %s\n"
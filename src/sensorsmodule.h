@@ -46,17 +46,81 @@
 #define FREE_OBJECT(o) Py_TYPE(o)->tp_free((PyObject*)o)
 #endif
 
+/* New-style buffer protocol */
+#ifndef IS_PY3K
+#define INIT_BUFFER_PROCS(get, release) {0, 0, 0, 0, get, release}
+#define TPFLAGS_NEWBUFFER Py_TPFLAGS_HAVE_NEWBUFFER
+#else
+#define INIT_BUFFER_PROCS(get, release) {get, release}
+#define TPFLAGS_NEWBUFFER 0
+#endif
+
 #ifdef IS_PY3K
 #define PyString_FromString PyUnicode_FromString
+#define PyString_InternFromString PyUnicode_InternFromString
 #define PyString_FromFormat PyUnicode_FromFormat
 #define PyString_Check PyUnicode_Check
 #endif
 
+#include <pthread.h>
+
+/*
+ * libsensors isn't thread-safe, so every call into it, and every use
+ * of the data it returns, happens with sensors_lock held.  The calls
+ * that only read libsensors' state take it in shared mode, so that
+ * chips on different buses can be read at the same time; init(),
+ * cleanup() and the writes take it in exclusive mode.  Never wait for
+ * the lock while holding the GIL: the thread that holds the lock may
+ * need the GIL to call a Python error handler.  Don't create Python
+ * objects while holding it either: that may run a garbage collection,
+ * and a __del__() method that reads a sensor would then wait for the
+ * lock behind a waiting init(), which waits for us.  Look up what is
+ * needed under the lock, and build the objects once it is released.
+ *
+ * LOCK_SENSORS() is meant for reads that don't block, and keeps the
+ * GIL unless the lock is contended.  The reads that do I/O go between
+ * BEGIN_SENSORS_IO and END_SENSORS_IO, and the writes between
+ * BEGIN_SENSORS_WRITE and END_SENSORS_WRITE; both release the GIL, so
+ * no Python API can be used there.
+ */
+#define LOCK_SENSORS()                                          \
+    do                                                          \
+    {                                                           \
+        if (pthread_rwlock_tryrdlock(&sensors_lock) != 0)       \
+        {                                                       \
+            Py_BEGIN_ALLOW_THREADS                              \
+            pthread_rwlock_rdlock(&sensors_lock);               \
+            Py_END_ALLOW_THREADS                                \
+        }                                                       \
+    } while (0)
+
+#define UNLOCK_SENSORS() pthread_rwlock_unlock(&sensors_lock)
+
+#define BEGIN_SENSORS_IO                        \
+    Py_BEGIN_ALLOW_THREADS                      \
+    pthread_rwlock_rdlock(&sensors_lock);
+
+#define END_SENSORS_IO                          \
+    pthread_rwlock_unlock(&sensors_lock);       \
+    Py_END_ALLOW_THREADS
+
+#define BEGIN_SENSORS_WRITE                     \
+    Py_BEGIN_ALLOW_THREADS                      \
+    pthread_rwlock_wrlock(&sensors_lock);
+
+#define END_SENSORS_WRITE END_SENSORS_IO
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 extern PyObject *SensorsException;
+extern pthread_rwlock_t sensors_lock;
+
+/* Incremented every time libsensors is initialized or cleaned up.
+ * Anything that keeps pointers into libsensors' own data has to
+ * resolve them again when this changes. */
+extern unsigned long sensors_generation;
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <structmember.h>
+
+#include "sensorsmodule.h"
+#include "snapshot.h"
+
+
+static void dealloc(Snapshot*);
+static PyObject* repr(Snapshot*);
+static Py_ssize_t length(Snapshot*);
+static PyObject* item(Snapshot*, Py_ssize_t);
+
+
+static PyMethodDef methods[] = {
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef members[] =
+{
+    {"readings", T_OBJECT, offsetof(Snapshot, readings), READONLY,
+     "The values, as a Readings object."},
+    {"chip_names", T_OBJECT, offsetof(Snapshot, chip_names), READONLY,
+     "Tuple of the names of the chips."},
+    {"feature_names", T_OBJECT, offsetof(Snapshot, feature_names), READONLY,
+     "Tuple of the names of the features. Each name appears only once,"
+     " even if several chips have a feature with that name."},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PySequenceMethods sequence_methods = {
+    (lenfunc)length,           /* sq_length */
+    0,                         /* sq_concat */
+    0,                         /* sq_repeat */
+    (ssizeargfunc)item,        /* sq_item */
+};
+
+PyTypeObject SnapshotType =
+{
+    INIT_TYPE_HEAD
+    "sensors.Snapshot",        /*tp_name*/
+    sizeof(Snapshot),          /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)dealloc,       /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    (reprfunc)repr,            /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &sequence_methods,         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "Values of all the subfeatures of all the detected chips, returned by"
+    " snapshot(). s[i] is a (chip name, feature name, subfeature number,"
+    " subfeature type, value) tuple, where value is None if it couldn't"
+    " be read.",
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    methods,                   /* tp_methods */
+    members,                   /* tp_members */
+    0,                         /* tp_getset */
+};
+
+
+/**
+ * Create a Snapshot with room for size subfeatures. The caller has to
+ * fill the arrays and set chip_names and feature_names.
+ */
+Snapshot* snapshot_new(Py_ssize_t size)
+{
+    Snapshot *self = PyObject_New(Snapshot, &SnapshotType);
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    self->size = size;
+    self->numbers = NULL;
+    self->types = NULL;
+    self->chips = NULL;
+    self->features = NULL;
+    self->chip_names = NULL;
+    self->feature_names = NULL;
+    self->readings = readings_new(size);
+
+    if (self->readings == NULL)
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    if (size > 0)
+    {
+        int *block = PyMem_Malloc(4 * size * sizeof(int));
+
+        if (block == NULL)
+        {
+            Py_DECREF(self);
+            return (Snapshot*)PyErr_NoMemory();
+        }
+
+        self->numbers = block;
+        self->types = block + size;
+        self->chips = block + 2 * size;
+        self->features = block + 3 * size;
+    }
+
+    return self;
+}
+
+static void
+dealloc(Snapshot *self)
+{
+    PyMem_Free(self->numbers);
+    self->numbers = NULL;
+    Py_XDECREF(self->readings);
+    Py_XDECREF(self->chip_names);
+    Py_XDECREF(self->feature_names);
+    FREE_OBJECT(self);
+}
+
+static PyObject*
+repr(Snapshot *self)
+{
+    return PyString_FromFormat("Snapshot(size=%zd)", self->size);
+}
+
+static Py_ssize_t
+length(Snapshot *self)
+{
+    return self->size;
+}
+
+static PyObject*
+item(Snapshot *self, Py_ssize_t i)
+{
+    if (i < 0 || i >= self->size)
+    {
+        PyErr_SetString(PyExc_IndexError, "Snapshot index out of range");
+        return NULL;
+    }
+
+    PyObject *value = PySequence_GetItem((PyObject*)self->readings, i);
+
+    if (value == NULL)
+    {
+        return NULL;
+    }
+
+    return Py_BuildValue("(OOiiN)",
+                         PyTuple_GET_ITEM(self->chip_names, self->chips[i]),
+                         PyTuple_GET_ITEM(self->feature_names,
+                                          self->features[i]),
+                         self->numbers[i], self->types[i], value);
+}
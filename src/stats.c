@@ -0,0 +1,463 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Counters of the calls to the main functions, per chip: number of
+ * calls, errors by libsensors error code, total time and a histogram
+ * of the durations, with a bucket per power of two nanoseconds.
+ *
+ * The counters are always on, so recording has to be cheap.  The
+ * durations are measured with the GIL released, around the libsensors
+ * calls, but the counters are only updated with the GIL held, which
+ * makes the increments atomic without lock prefixes: the reads of
+ * AsyncReader are recorded by results(), for instance.
+ *
+ * Reading the clock twice costs more than the functions that are
+ * served from the topology cache, so only one call in SAMPLE_PERIOD
+ * is timed for them.  Every read and write is timed, since a single
+ * slow read is what we want to see.
+ */
+
+#include <Python.h>
+
+#include <string.h>
+
+#include <sensors/error.h>
+#include <sensors/sensors.h>
+
+#include "sensorsmodule.h"
+#include "stats.h"
+#include "utils.h"
+
+#define BUCKET_COUNT 40
+/* Error codes from 1 to SENSORS_ERR_RECURSION; 0 is for the others */
+#define ERROR_COUNT 12
+#define TABLE_SIZE 256
+#define NAME_SIZE 256
+#define SAMPLE_PERIOD 16
+
+
+typedef struct
+{
+    uint64_t calls;
+    uint64_t timed_calls;
+    uint64_t total_ns;
+    uint64_t errors[ERROR_COUNT];
+    uint64_t buckets[BUCKET_COUNT];
+} Counters;
+
+typedef struct StatsChip
+{
+    /* Key; prefix is NULL for the calls that aren't about a chip */
+    char *prefix;
+    sensors_bus_id bus;
+    int addr;
+
+    Counters counters[STATS_OPERATION_COUNT];
+    struct StatsChip *next;     /* In the bucket */
+    struct StatsChip *next_chip; /* In the list of all the chips */
+} StatsChip;
+
+
+static StatsChip* lookup(const sensors_chip_name*);
+static int same_chip(const StatsChip*, const sensors_chip_name*);
+static unsigned int hash(const sensors_chip_name*);
+static int bucket_index(int64_t);
+static int error_index(int);
+static PyObject* chip_key(const StatsChip*);
+static PyObject* counters_to_dict(const Counters*);
+
+/* Whether every call is timed, or one in SAMPLE_PERIOD */
+static const int always_timed[STATS_OPERATION_COUNT] = {
+    [STATS_GET_VALUE] = 1,
+    [STATS_SET_VALUE] = 1
+};
+
+static const char *operation_names[STATS_OPERATION_COUNT] = {
+    "get_value",
+    "set_value",
+    "get_detected_chips",
+    "get_features",
+    "get_all_subfeatures",
+    "get_subfeature",
+    "get_label"
+};
+
+static StatsChip *table[TABLE_SIZE];
+static StatsChip *chips = NULL;
+static StatsChip global = {NULL};
+static unsigned int ticks[STATS_OPERATION_COUNT];
+
+
+/**
+ * Call this before operation, and pass the result to stats_stop()
+ * after it. Return the CLOCK_MONOTONIC time in nanoseconds, or
+ * STATS_UNTIMED if this call isn't timed. The GIL doesn't need to be
+ * held.
+ */
+int64_t stats_start(StatsOperation operation)
+{
+    /* The operations that aren't always timed hold the GIL */
+    if (!always_timed[operation] && ticks[operation]++ % SAMPLE_PERIOD != 0)
+    {
+        return STATS_UNTIMED;
+    }
+
+    return clock_ns(CLOCK_MONOTONIC);
+}
+
+/**
+ * Return the nanoseconds elapsed since start, which was returned by
+ * stats_start(), or STATS_UNTIMED.
+ */
+int64_t stats_stop(int64_t start)
+{
+    return start == STATS_UNTIMED ?
+        STATS_UNTIMED : clock_ns(CLOCK_MONOTONIC) - start;
+}
+
+/**
+ * Record a call to operation about chip, which may be NULL. elapsed is
+ * the value returned by stats_stop(), and status is 0, a negative
+ * libsensors error, or STATS_FAILED.
+ */
+void stats_record(const sensors_chip_name *chip, StatsOperation operation,
+                  int64_t elapsed, int status)
+{
+    StatsChip *entry = chip == NULL ? &global : lookup(chip);
+
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    Counters *counters = &entry->counters[operation];
+
+    counters->calls++;
+
+    if (elapsed != STATS_UNTIMED)
+    {
+        counters->timed_calls++;
+        counters->total_ns += (uint64_t)elapsed;
+        counters->buckets[bucket_index(elapsed)]++;
+    }
+
+    if (status < 0)
+    {
+        counters->errors[error_index(status)]++;
+    }
+}
+
+/**
+ * Return the counters as a dict. The keys are the chip names, or None
+ * for the calls that aren't about a chip.
+ */
+PyObject* stats_get(void)
+{
+    PyObject *result = PyDict_New();
+    StatsChip *entry = &global;
+
+    if (result == NULL)
+    {
+        return NULL;
+    }
+
+    global.next_chip = chips;
+
+    for (; entry != NULL; entry = entry->next_chip)
+    {
+        PyObject *operations = PyDict_New();
+
+        if (operations == NULL)
+        {
+            goto error;
+        }
+
+        for (int i = 0; i < STATS_OPERATION_COUNT; i++)
+        {
+            if (entry->counters[i].calls == 0)
+            {
+                continue;
+            }
+
+            PyObject *counters = counters_to_dict(&entry->counters[i]);
+
+            if (counters == NULL ||
+                PyDict_SetItemString(operations, operation_names[i],
+                                     counters) < 0)
+            {
+                Py_XDECREF(counters);
+                Py_DECREF(operations);
+                goto error;
+            }
+
+            Py_DECREF(counters);
+        }
+
+        if (PyDict_Size(operations) > 0)
+        {
+            PyObject *key = chip_key(entry);
+
+            if (key == NULL || PyDict_SetItem(result, key, operations) < 0)
+            {
+                Py_XDECREF(key);
+                Py_DECREF(operations);
+                goto error;
+            }
+
+            Py_DECREF(key);
+        }
+
+        Py_DECREF(operations);
+    }
+
+    return result;
+
+error:
+    Py_DECREF(result);
+    return NULL;
+}
+
+/**
+ * Set all the counters to 0.
+ */
+void stats_reset(void)
+{
+    global.next_chip = chips;
+
+    for (StatsChip *entry = &global; entry != NULL; entry = entry->next_chip)
+    {
+        memset(entry->counters, 0, sizeof entry->counters);
+    }
+}
+
+/*
+ * Return the entry of chip, creating it if needed, or NULL if memory
+ * couldn't be allocated.
+ */
+static StatsChip*
+lookup(const sensors_chip_name *chip)
+{
+    unsigned int h = hash(chip) % TABLE_SIZE;
+    StatsChip *entry;
+
+    for (entry = table[h]; entry != NULL; entry = entry->next)
+    {
+        if (same_chip(entry, chip))
+        {
+            return entry;
+        }
+    }
+
+    entry = calloc(1, sizeof *entry);
+
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+
+    if (chip->prefix != NULL)
+    {
+        entry->prefix = strdup(chip->prefix);
+
+        if (entry->prefix == NULL)
+        {
+            free(entry);
+            return NULL;
+        }
+    }
+
+    entry->bus = chip->bus;
+    entry->addr = chip->addr;
+    entry->next = table[h];
+    table[h] = entry;
+    entry->next_chip = chips;
+    chips = entry;
+
+    return entry;
+}
+
+static int
+same_chip(const StatsChip *entry, const sensors_chip_name *chip)
+{
+    if (entry->addr != chip->addr ||
+        entry->bus.type != chip->bus.type ||
+        entry->bus.nr != chip->bus.nr)
+    {
+        return 0;
+    }
+
+    if (entry->prefix == NULL || chip->prefix == NULL)
+    {
+        return entry->prefix == chip->prefix;
+    }
+
+    return strcmp(entry->prefix, chip->prefix) == 0;
+}
+
+static unsigned int
+hash(const sensors_chip_name *chip)
+{
+    /* FNV-1a */
+    unsigned int h = 2166136261u;
+
+    if (chip->prefix != NULL)
+    {
+        for (const char *c = chip->prefix; *c != '\0'; c++)
+        {
+            h = (h ^ (unsigned char)*c) * 16777619u;
+        }
+    }
+
+    h = (h ^ (unsigned int)chip->bus.type) * 16777619u;
+    h = (h ^ (unsigned int)chip->bus.nr) * 16777619u;
+    h = (h ^ (unsigned int)chip->addr) * 16777619u;
+
+    return h;
+}
+
+/*
+ * Bucket i > 0 counts the durations from 2^(i - 1) to 2^i - 1
+ * nanoseconds, and the last one everything above.
+ */
+static int
+bucket_index(int64_t ns)
+{
+    if (ns <= 0)
+    {
+        return 0;
+    }
+
+    int i = 64 - __builtin_clzll((unsigned long long)ns);
+
+    return i < BUCKET_COUNT ? i : BUCKET_COUNT - 1;
+}
+
+static int
+error_index(int status)
+{
+    return status < -(ERROR_COUNT - 1) ? 0 : -status;
+}
+
+/*
+ * Return the name of the chip of entry, as str(ChipName) would, or
+ * None for the global entry.
+ */
+static PyObject*
+chip_key(const StatsChip *entry)
+{
+    if (entry == &global)
+    {
+        Py_RETURN_NONE;
+    }
+
+    sensors_chip_name chip = {entry->prefix, entry->bus, entry->addr, NULL};
+    char name[NAME_SIZE];
+    int status;
+
+    if (entry->prefix == NULL)
+    {
+        return PyString_FromString("*");
+    }
+
+    LOCK_SENSORS();
+    status = sensors_snprintf_chip_name(name, sizeof name, &chip);
+    UNLOCK_SENSORS();
+
+    return PyString_FromString(status < 0 ? entry->prefix : name);
+}
+
+static PyObject*
+counters_to_dict(const Counters *counters)
+{
+    PyObject *errors = PyDict_New();
+    PyObject *histogram = PyList_New(0);
+    PyObject *result = NULL;
+
+    if (errors == NULL || histogram == NULL)
+    {
+        goto end;
+    }
+
+    for (int i = 0; i < ERROR_COUNT; i++)
+    {
+        uint64_t count = counters->errors[i];
+
+        if (count == 0)
+        {
+            continue;
+        }
+
+        PyObject *py_count = PyLong_FromUnsignedLongLong(count);
+
+        if (py_count == NULL ||
+            PyDict_SetItemString(errors, sensors_strerror(-i),
+                                 py_count) < 0)
+        {
+            Py_XDECREF(py_count);
+            goto end;
+        }
+
+        Py_DECREF(py_count);
+    }
+
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        uint64_t count = counters->buckets[i];
+
+        if (count == 0)
+        {
+            continue;
+        }
+
+        /* The upper bound of the bucket, exclusive */
+        PyObject *bucket = Py_BuildValue("(KK)", 1ull << i, count);
+
+        if (bucket == NULL || PyList_Append(histogram, bucket) < 0)
+        {
+            Py_XDECREF(bucket);
+            goto end;
+        }
+
+        Py_DECREF(bucket);
+    }
+
+    result = Py_BuildValue(
+        "{sKsKsKsOsO}",
+        "calls", counters->calls,
+        "timed_calls", counters->timed_calls,
+        "total_ns", counters->total_ns,
+        "errors", errors,
+        "histogram", histogram);
+
+end:
+    Py_XDECREF(errors);
+    Py_XDECREF(histogram);
+    return result;
+}
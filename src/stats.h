@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_STATS
+#define H_STATS
+
+#include <Python.h>
+
+#include <limits.h>
+#include <stdint.h>
+
+#include <sensors/sensors.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The instrumented functions */
+typedef enum
+{
+    STATS_GET_VALUE,
+    STATS_SET_VALUE,
+    STATS_GET_DETECTED_CHIPS,
+    STATS_GET_FEATURES,
+    STATS_GET_ALL_SUBFEATURES,
+    STATS_GET_SUBFEATURE,
+    STATS_GET_LABEL,
+    STATS_OPERATION_COUNT
+} StatsOperation;
+
+/* Status of a call that failed without a libsensors error code */
+#define STATS_FAILED INT_MIN
+/* Returned by stats_start() and stats_stop() when the call isn't timed */
+#define STATS_UNTIMED INT64_MIN
+
+int64_t stats_start(StatsOperation);
+int64_t stats_stop(int64_t);
+void stats_record(const sensors_chip_name*, StatsOperation, int64_t, int);
+PyObject* stats_get(void);
+void stats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
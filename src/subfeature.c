@@ -30,6 +30,8 @@
 #include <Python.h>
 #include <structmember.h>
 
+#include <string.h>
+
 #include <sensors/error.h>
 
 #include "sensorsmodule.h"
@@ -43,6 +45,8 @@ static PyObject* repr(Subfeature*);
 static PyObject* rich_compare(PyObject*, PyObject*, int);
 static PyObject* get_name(Subfeature*, void*);
 static int set_name(Subfeature*, PyObject*, void*);
+static int setattro(Subfeature*, PyObject*, PyObject*);
+static int check_mutable(Subfeature*);
 
 
 static PyMethodDef methods[] = {
@@ -95,7 +99,7 @@ PyTypeObject SubfeatureType =
     0,                         /*tp_call*/
     0,                         /*tp_str*/
     0,                         /*tp_getattro*/
-    0,                         /*tp_setattro*/
+    (setattrofunc)setattro,    /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /*tp_flags*/
     0,                          /* tp_doc */
@@ -119,6 +123,36 @@ PyTypeObject SubfeatureType =
 };
 
 
+/**
+ * Create a Subfeature object with a copy of subfeature, without going through
+ * __init__(). name is a Python string with the same content as
+ * subfeature->name, that the object will refer to.
+ */
+Subfeature* subfeature_new(const sensors_subfeature *subfeature, PyObject *name)
+{
+    char *c_name = pystr(name);
+
+    if (c_name == NULL)
+    {
+        return NULL;
+    }
+
+    Subfeature *self = PyObject_New(Subfeature, &SubfeatureType);
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    self->subfeature = *subfeature;
+    self->subfeature.name = c_name;
+    self->py_name = name;
+    Py_INCREF(name);
+    self->interned = 0;
+
+    return self;
+}
+
 static int
 init(Subfeature *self, PyObject *args, PyObject *kwargs)
 {
@@ -143,25 +177,32 @@ init(Subfeature *self, PyObject *args, PyObject *kwargs)
         return -1;
     }
 
+    if (check_mutable(self) < 0)
+    {
+        return -1;
+    }
+
+    char *c_name = NULL;
+
     if (name == NULL)
     {
-        self->subfeature.name = NULL;
-        self->py_name = Py_None;
-        Py_INCREF(self->py_name);
+        name = Py_None;
     }
     else
     {
-        self->subfeature.name = pystrdup(name);
+        c_name = pystr(name);
 
-        if (self->subfeature.name == NULL)
+        if (c_name == NULL)
         {
             return -1;
         }
-
-        self->py_name = name;
-        Py_INCREF(self->py_name);
     }
 
+    Py_INCREF(name);
+    Py_XDECREF(self->py_name);
+    self->py_name = name;
+    self->subfeature.name = c_name;
+
     self->subfeature.number = number;
     self->subfeature.type = type;
     self->subfeature.mapping = mapping;
@@ -173,9 +214,8 @@ init(Subfeature *self, PyObject *args, PyObject *kwargs)
 static void
 dealloc(Subfeature *self)
 {
-    free(self->subfeature.name);
     self->subfeature.name = NULL;
-    Py_DECREF(self->py_name);
+    Py_XDECREF(self->py_name);
     FREE_OBJECT(self);
 }
 
@@ -201,6 +241,11 @@ rich_compare(PyObject *a, PyObject *b, int op)
 {
     if (op == Py_EQ || op == Py_NE)
     {
+        if (a == b)
+        {
+            return PyBool_FromLong(op == Py_EQ);
+        }
+
         if (! (PyObject_IsInstance(a, (PyObject*)&SubfeatureType) &&
                PyObject_IsInstance(b, (PyObject*)&SubfeatureType)))
         {
@@ -212,7 +257,8 @@ rich_compare(PyObject *a, PyObject *b, int op)
         sensors_subfeature *s2 = &((Subfeature*)b)->subfeature;
 
         int equal = (((s1->name == NULL && s2->name == NULL) ||
-                      strcmp(s1->name, s2->name) == 0) &&
+                      (s1->name != NULL && s2->name != NULL &&
+                       strcmp(s1->name, s2->name) == 0)) &&
                      s1->number == s2->number &&
                      s1->type == s2->type &&
                      s1->mapping == s2->mapping &&
@@ -242,6 +288,11 @@ get_name(Subfeature *self, void *closure)
 {
     (void)closure;
 
+    if (self->py_name == NULL)
+    {
+        Py_RETURN_NONE;
+    }
+
     Py_INCREF(self->py_name);
 
     return self->py_name;
@@ -260,30 +311,55 @@ set_name(Subfeature *self, PyObject *value, void *closure)
 
     if (value != Py_None && !PyString_Check(value))
     {
-        PyErr_SetString(PyExc_TypeError, 
+        PyErr_SetString(PyExc_TypeError,
                         "The name attribute value must be a string or None");
         return -1;
     }
 
-    free(self->subfeature.name);
+    char *c_name = NULL;
 
-    if (value == Py_None)
-    {
-        self->subfeature.name = NULL;
-        self->py_name = Py_None;
-        Py_INCREF(self->py_name);
-    }
-    else
+    if (value != Py_None)
     {
-        self->subfeature.name = pystrdup(value);
+        c_name = pystr(value);
 
-        if (self->subfeature.name == NULL)
+        if (c_name == NULL)
         {
             return -1;
         }
+    }
+
+    Py_INCREF(value);
+    Py_XDECREF(self->py_name);
+    self->py_name = value;
+    self->subfeature.name = c_name;
+
+    return 0;
+}
 
-        self->py_name = value;
-        Py_INCREF(self->py_name);
+static int
+setattro(Subfeature *self, PyObject *name, PyObject *value)
+{
+    if (check_mutable(self) < 0)
+    {
+        return -1;
+    }
+
+    return PyObject_GenericSetAttr((PyObject*)self, name, value);
+}
+
+/**
+ * Raise AttributeError if the object is interned, and can't be
+ * modified.
+ */
+static int
+check_mutable(Subfeature *self)
+{
+    if (self->interned)
+    {
+        PyErr_SetString(PyExc_AttributeError,
+                        "Subfeature objects returned by ChipName are"
+                        " read-only");
+        return -1;
     }
 
     return 0;
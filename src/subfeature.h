@@ -41,13 +41,22 @@ extern "C" {
 extern PyTypeObject SubfeatureType;
 
 
+/*
+ * subfeature.name points into py_name, so the name is only stored once.
+ * The objects returned by ChipName are interned: they are shared by
+ * every caller until libsensors is initialized again, and can't be
+ * modified.
+ */
 typedef struct
 {
     PyObject_HEAD
     sensors_subfeature subfeature;
-    PyObject *py_name;
+    PyObject *py_name;          /* A string, or None */
+    int interned;
 } Subfeature;
 
+Subfeature* subfeature_new(const sensors_subfeature*, PyObject*);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,919 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <Python.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <sensors/sensors.h>
+
+#include "sensorsmodule.h"
+#include "feature.h"
+#include "subfeature.h"
+#include "topology.h"
+#include "utils.h"
+
+
+/* What is cached for one chip name */
+typedef struct
+{
+    sensors_chip_name name;     /* Copy of the name, prefix included */
+    PyObject *features;         /* Tuple of Feature */
+    /* Indexed by feature number, NULL until they are asked for */
+    PyObject **subfeatures;     /* Tuples of Subfeature */
+    PyObject **labels;
+} TopologyChip;
+
+
+static TopologyChip* find_chip(const sensors_chip_name*);
+static TopologyChip* lookup_chip(const sensors_chip_name*);
+static TopologyChip* add_chip(const sensors_chip_name*, PyObject*);
+static unsigned long current_generation(void);
+static void check_generation(unsigned long);
+static void clear(void);
+static int same_name(const sensors_chip_name*, const sensors_chip_name*);
+static Py_ssize_t feature_index(TopologyChip*, const sensors_feature*);
+static int copy_args(const sensors_chip_name*, const sensors_feature*,
+                     sensors_chip_name*, sensors_feature*);
+static void free_args(sensors_chip_name*, sensors_feature*);
+static sensors_feature* copy_features(const sensors_chip_name*,
+                                      Py_ssize_t*, unsigned long*);
+static sensors_subfeature* copy_subfeatures(const sensors_chip_name*,
+                                            const sensors_feature*,
+                                            Py_ssize_t*, unsigned long*);
+static PyObject* enumerate_subfeatures(const sensors_chip_name*,
+                                       const sensors_feature*,
+                                       unsigned long*);
+static PyObject* intern_feature(const sensors_feature*);
+static PyObject* intern_subfeature(const sensors_subfeature*);
+static PyObject* find_interned(PyObject*);
+static PyObject* add_interned(PyObject*, PyObject*);
+static PyObject* read_label(const sensors_chip_name*,
+                            const sensors_feature*, unsigned long*);
+
+
+/* The chips are allocated one by one, so that pointers to them stay
+ * valid when the array grows */
+static TopologyChip **chips = NULL;
+static Py_ssize_t chip_count = 0;
+static Py_ssize_t chip_capacity = 0;
+/* The sensors_generation the cache belongs to; it only moves forward */
+static unsigned long generation = 0;
+/* Maps the fields of the Feature and Subfeature objects of this
+ * generation to the objects, so that they are shared between chips */
+static PyObject *interned = NULL;
+
+
+/**
+ * Return a tuple of the features of the chip.
+ */
+PyObject* topology_get_features(const sensors_chip_name *name)
+{
+    TopologyChip *chip = find_chip(name);
+
+    if (chip == NULL)
+    {
+        return NULL;
+    }
+
+    Py_INCREF(chip->features);
+
+    return chip->features;
+}
+
+/**
+ * Return a tuple of the subfeatures of feature.
+ */
+PyObject* topology_get_subfeatures(const sensors_chip_name *name,
+                                   const sensors_feature *feature)
+{
+    TopologyChip *chip = find_chip(name);
+
+    if (chip == NULL)
+    {
+        return NULL;
+    }
+
+    Py_ssize_t i = feature_index(chip, feature);
+
+    if (i >= 0 && chip->subfeatures[i] != NULL)
+    {
+        Py_INCREF(chip->subfeatures[i]);
+        return chip->subfeatures[i];
+    }
+
+    unsigned long subfeatures_generation = 0;
+    PyObject *subfeatures = enumerate_subfeatures(name, feature,
+                                                  &subfeatures_generation);
+
+    /* Features made from Python may not match what libsensors has */
+    if (subfeatures == NULL || i < 0)
+    {
+        return subfeatures;
+    }
+
+    /* The cache may have changed while the lock was taken, or while
+     * the objects were created */
+    chip = subfeatures_generation == generation ? lookup_chip(name) : NULL;
+
+    if (chip != NULL && feature_index(chip, feature) == i &&
+        chip->subfeatures[i] == NULL)
+    {
+        Py_INCREF(subfeatures);
+        chip->subfeatures[i] = subfeatures;
+    }
+
+    return subfeatures;
+}
+
+/**
+ * Return the subfeature of feature that has type, or None.
+ */
+PyObject* topology_get_subfeature(const sensors_chip_name *name,
+                                  const sensors_feature *feature, int type)
+{
+    TopologyChip *chip = find_chip(name);
+
+    if (chip == NULL)
+    {
+        return NULL;
+    }
+
+    if (feature_index(chip, feature) < 0)
+    {
+        sensors_chip_name chip_name;
+        sensors_feature feature_copy;
+        sensors_subfeature copy;
+        const sensors_subfeature *subfeature = NULL;
+        unsigned long subfeature_generation = 0;
+
+        if (copy_args(name, feature, &chip_name, &feature_copy) < 0)
+        {
+            return NULL;
+        }
+
+        LOCK_SENSORS();
+        subfeature = sensors_get_subfeature(&chip_name, &feature_copy, type);
+
+        if (subfeature != NULL)
+        {
+            copy = *subfeature;
+            copy.name = strdup(subfeature->name);
+        }
+
+        subfeature_generation = sensors_generation;
+        UNLOCK_SENSORS();
+
+        free_args(&chip_name, &feature_copy);
+
+        if (subfeature == NULL)
+        {
+            Py_RETURN_NONE;
+        }
+
+        if (copy.name == NULL)
+        {
+            return PyErr_NoMemory();
+        }
+
+        check_generation(subfeature_generation);
+        PyObject *result = intern_subfeature(&copy);
+        free(copy.name);
+
+        return result;
+    }
+
+    PyObject *subfeatures = topology_get_subfeatures(name, feature);
+
+    if (subfeatures == NULL)
+    {
+        return NULL;
+    }
+
+    PyObject *result = Py_None;
+
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(subfeatures); i++)
+    {
+        Subfeature *subfeature = (Subfeature*)PyTuple_GET_ITEM(subfeatures, i);
+
+        if ((int)subfeature->subfeature.type == type)
+        {
+            result = (PyObject*)subfeature;
+            break;
+        }
+    }
+
+    Py_INCREF(result);
+    Py_DECREF(subfeatures);
+
+    return result;
+}
+
+/**
+ * Return the label of feature. The GIL is released while it is read,
+ * since it may come from sysfs.
+ */
+PyObject* topology_get_label(const sensors_chip_name *name,
+                             const sensors_feature *feature)
+{
+    TopologyChip *chip = find_chip(name);
+
+    if (chip == NULL)
+    {
+        return NULL;
+    }
+
+    Py_ssize_t i = feature_index(chip, feature);
+
+    if (i >= 0 && chip->labels[i] != NULL)
+    {
+        Py_INCREF(chip->labels[i]);
+        return chip->labels[i];
+    }
+
+    unsigned long label_generation = 0;
+    PyObject *label = read_label(name, feature, &label_generation);
+
+    if (label == NULL || i < 0)
+    {
+        return label;
+    }
+
+    check_generation(label_generation);
+
+    /* Another thread may have read it while the GIL was released, or
+     * libsensors may have been initialized again */
+    chip = label_generation == generation ? lookup_chip(name) : NULL;
+
+    if (chip != NULL && feature_index(chip, feature) == i &&
+        chip->labels[i] == NULL)
+    {
+        Py_INCREF(label);
+        chip->labels[i] = label;
+    }
+
+    return label;
+}
+
+/**
+ * Return the interned Subfeature that is equal to subfeature, creating
+ * it if needed. subfeature is a copy, since sensors_lock must not be
+ * held.
+ */
+PyObject* topology_intern_subfeature(const sensors_subfeature *subfeature)
+{
+    check_generation(current_generation());
+
+    return intern_subfeature(subfeature);
+}
+
+/**
+ * Return the chip of the cache that has name, adding it if needed.
+ */
+static TopologyChip*
+find_chip(const sensors_chip_name *name)
+{
+    sensors_chip_name chip_name;
+
+    check_generation(current_generation());
+
+    TopologyChip *chip = lookup_chip(name);
+
+    if (chip != NULL)
+    {
+        return chip;
+    }
+
+    if (copy_args(name, NULL, &chip_name, NULL) < 0)
+    {
+        return NULL;
+    }
+
+    for (;;)
+    {
+        Py_ssize_t count = 0;
+        unsigned long features_generation = 0;
+        sensors_feature *copies = copy_features(&chip_name, &count,
+                                                &features_generation);
+
+        if (copies == NULL)
+        {
+            free_args(&chip_name, NULL);
+            return NULL;
+        }
+
+        check_generation(features_generation);
+        PyObject *features = PyTuple_New(count);
+
+        for (Py_ssize_t i = 0; features != NULL && i < count; i++)
+        {
+            PyObject *feature = intern_feature(&copies[i]);
+
+            if (feature == NULL)
+            {
+                Py_CLEAR(features);
+                break;
+            }
+
+            PyTuple_SET_ITEM(features, i, feature);
+        }
+
+        for (Py_ssize_t i = 0; i < count; i++)
+        {
+            free(copies[i].name);
+        }
+
+        PyMem_Free(copies);
+
+        if (features == NULL)
+        {
+            free_args(&chip_name, NULL);
+            return NULL;
+        }
+
+        /* The features are out of date if another thread has seen a
+         * newer generation meanwhile: read them again */
+        if (features_generation != generation)
+        {
+            Py_DECREF(features);
+            continue;
+        }
+
+        free_args(&chip_name, NULL);
+
+        /* Another thread may have added it while the GIL was released */
+        chip = lookup_chip(name);
+
+        if (chip != NULL)
+        {
+            Py_DECREF(features);
+            return chip;
+        }
+
+        return add_chip(name, features);
+    }
+}
+
+static TopologyChip*
+lookup_chip(const sensors_chip_name *name)
+{
+    for (Py_ssize_t i = 0; i < chip_count; i++)
+    {
+        if (same_name(&chips[i]->name, name))
+        {
+            return chips[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Add name to the cache, with its tuple of features. Steal the
+ * reference to features.
+ */
+static TopologyChip*
+add_chip(const sensors_chip_name *name, PyObject *features)
+{
+    if (chip_count == chip_capacity)
+    {
+        Py_ssize_t capacity = chip_capacity == 0 ? 8 : chip_capacity * 2;
+        TopologyChip **new_chips = PyMem_Realloc(
+            chips, capacity * sizeof(TopologyChip*));
+
+        if (new_chips == NULL)
+        {
+            Py_DECREF(features);
+            PyErr_NoMemory();
+            return NULL;
+        }
+
+        chips = new_chips;
+        chip_capacity = capacity;
+    }
+
+    Py_ssize_t size = PyTuple_GET_SIZE(features);
+    TopologyChip *chip = PyMem_Malloc(sizeof(TopologyChip));
+    /* One block for both arrays */
+    PyObject **objects = PyMem_Malloc((2 * size + 1) * sizeof(PyObject*));
+    char *prefix = NULL;
+
+    if (name->prefix != NULL)
+    {
+        prefix = strdup(name->prefix);
+    }
+
+    if (chip == NULL || objects == NULL ||
+        (name->prefix != NULL && prefix == NULL))
+    {
+        PyMem_Free(chip);
+        PyMem_Free(objects);
+        free(prefix);
+        Py_DECREF(features);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    memset(objects, 0, (2 * size + 1) * sizeof(PyObject*));
+    memset(&chip->name, 0, sizeof(chip->name));
+    chip->name.prefix = prefix;
+    chip->name.bus = name->bus;
+    chip->name.addr = name->addr;
+    chip->features = features;
+    chip->subfeatures = objects;
+    chip->labels = objects + size;
+    chips[chip_count++] = chip;
+
+    return chip;
+}
+
+static unsigned long
+current_generation(void)
+{
+    LOCK_SENSORS();
+    unsigned long current = sensors_generation;
+    UNLOCK_SENSORS();
+
+    return current;
+}
+
+/**
+ * Drop the whole cache if libsensors was initialized again, since the
+ * cache was filled. It's never rolled back to an older generation,
+ * which a thread that waited for the lock may have read.
+ */
+static void
+check_generation(unsigned long current)
+{
+    if (current > generation)
+    {
+        clear();
+        generation = current;
+    }
+}
+
+static void
+clear(void)
+{
+    /* Detach everything first, in case a deallocation runs Python
+     * code that uses the cache */
+    TopologyChip **old_chips = chips;
+    Py_ssize_t old_count = chip_count;
+    PyObject *old_interned = interned;
+
+    chips = NULL;
+    chip_count = 0;
+    chip_capacity = 0;
+    interned = NULL;
+
+    for (Py_ssize_t i = 0; i < old_count; i++)
+    {
+        TopologyChip *chip = old_chips[i];
+        Py_ssize_t size = PyTuple_GET_SIZE(chip->features);
+
+        for (Py_ssize_t j = 0; j < size; j++)
+        {
+            Py_XDECREF(chip->subfeatures[j]);
+            Py_XDECREF(chip->labels[j]);
+        }
+
+        Py_DECREF(chip->features);
+        PyMem_Free(chip->subfeatures);
+        free(chip->name.prefix);
+        PyMem_Free(chip);
+    }
+
+    PyMem_Free(old_chips);
+    Py_XDECREF(old_interned);
+}
+
+static int
+same_name(const sensors_chip_name *a, const sensors_chip_name *b)
+{
+    if ((a->prefix == NULL) != (b->prefix == NULL) ||
+        (a->prefix != NULL && strcmp(a->prefix, b->prefix) != 0))
+    {
+        return 0;
+    }
+
+    return (a->bus.type == b->bus.type && a->bus.nr == b->bus.nr &&
+            a->addr == b->addr);
+}
+
+/**
+ * Return the index of feature in the cached features of chip, or -1 if
+ * it isn't one of them.
+ */
+static Py_ssize_t
+feature_index(TopologyChip *chip, const sensors_feature *feature)
+{
+    Py_ssize_t i = feature->number;
+
+    if (i < 0 || i >= PyTuple_GET_SIZE(chip->features))
+    {
+        return -1;
+    }
+
+    const sensors_feature *cached =
+        &((Feature*)PyTuple_GET_ITEM(chip->features, i))->feature;
+
+    if (cached->number != feature->number ||
+        cached->type != feature->type ||
+        cached->first_subfeature != feature->first_subfeature ||
+        feature->name == NULL ||
+        strcmp(cached->name, feature->name) != 0)
+    {
+        return -1;
+    }
+
+    return i;
+}
+
+/*
+ * Copy the chip name and the feature, which may be NULL, given by the
+ * caller, with their own strings: they belong to Python objects, which
+ * other threads can change while LOCK_SENSORS() waits without the GIL.
+ * Return -1 and set an exception on failure.
+ */
+static int
+copy_args(const sensors_chip_name *name, const sensors_feature *feature,
+          sensors_chip_name *name_copy, sensors_feature *feature_copy)
+{
+    if (copy_chip_name(name, name_copy) < 0)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    if (feature == NULL)
+    {
+        return 0;
+    }
+
+    *feature_copy = *feature;
+    feature_copy->name = feature->name == NULL ? NULL : strdup(feature->name);
+
+    if (feature->name != NULL && feature_copy->name == NULL)
+    {
+        free_chip_name(name_copy);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    return 0;
+}
+
+static void
+free_args(sensors_chip_name *name, sensors_feature *feature)
+{
+    free_chip_name(name);
+
+    if (feature != NULL)
+    {
+        free(feature->name);
+    }
+}
+
+/*
+ * Return a copy of the features of the chip, with their own names, and
+ * set count to their number and generation to the sensors_generation
+ * they belong to. Return NULL and set an exception on failure.
+ */
+static sensors_feature*
+copy_features(const sensors_chip_name *name, Py_ssize_t *count,
+              unsigned long *features_generation)
+{
+    const sensors_feature *feature = NULL;
+    Py_ssize_t size = 0;
+    Py_ssize_t copied = 0;
+    int n = 0;
+
+    LOCK_SENSORS();
+
+    while (sensors_get_features(name, &n) != NULL)
+    {
+        size++;
+    }
+
+    sensors_feature *copies = PyMem_Malloc((size + 1) * sizeof *copies);
+    n = 0;
+
+    while (copies != NULL && copied < size &&
+           (feature = sensors_get_features(name, &n)) != NULL)
+    {
+        copies[copied] = *feature;
+        copies[copied].name = strdup(feature->name);
+
+        if (copies[copied].name == NULL)
+        {
+            break;
+        }
+
+        copied++;
+    }
+
+    *features_generation = sensors_generation;
+    UNLOCK_SENSORS();
+
+    if (copies == NULL || copied < size)
+    {
+        for (Py_ssize_t i = 0; i < copied; i++)
+        {
+            free(copies[i].name);
+        }
+
+        PyMem_Free(copies);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    *count = size;
+
+    return copies;
+}
+
+/*
+ * Same as copy_features(), for the subfeatures of feature.
+ */
+static sensors_subfeature*
+copy_subfeatures(const sensors_chip_name *name,
+                 const sensors_feature *feature, Py_ssize_t *count,
+                 unsigned long *subfeatures_generation)
+{
+    const sensors_subfeature *subfeature = NULL;
+    Py_ssize_t size = 0;
+    Py_ssize_t copied = 0;
+    int n = 0;
+
+    LOCK_SENSORS();
+
+    while (sensors_get_all_subfeatures(name, feature, &n) != NULL)
+    {
+        size++;
+    }
+
+    sensors_subfeature *copies = PyMem_Malloc((size + 1) * sizeof *copies);
+    n = 0;
+
+    while (copies != NULL && copied < size &&
+           (subfeature = sensors_get_all_subfeatures(name, feature, &n))
+           != NULL)
+    {
+        copies[copied] = *subfeature;
+        copies[copied].name = strdup(subfeature->name);
+
+        if (copies[copied].name == NULL)
+        {
+            break;
+        }
+
+        copied++;
+    }
+
+    *subfeatures_generation = sensors_generation;
+    UNLOCK_SENSORS();
+
+    if (copies == NULL || copied < size)
+    {
+        for (Py_ssize_t i = 0; i < copied; i++)
+        {
+            free(copies[i].name);
+        }
+
+        PyMem_Free(copies);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    *count = size;
+
+    return copies;
+}
+
+/*
+ * Return a tuple of the interned subfeatures of feature, and set
+ * generation to the sensors_generation they belong to.
+ */
+static PyObject*
+enumerate_subfeatures(const sensors_chip_name *name,
+                      const sensors_feature *feature,
+                      unsigned long *subfeatures_generation)
+{
+    sensors_chip_name chip_name;
+    sensors_feature feature_copy;
+    Py_ssize_t count = 0;
+
+    if (copy_args(name, feature, &chip_name, &feature_copy) < 0)
+    {
+        return NULL;
+    }
+
+    sensors_subfeature *copies = copy_subfeatures(
+        &chip_name, &feature_copy, &count, subfeatures_generation);
+
+    free_args(&chip_name, &feature_copy);
+
+    if (copies == NULL)
+    {
+        return NULL;
+    }
+
+    check_generation(*subfeatures_generation);
+    PyObject *subfeatures = PyTuple_New(count);
+
+    for (Py_ssize_t i = 0; subfeatures != NULL && i < count; i++)
+    {
+        PyObject *subfeature = intern_subfeature(&copies[i]);
+
+        if (subfeature == NULL)
+        {
+            Py_CLEAR(subfeatures);
+            break;
+        }
+
+        PyTuple_SET_ITEM(subfeatures, i, subfeature);
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        free(copies[i].name);
+    }
+
+    PyMem_Free(copies);
+
+    return subfeatures;
+}
+
+static PyObject*
+intern_feature(const sensors_feature *feature)
+{
+    PyObject *key = Py_BuildValue("(siii)", feature->name, feature->number,
+                                  feature->type, feature->first_subfeature);
+
+    if (key == NULL)
+    {
+        return NULL;
+    }
+
+    PyObject *py_feature = find_interned(key);
+
+    if (py_feature != NULL || PyErr_Occurred())
+    {
+        Py_DECREF(key);
+        return py_feature;
+    }
+
+    PyObject *name = PyString_InternFromString(feature->name);
+    Feature *new = name == NULL ? NULL : feature_new(feature, name);
+
+    Py_XDECREF(name);
+
+    if (new == NULL)
+    {
+        Py_DECREF(key);
+        return NULL;
+    }
+
+    new->interned = 1;
+
+    return add_interned(key, (PyObject*)new);
+}
+
+static PyObject*
+intern_subfeature(const sensors_subfeature *subfeature)
+{
+    PyObject *key = Py_BuildValue("(siiiI)", subfeature->name,
+                                  subfeature->number, subfeature->type,
+                                  subfeature->mapping, subfeature->flags);
+
+    if (key == NULL)
+    {
+        return NULL;
+    }
+
+    PyObject *py_subfeature = find_interned(key);
+
+    if (py_subfeature != NULL || PyErr_Occurred())
+    {
+        Py_DECREF(key);
+        return py_subfeature;
+    }
+
+    PyObject *name = PyString_InternFromString(subfeature->name);
+    Subfeature *new = name == NULL ? NULL : subfeature_new(subfeature, name);
+
+    Py_XDECREF(name);
+
+    if (new == NULL)
+    {
+        Py_DECREF(key);
+        return NULL;
+    }
+
+    new->interned = 1;
+
+    return add_interned(key, (PyObject*)new);
+}
+
+/**
+ * Return a new reference to the interned object for key, or NULL if
+ * there isn't one yet, which isn't an error unless an exception is set.
+ */
+static PyObject*
+find_interned(PyObject *key)
+{
+    if (interned == NULL)
+    {
+        return NULL;
+    }
+
+    PyObject *object = PyDict_GetItem(interned, key);
+
+    Py_XINCREF(object);
+
+    return object;
+}
+
+/**
+ * Intern object under key. Steal both references, and return a new
+ * reference to object.
+ */
+static PyObject*
+add_interned(PyObject *key, PyObject *object)
+{
+    if (interned == NULL)
+    {
+        interned = PyDict_New();
+    }
+
+    if (interned == NULL || PyDict_SetItem(interned, key, object) < 0)
+    {
+        Py_DECREF(key);
+        Py_DECREF(object);
+        return NULL;
+    }
+
+    Py_DECREF(key);
+
+    return object;
+}
+
+static PyObject*
+read_label(const sensors_chip_name *name, const sensors_feature *feature,
+           unsigned long *label_generation)
+{
+    sensors_chip_name chip_name;
+    sensors_feature feature_copy;
+    char *label = NULL;
+
+    if (copy_args(name, feature, &chip_name, &feature_copy) < 0)
+    {
+        return NULL;
+    }
+
+    BEGIN_SENSORS_IO
+    label = sensors_get_label(&chip_name, &feature_copy);
+    *label_generation = sensors_generation;
+    END_SENSORS_IO
+
+    free_args(&chip_name, &feature_copy);
+
+    if (label == NULL)
+    {
+        PyErr_SetString(SensorsException,
+                        "sensors_get_label() returned NULL");
+        return NULL;
+    }
+
+    PyObject *py_label = PyString_FromString(label);
+    free(label);
+
+    return py_label;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef H_TOPOLOGY
+#define H_TOPOLOGY
+
+#include <Python.h>
+
+#include <sensors/sensors.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Cache of the features, subfeatures and labels of the chips, as the
+ * Python objects returned by ChipName.  The topology only changes when
+ * libsensors is initialized again, so the cache is dropped when
+ * sensors_generation changes.  It's protected by the GIL.  The
+ * functions must be called without sensors_lock: they only take it to
+ * copy what libsensors has, and create the objects after releasing it.
+ *
+ * The Feature and Subfeature objects are interned: equal ones are the
+ * same object, even across chips, and they are read-only.
+ */
+PyObject* topology_get_features(const sensors_chip_name*);
+PyObject* topology_get_subfeatures(const sensors_chip_name*,
+                                   const sensors_feature*);
+PyObject* topology_get_subfeature(const sensors_chip_name*,
+                                  const sensors_feature*, int);
+PyObject* topology_get_label(const sensors_chip_name*,
+                             const sensors_feature*);
+PyObject* topology_intern_subfeature(const sensors_subfeature*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,445 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Batched reads with io_uring: a whole set of sysfs attributes is read
+ * with one io_uring_enter() call instead of one pread() per attribute.
+ * liburing isn't required; the ring is set up with the raw system
+ * calls.  Each thread gets its own ring, created the first time it
+ * reads, so that the threads of a parallel read don't contend.  When
+ * io_uring isn't available (old kernel or headers, or forbidden by a
+ * seccomp filter), uring_read() fails and the caller uses pread().
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+
+#include "uring.h"
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING
+#endif
+#endif
+
+#ifdef HAVE_IO_URING
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <linux/io_uring.h>
+
+#define RING_ENTRIES 64
+/* Failed io_uring_enter() calls without a completion before the reads
+ * in flight are cancelled, since they are made while holding
+ * sensors_lock */
+#define MAX_ERRORS 100
+/* Set in the user_data of the cancellations, to tell their completions
+ * from those of the reads */
+#define CANCEL_TAG (1ULL << 63)
+
+
+typedef struct
+{
+    int fd;
+    unsigned long fork_generation;
+    unsigned int entries;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    struct iovec iovecs[RING_ENTRIES];
+} Ring;
+
+
+static Ring* get_ring(void);
+static Ring* create_ring(void);
+static void destroy_ring(void*);
+static int submit_and_wait(Ring*, UringRead*, unsigned int);
+static unsigned int cancel_reads(Ring*, unsigned int*, const unsigned char*,
+                                 unsigned int);
+static void init_key(void);
+static void after_fork(void);
+
+
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t ring_key;
+/* Set when a ring couldn't be created; io_uring isn't tried again */
+static int unavailable = 0;
+/* Incremented in the child after fork(), since it shares the rings
+ * of its parent */
+static unsigned long fork_generation = 0;
+
+
+/**
+ * Read each file of reads at offset 0 into its buffer, and set its
+ * result. Return -1 if io_uring can't be used, in which case no result
+ * is set.
+ */
+int uring_read(UringRead *reads, int count)
+{
+    Ring *ring = get_ring();
+
+    if (ring == NULL)
+    {
+        return -1;
+    }
+
+    for (int done = 0; done < count; )
+    {
+        unsigned int n = (unsigned int)(count - done);
+
+        if (n > ring->entries)
+        {
+            n = ring->entries;
+        }
+
+        if (submit_and_wait(ring, reads + done, n) < 0)
+        {
+            /* The results are set for the previous chunks, but not
+             * all of them for this one: start over with pread() */
+            destroy_ring(ring);
+            pthread_setspecific(ring_key, NULL);
+            __atomic_store_n(&unavailable, 1, __ATOMIC_RELAXED);
+            return -1;
+        }
+
+        done += n;
+    }
+
+    return 0;
+}
+
+/*
+ * Submit the n reads, which fit in the ring, and wait for all of them
+ * to complete. Return -1 if nothing could be submitted, or if the
+ * reads had to be given up; in that case, the function still returns
+ * only once every read that was submitted has completed, since the
+ * kernel writes to the buffers until then.
+ */
+static int
+submit_and_wait(Ring *ring, UringRead *reads, unsigned int n)
+{
+    unsigned int tail = *ring->sq_tail;
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+        unsigned int index = (tail + i) & *ring->sq_mask;
+        struct io_uring_sqe *sqe = &ring->sqes[index];
+
+        ring->iovecs[index].iov_base = reads[i].buffer;
+        ring->iovecs[index].iov_len = reads[i].size;
+
+        /* READV rather than READ, which needs Linux 5.6 */
+        memset(sqe, 0, sizeof *sqe);
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = reads[i].fd;
+        sqe->addr = (unsigned long)&ring->iovecs[index];
+        sqe->len = 1;
+        sqe->off = 0;
+        sqe->user_data = i;
+        ring->sq_array[index] = index;
+    }
+
+    tail += n;
+    __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+    unsigned char done[RING_ENTRIES] = {0};
+    unsigned int to_submit = n;
+    unsigned int expected = n;
+    unsigned int completed = 0;
+    int errors = 0;
+    int cancelled = 0;
+
+    while (completed < expected)
+    {
+        long ret = syscall(__NR_io_uring_enter, ring->fd, to_submit,
+                           expected - completed, IORING_ENTER_GETEVENTS,
+                           NULL, 0);
+
+        if (ret < 0)
+        {
+            int transient = errno == EINTR || errno == EAGAIN ||
+                errno == EBUSY;
+
+            errors++;
+
+            /* Nothing is in flight yet, so giving up is safe */
+            if (!cancelled && expected == n && to_submit == n &&
+                (!transient || errors > MAX_ERRORS))
+            {
+                return -1;
+            }
+
+            if (!transient && !cancelled && to_submit > 0)
+            {
+                /* Take back the reads that weren't submitted, and wait
+                 * for the others */
+                tail -= to_submit;
+                __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+                expected -= to_submit;
+                to_submit = 0;
+            }
+
+            if (errors > MAX_ERRORS && !cancelled)
+            {
+                to_submit = cancel_reads(ring, &tail, done, expected);
+                cancelled = 1;
+            }
+        }
+        else
+        {
+            to_submit -= (unsigned int)ret < to_submit ?
+                (unsigned int)ret : to_submit;
+        }
+
+        /* Reap even after an error, since EBUSY means the completion
+         * queue is full */
+        unsigned int head = *ring->cq_head;
+        unsigned int cq_tail = __atomic_load_n(ring->cq_tail,
+                                               __ATOMIC_ACQUIRE);
+
+        while (head != cq_tail)
+        {
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+
+            if (!(cqe->user_data & CANCEL_TAG))
+            {
+                reads[cqe->user_data].result = cqe->res;
+                done[cqe->user_data] = 1;
+                completed++;
+                errors = 0;
+            }
+
+            head++;
+        }
+
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    return expected == n && !cancelled ? 0 : -1;
+}
+
+/*
+ * Queue a cancellation for each of the first count reads that hasn't
+ * completed, after *tail, and return the number queued. Their
+ * completions are tagged with CANCEL_TAG.
+ */
+static unsigned int
+cancel_reads(Ring *ring, unsigned int *tail, const unsigned char *done,
+             unsigned int count)
+{
+    unsigned int queued = 0;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (done[i])
+        {
+            continue;
+        }
+
+        unsigned int index = (*tail + queued) & *ring->sq_mask;
+        struct io_uring_sqe *sqe = &ring->sqes[index];
+
+        memset(sqe, 0, sizeof *sqe);
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = i;
+        sqe->user_data = CANCEL_TAG | i;
+        ring->sq_array[index] = index;
+        queued++;
+    }
+
+    *tail += queued;
+    __atomic_store_n(ring->sq_tail, *tail, __ATOMIC_RELEASE);
+
+    return queued;
+}
+
+static Ring*
+get_ring(void)
+{
+    if (__atomic_load_n(&unavailable, __ATOMIC_RELAXED))
+    {
+        return NULL;
+    }
+
+    pthread_once(&key_once, init_key);
+
+    Ring *ring = pthread_getspecific(ring_key);
+
+    if (ring != NULL && ring->fork_generation != fork_generation)
+    {
+        destroy_ring(ring);
+        ring = NULL;
+    }
+
+    if (ring == NULL)
+    {
+        ring = create_ring();
+
+        if (ring == NULL)
+        {
+            __atomic_store_n(&unavailable, 1, __ATOMIC_RELAXED);
+        }
+
+        pthread_setspecific(ring_key, ring);
+    }
+
+    return ring;
+}
+
+static Ring*
+create_ring(void)
+{
+    struct io_uring_params params;
+    Ring *ring = calloc(1, sizeof *ring);
+
+    if (ring == NULL)
+    {
+        return NULL;
+    }
+
+    memset(&params, 0, sizeof params);
+    ring->fork_generation = fork_generation;
+    ring->sq_ring = MAP_FAILED;
+    ring->cq_ring = MAP_FAILED;
+    ring->sqes = MAP_FAILED;
+    ring->fd = (int)syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+
+    if (ring->fd < 0)
+    {
+        free(ring);
+        return NULL;
+    }
+
+    ring->entries = params.sq_entries < RING_ENTRIES ?
+        params.sq_entries : RING_ENTRIES;
+    ring->sq_ring_size = params.sq_off.array +
+        params.sq_entries * sizeof(unsigned int);
+    ring->cq_ring_size = params.cq_off.cqes +
+        params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->fd,
+                         IORING_OFF_SQ_RING);
+    ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->fd,
+                         IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+
+    if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED ||
+        ring->sqes == MAP_FAILED)
+    {
+        destroy_ring(ring);
+        return NULL;
+    }
+
+    char *sq = ring->sq_ring;
+    char *cq = ring->cq_ring;
+
+    ring->sq_tail = (unsigned int*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned int*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned int*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned int*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned int*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    return ring;
+}
+
+static void
+destroy_ring(void *arg)
+{
+    Ring *ring = arg;
+
+    if (ring->sq_ring != MAP_FAILED)
+    {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+
+    if (ring->cq_ring != MAP_FAILED)
+    {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+
+    if (ring->sqes != MAP_FAILED)
+    {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+
+    close(ring->fd);
+    free(ring);
+}
+
+static void
+init_key(void)
+{
+    pthread_key_create(&ring_key, destroy_ring);
+    pthread_atfork(NULL, NULL, after_fork);
+}
+
+static void
+after_fork(void)
+{
+    fork_generation++;
+}
+
+#else
+
+int uring_read(UringRead *reads, int count)
+{
+    (void)reads;
+    (void)count;
+
+    return -1;
+}
+
+#endif
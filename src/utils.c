@@ -1,6 +1,11 @@
 #include <Python.h>
 
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "sensorsmodule.h"
+#include "utils.h"
 
 
 /**
@@ -30,3 +35,224 @@ char* pystrdup(PyObject *str)
     return strdup(ret);
 #endif
 }
+
+/**
+ * Return the content of a Python string as UTF-8. The buffer belongs to
+ * the string, and is valid as long as it is. NULL is returned if a
+ * Python function raised an exception.
+ */
+char* pystr(PyObject *str)
+{
+#ifndef IS_PY3K
+    return PyString_AsString(str);
+#else
+    return (char*)PyUnicode_AsUTF8(str);
+#endif
+}
+
+/**
+ * Convert a subfeature number, which must fit in an int, as with the
+ * "i" format of PyArg_ParseTuple(). Return -1 and set an exception on
+ * failure.
+ */
+int parse_subfeature_number(PyObject *py_number, int *number)
+{
+    long value = PyLong_AsLong(py_number);
+
+    if (value == -1 && PyErr_Occurred())
+    {
+        return -1;
+    }
+
+    if (value < INT_MIN || value > INT_MAX)
+    {
+        PyErr_SetString(PyExc_OverflowError,
+                        value < INT_MIN ?
+                        "signed integer is less than minimum" :
+                        "signed integer is greater than maximum");
+        return -1;
+    }
+
+    *number = (int)value;
+
+    return 0;
+}
+
+/**
+ * Return 1 if the chip name contains wildcard values, like
+ * sensors_chip_name_has_wildcards() does inside libsensors.
+ */
+int chip_name_has_wildcards(const sensors_chip_name *name)
+{
+    return (name->prefix == NULL ||
+            name->bus.type == SENSORS_BUS_TYPE_ANY ||
+            name->bus.nr == SENSORS_BUS_NR_ANY ||
+            name->addr == SENSORS_CHIP_NAME_ADDR_ANY);
+}
+
+/**
+ * Copy name to copy, with its own strings, so that it can be used
+ * after sensors_lock is released, or while the GIL is released. Return
+ * -1 if memory couldn't be allocated. The copy is freed with
+ * free_chip_name().
+ */
+int copy_chip_name(const sensors_chip_name *name, sensors_chip_name *copy)
+{
+    *copy = *name;
+    copy->prefix = name->prefix == NULL ? NULL : strdup(name->prefix);
+    copy->path = name->path == NULL ? NULL : strdup(name->path);
+
+    if ((name->prefix != NULL && copy->prefix == NULL) ||
+        (name->path != NULL && copy->path == NULL))
+    {
+        free_chip_name(copy);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Free the strings of a chip name filled by copy_chip_name().
+ */
+void free_chip_name(sensors_chip_name *name)
+{
+    free(name->prefix);
+    free(name->path);
+    name->prefix = NULL;
+    name->path = NULL;
+}
+
+/**
+ * Return the detected chip matching name, as stored by libsensors, or
+ * NULL if there is none. The returned pointer becomes invalid when
+ * libsensors is cleaned up.
+ */
+const sensors_chip_name* resolve_chip(const sensors_chip_name *name)
+{
+    int nr = 0;
+
+    return sensors_get_detected_chips(name, &nr);
+}
+
+/**
+ * Return the subfeature of chip whose number is number, or NULL if it
+ * doesn't exist.
+ */
+const sensors_subfeature* find_subfeature(const sensors_chip_name *chip,
+                                          int number)
+{
+    const sensors_feature *feature = NULL;
+    int feature_nr = 0;
+
+    while ((feature = sensors_get_features(chip, &feature_nr)) != NULL)
+    {
+        const sensors_subfeature *subfeature = NULL;
+        int subfeature_nr = 0;
+
+        while ((subfeature = sensors_get_all_subfeatures(
+                    chip, feature, &subfeature_nr)) != NULL)
+        {
+            if (subfeature->number == number)
+            {
+                return subfeature;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Number the buses of the count chips, in order of first appearance:
+ * groups[i] is set to the number of the bus of chips[i]. Return the
+ * number of distinct buses.
+ */
+int group_by_bus(const sensors_chip_name **chips, int count, int *groups)
+{
+    int group_count = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        int j = 0;
+
+        for (j = 0; j < i; j++)
+        {
+            if (chips[i]->bus.type == chips[j]->bus.type &&
+                chips[i]->bus.nr == chips[j]->bus.nr)
+            {
+                break;
+            }
+        }
+
+        groups[i] = j < i ? groups[j] : group_count++;
+    }
+
+    return group_count;
+}
+
+/**
+ * Return the time of clock in nanoseconds.
+ */
+int64_t clock_ns(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Convert a time argument, which is a CLOCK_MONOTONIC time in
+ * nanoseconds, or None for now. Return -1 and set an exception on
+ * failure.
+ */
+int parse_monotonic_time(PyObject *py_time, int64_t *time)
+{
+    if (py_time == Py_None)
+    {
+        *time = clock_ns(CLOCK_MONOTONIC);
+        return 0;
+    }
+
+    long long value = PyLong_AsLongLong(py_time);
+
+    if (value == -1 && PyErr_Occurred())
+    {
+        return -1;
+    }
+
+    *time = value;
+
+    return 0;
+}
+
+/**
+ * Call the function name of the sensors_async module, which holds the
+ * asyncio wrappers, with args and kwargs.
+ */
+PyObject* call_async(const char *name, PyObject *args, PyObject *kwargs)
+{
+    PyObject *module = PyImport_ImportModule("sensors_async");
+
+    if (module == NULL)
+    {
+        return NULL;
+    }
+
+    PyObject *func = PyObject_GetAttrString(module, name);
+
+    Py_DECREF(module);
+
+    if (func == NULL)
+    {
+        return NULL;
+    }
+
+    PyObject *result = PyObject_Call(func, args, kwargs);
+
+    Py_DECREF(func);
+
+    return result;
+}
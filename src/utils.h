@@ -1,6 +1,22 @@
 #ifndef H_UTILS
 #define H_UTILS
 
+#include <stdint.h>
+#include <time.h>
+
+#include <sensors/sensors.h>
+
 char* pystrdup(PyObject*);
+char* pystr(PyObject*);
+int parse_subfeature_number(PyObject*, int*);
+int chip_name_has_wildcards(const sensors_chip_name*);
+int copy_chip_name(const sensors_chip_name*, sensors_chip_name*);
+void free_chip_name(sensors_chip_name*);
+const sensors_chip_name* resolve_chip(const sensors_chip_name*);
+const sensors_subfeature* find_subfeature(const sensors_chip_name*, int);
+int group_by_bus(const sensors_chip_name**, int, int*);
+int64_t clock_ns(clockid_t);
+int parse_monotonic_time(PyObject*, int64_t*);
+PyObject* call_async(const char*, PyObject*, PyObject*);
 
 #endif
@@ -0,0 +1,770 @@
+/*
+ * Copyright 2026 Bastien Léonard. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BASTIEN LÉONARD ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL BASTIEN LÉONARD OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * A fake libsensors for the tests and the benchmarks.  It implements
+ * the part of the libsensors API that the module uses, with no I/O,
+ * so that the cost of the binding itself can be measured, and slow or
+ * failing hardware can be reproduced anywhere.  It is compiled into
+ * the module instead of linking with libsensors by:
+ *
+ *     python setup.py build_ext --shim --force
+ *
+ * sensors_init() reads its configuration from the SENSORS_SHIM
+ * environment variable, a list of settings separated by spaces or
+ * commas:
+ *
+ *     chips=N          number of chips (4 by default)
+ *     latency=US       time taken by each read, in microseconds
+ *     jitter=US        random time added to each read, up to US
+ *     error=NAME:P     fail reads with probability P, where NAME is
+ *                      kernel (SENSORS_ERR_KERNEL) or access
+ *                      (SENSORS_ERR_ACCESS_R); P is 1 by default
+ *     hang=P           never return from reads, with probability P
+ *     seed=N           seed of the random draws
+ *
+ * latency, jitter, error and hang apply to every chip; suffix them
+ * with .I to only change chip I, as in latency.2=5000.  Calling
+ * sensors.init() after changing the variable reloads it.
+ *
+ * The chips are called shim-isa-0000, shim-isa-0001, etc.  They have
+ * no sysfs path, so the fast read path always falls back on
+ * sensors_get_value().
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sensors/sensors.h>
+#include <sensors/error.h>
+
+#define DEFAULT_CHIP_COUNT 4
+#define MAX_CHIP_COUNT 100000
+#define PREFIX "shim"
+#define SETTINGS_VARIABLE "SENSORS_SHIM"
+#define SUBFEATURE_COUNT 13
+#define FEATURE_COUNT ((int)(sizeof features / sizeof features[0]))
+#define R SENSORS_MODE_R
+#define RW (SENSORS_MODE_R | SENSORS_MODE_W)
+
+
+typedef struct
+{
+    long latency;
+    long jitter;
+    int error;
+    double error_rate;
+    double hang_rate;
+} Behavior;
+
+typedef struct
+{
+    sensors_chip_name name;
+    Behavior behavior;
+    double values[SUBFEATURE_COUNT];
+} Chip;
+
+
+static int parse_settings(const char*);
+static int parse_setting(const char*, const char*);
+static int parse_long(const char*, long*);
+static int parse_rate(const char*, double*);
+static Chip* find_chip(const sensors_chip_name*, int*);
+static int matches(const sensors_chip_name*, const sensors_chip_name*);
+static int has_wildcards(const sensors_chip_name*);
+static double draw(void);
+static void wait_us(long);
+
+const char *libsensors_version = "shim";
+void (*sensors_parse_error)(const char*, int) = NULL;
+void (*sensors_parse_error_wfn)(const char*, const char*, int) = NULL;
+void (*sensors_fatal_error)(const char*, const char*) = NULL;
+
+/* Every chip has the same features */
+static const sensors_feature features[] = {
+    {"temp1", 0, SENSORS_FEATURE_TEMP, 0, 0},
+    {"fan1", 1, SENSORS_FEATURE_FAN, 5, 0},
+    {"in0", 2, SENSORS_FEATURE_IN, 8, 0},
+    {"power1", 3, SENSORS_FEATURE_POWER, 12, 0}
+};
+
+static const sensors_subfeature subfeatures[SUBFEATURE_COUNT] = {
+    {"temp1_input", 0, SENSORS_SUBFEATURE_TEMP_INPUT, 0, R},
+    {"temp1_max", 1, SENSORS_SUBFEATURE_TEMP_MAX, 0, RW},
+    {"temp1_max_hyst", 2, SENSORS_SUBFEATURE_TEMP_MAX_HYST, 0, RW},
+    {"temp1_crit", 3, SENSORS_SUBFEATURE_TEMP_CRIT, 0, R},
+    {"temp1_alarm", 4, SENSORS_SUBFEATURE_TEMP_ALARM, 0, R},
+    {"fan1_input", 5, SENSORS_SUBFEATURE_FAN_INPUT, 1, R},
+    {"fan1_min", 6, SENSORS_SUBFEATURE_FAN_MIN, 1, RW},
+    {"fan1_alarm", 7, SENSORS_SUBFEATURE_FAN_ALARM, 1, R},
+    {"in0_input", 8, SENSORS_SUBFEATURE_IN_INPUT, 2, R},
+    {"in0_min", 9, SENSORS_SUBFEATURE_IN_MIN, 2, RW},
+    {"in0_max", 10, SENSORS_SUBFEATURE_IN_MAX, 2, RW},
+    {"in0_alarm", 11, SENSORS_SUBFEATURE_IN_ALARM, 2, R},
+    {"power1_input", 12, SENSORS_SUBFEATURE_POWER_INPUT, 3, R}
+};
+
+static const double initial_values[SUBFEATURE_COUNT] = {
+    40.0, 80.0, 75.0, 100.0, 0.0,
+    1200.0, 300.0, 0.0,
+    1.2, 1.0, 1.4, 0.0,
+    15.5
+};
+
+static Chip *chips = NULL;
+static int chip_count = 0;
+static uint64_t seed = 0;
+static uint64_t draws = 0;
+
+
+int
+sensors_init(FILE *input)
+{
+    (void)input;
+    sensors_cleanup();
+    seed = 0;
+    draws = 0;
+    chip_count = DEFAULT_CHIP_COUNT;
+
+    const char *settings = getenv(SETTINGS_VARIABLE);
+    Behavior behavior = {0, 0, 0, 0.0, 0.0};
+
+    /* The chip count is needed before the per-chip settings */
+    if (settings != NULL && parse_settings(settings) < 0)
+    {
+        chip_count = 0;
+        return -SENSORS_ERR_PARSE;
+    }
+
+    chips = calloc(chip_count, sizeof *chips);
+
+    if (chips == NULL)
+    {
+        chip_count = 0;
+        return -SENSORS_ERR_IO;
+    }
+
+    for (int i = 0; i < chip_count; i++)
+    {
+        Chip *chip = &chips[i];
+
+        chip->name.prefix = PREFIX;
+        chip->name.bus.type = SENSORS_BUS_TYPE_ISA;
+        chip->name.bus.nr = 0;
+        chip->name.addr = i;
+        chip->name.path = NULL;
+        chip->behavior = behavior;
+        memcpy(chip->values, initial_values, sizeof chip->values);
+        chip->values[0] += i % 40;
+        chip->values[5] += i;
+    }
+
+    if (settings != NULL && parse_settings(settings) < 0)
+    {
+        sensors_cleanup();
+        return -SENSORS_ERR_PARSE;
+    }
+
+    return 0;
+}
+
+void
+sensors_cleanup(void)
+{
+    free(chips);
+    chips = NULL;
+    chip_count = 0;
+}
+
+int
+sensors_parse_chip_name(const char *orig_name, sensors_chip_name *res)
+{
+    const char *dash = strchr(orig_name, '-');
+    size_t prefix_length = dash == NULL ?
+        strlen(orig_name) : (size_t)(dash - orig_name);
+
+    res->bus.type = SENSORS_BUS_TYPE_ANY;
+    res->bus.nr = SENSORS_BUS_NR_ANY;
+    res->addr = SENSORS_CHIP_NAME_ADDR_ANY;
+    res->path = NULL;
+
+    if (dash != NULL && strcmp(dash, "-*") != 0)
+    {
+        const char *address = dash + 1;
+
+        if (strncmp(address, "isa-", 4) != 0)
+        {
+            return -SENSORS_ERR_CHIP_NAME;
+        }
+
+        address += 4;
+        res->bus.type = SENSORS_BUS_TYPE_ISA;
+        res->bus.nr = 0;
+
+        if (strcmp(address, "*") != 0)
+        {
+            char *end;
+
+            errno = 0;
+            long addr = strtol(address, &end, 16);
+
+            if (*address == '\0' || *end != '\0' || errno != 0 ||
+                addr < 0 || addr > 0xFFFF)
+            {
+                return -SENSORS_ERR_CHIP_NAME;
+            }
+
+            res->addr = (int)addr;
+        }
+    }
+
+    if (prefix_length == 1 && orig_name[0] == '*')
+    {
+        res->prefix = SENSORS_CHIP_NAME_PREFIX_ANY;
+        return 0;
+    }
+
+    res->prefix = strndup(orig_name, prefix_length);
+
+    return res->prefix == NULL ? -SENSORS_ERR_IO : 0;
+}
+
+void
+sensors_free_chip_name(sensors_chip_name *chip)
+{
+    free(chip->prefix);
+}
+
+int
+sensors_snprintf_chip_name(char *str, size_t size,
+                           const sensors_chip_name *chip)
+{
+    if (has_wildcards(chip))
+    {
+        return -SENSORS_ERR_WILDCARDS;
+    }
+
+    if (chip->bus.type != SENSORS_BUS_TYPE_ISA)
+    {
+        return -SENSORS_ERR_CHIP_NAME;
+    }
+
+    return snprintf(str, size, "%s-isa-%04x", chip->prefix, chip->addr);
+}
+
+const char*
+sensors_get_adapter_name(const sensors_bus_id *bus)
+{
+    return bus->type == SENSORS_BUS_TYPE_ISA ? "ISA adapter" : NULL;
+}
+
+char*
+sensors_get_label(const sensors_chip_name *name,
+                  const sensors_feature *feature)
+{
+    int status;
+
+    if (find_chip(name, &status) == NULL)
+    {
+        return NULL;
+    }
+
+    return strdup(feature->name);
+}
+
+int
+sensors_get_value(const sensors_chip_name *name, int subfeat_nr,
+                  double *value)
+{
+    int status;
+    Chip *chip = find_chip(name, &status);
+
+    if (chip == NULL)
+    {
+        return status;
+    }
+
+    if (subfeat_nr < 0 || subfeat_nr >= SUBFEATURE_COUNT)
+    {
+        return -SENSORS_ERR_NO_ENTRY;
+    }
+
+    const Behavior *behavior = &chip->behavior;
+
+    if (behavior->hang_rate > 0.0 && draw() < behavior->hang_rate)
+    {
+        for (;;)
+        {
+            pause();
+        }
+    }
+
+    long latency = behavior->latency;
+
+    if (behavior->jitter > 0)
+    {
+        latency += (long)(draw() * (behavior->jitter + 1));
+    }
+
+    wait_us(latency);
+
+    if (behavior->error != 0 && draw() < behavior->error_rate)
+    {
+        return -behavior->error;
+    }
+
+    *value = chip->values[subfeat_nr];
+
+    return 0;
+}
+
+int
+sensors_set_value(const sensors_chip_name *name, int subfeat_nr,
+                  double value)
+{
+    int status;
+    Chip *chip = find_chip(name, &status);
+
+    if (chip == NULL)
+    {
+        return status;
+    }
+
+    if (subfeat_nr < 0 || subfeat_nr >= SUBFEATURE_COUNT)
+    {
+        return -SENSORS_ERR_NO_ENTRY;
+    }
+
+    if (!(subfeatures[subfeat_nr].flags & SENSORS_MODE_W))
+    {
+        return -SENSORS_ERR_ACCESS_W;
+    }
+
+    wait_us(chip->behavior.latency);
+    chip->values[subfeat_nr] = value;
+
+    return 0;
+}
+
+int
+sensors_do_chip_sets(const sensors_chip_name *name)
+{
+    int status;
+
+    return find_chip(name, &status) == NULL ? status : 0;
+}
+
+const sensors_chip_name*
+sensors_get_detected_chips(const sensors_chip_name *match, int *nr)
+{
+    while (*nr >= 0 && *nr < chip_count)
+    {
+        const sensors_chip_name *name = &chips[(*nr)++].name;
+
+        if (match == NULL || matches(match, name))
+        {
+            return name;
+        }
+    }
+
+    return NULL;
+}
+
+const sensors_feature*
+sensors_get_features(const sensors_chip_name *name, int *nr)
+{
+    int status;
+
+    if (find_chip(name, &status) == NULL || *nr < 0 || *nr >= FEATURE_COUNT)
+    {
+        return NULL;
+    }
+
+    return &features[(*nr)++];
+}
+
+const sensors_subfeature*
+sensors_get_all_subfeatures(const sensors_chip_name *name,
+                            const sensors_feature *feature, int *nr)
+{
+    int status;
+
+    if (find_chip(name, &status) == NULL || *nr < 0)
+    {
+        return NULL;
+    }
+
+    int i = feature->first_subfeature + *nr;
+
+    if (i >= SUBFEATURE_COUNT || subfeatures[i].mapping != feature->number)
+    {
+        return NULL;
+    }
+
+    (*nr)++;
+
+    return &subfeatures[i];
+}
+
+const sensors_subfeature*
+sensors_get_subfeature(const sensors_chip_name *name,
+                       const sensors_feature *feature,
+                       sensors_subfeature_type type)
+{
+    int status;
+
+    if (find_chip(name, &status) == NULL)
+    {
+        return NULL;
+    }
+
+    for (int i = feature->first_subfeature;
+         i < SUBFEATURE_COUNT && subfeatures[i].mapping == feature->number;
+         i++)
+    {
+        if (subfeatures[i].type == type)
+        {
+            return &subfeatures[i];
+        }
+    }
+
+    return NULL;
+}
+
+const char*
+sensors_strerror(int errnum)
+{
+    static const char *messages[] = {
+        "Unknown error",
+        "Wildcard found in chip name",
+        "No such subfeature known",
+        "Can't read",
+        "Kernel interface error",
+        "Divide by zero",
+        "Can't parse chip name",
+        "Can't parse bus name",
+        "General parse error",
+        "Can't write",
+        "I/O error",
+        "Evaluation recurses too deep"
+    };
+
+    if (errnum < 0)
+    {
+        errnum = -errnum;
+    }
+
+    if (errnum >= (int)(sizeof messages / sizeof messages[0]))
+    {
+        errnum = 0;
+    }
+
+    return messages[errnum];
+}
+
+/*
+ * Apply the settings, or only the chip count if the chips aren't
+ * allocated yet.
+ */
+static int
+parse_settings(const char *settings)
+{
+    char *copy = strdup(settings);
+
+    if (copy == NULL)
+    {
+        return -1;
+    }
+
+    int status = 0;
+    char *saveptr;
+
+    for (char *setting = strtok_r(copy, " ,", &saveptr);
+         setting != NULL && status == 0;
+         setting = strtok_r(NULL, " ,", &saveptr))
+    {
+        char *value = strchr(setting, '=');
+
+        if (value == NULL)
+        {
+            status = -1;
+            break;
+        }
+
+        *value++ = '\0';
+        status = parse_setting(setting, value);
+    }
+
+    free(copy);
+
+    return status;
+}
+
+static int
+parse_setting(const char *key, const char *value)
+{
+    long number;
+
+    if (strcmp(key, "chips") == 0)
+    {
+        if (parse_long(value, &number) < 0 || number > MAX_CHIP_COUNT)
+        {
+            return -1;
+        }
+
+        chip_count = (int)number;
+        return 0;
+    }
+
+    if (strcmp(key, "seed") == 0)
+    {
+        if (parse_long(value, &number) < 0)
+        {
+            return -1;
+        }
+
+        seed = (uint64_t)number;
+        return 0;
+    }
+
+    int first = 0;
+    int last = chip_count - 1;
+    const char *dot = strchr(key, '.');
+    size_t key_length = dot == NULL ? strlen(key) : (size_t)(dot - key);
+
+    if (dot != NULL)
+    {
+        /* The chip count may come later, during the first pass */
+        if (parse_long(dot + 1, &number) < 0 ||
+            (chips != NULL && number >= chip_count))
+        {
+            return -1;
+        }
+
+        first = last = (int)number;
+    }
+
+    Behavior behavior = {0, 0, 0, 1.0, 0.0};
+    enum {LATENCY, JITTER, ERROR, HANG} field;
+
+    if (strncmp(key, "latency", key_length) == 0 && key_length == 7)
+    {
+        field = LATENCY;
+
+        if (parse_long(value, &behavior.latency) < 0)
+        {
+            return -1;
+        }
+    }
+    else if (strncmp(key, "jitter", key_length) == 0 && key_length == 6)
+    {
+        field = JITTER;
+
+        if (parse_long(value, &behavior.jitter) < 0)
+        {
+            return -1;
+        }
+    }
+    else if (strncmp(key, "error", key_length) == 0 && key_length == 5)
+    {
+        const char *colon = strchr(value, ':');
+        size_t name_length = colon == NULL ?
+            strlen(value) : (size_t)(colon - value);
+
+        field = ERROR;
+
+        if (strncmp(value, "kernel", name_length) == 0 &&
+            name_length == 6)
+        {
+            behavior.error = SENSORS_ERR_KERNEL;
+        }
+        else if (strncmp(value, "access", name_length) == 0 &&
+                 name_length == 6)
+        {
+            behavior.error = SENSORS_ERR_ACCESS_R;
+        }
+        else if (strncmp(value, "none", name_length) != 0 ||
+                 name_length != 4)
+        {
+            return -1;
+        }
+
+        if (colon != NULL && parse_rate(colon + 1, &behavior.error_rate) < 0)
+        {
+            return -1;
+        }
+    }
+    else if (strncmp(key, "hang", key_length) == 0 && key_length == 4)
+    {
+        field = HANG;
+
+        if (parse_rate(value, &behavior.hang_rate) < 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        return -1;
+    }
+
+    /* During the first pass, only check the syntax */
+    for (int i = first; chips != NULL && i <= last; i++)
+    {
+        Behavior *target = &chips[i].behavior;
+
+        switch (field)
+        {
+        case LATENCY:
+            target->latency = behavior.latency;
+            break;
+        case JITTER:
+            target->jitter = behavior.jitter;
+            break;
+        case ERROR:
+            target->error = behavior.error;
+            target->error_rate = behavior.error_rate;
+            break;
+        case HANG:
+            target->hang_rate = behavior.hang_rate;
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static int
+parse_long(const char *string, long *result)
+{
+    char *end;
+
+    errno = 0;
+    *result = strtol(string, &end, 10);
+
+    return *string == '\0' || *end != '\0' || errno != 0 || *result < 0 ?
+        -1 : 0;
+}
+
+static int
+parse_rate(const char *string, double *result)
+{
+    char *end;
+
+    *result = strtod(string, &end);
+
+    return *string == '\0' || *end != '\0' ||
+        !(*result >= 0.0 && *result <= 1.0) ? -1 : 0;
+}
+
+/*
+ * Return the chip with this name.  Otherwise, return NULL and store
+ * the libsensors error code in status.
+ */
+static Chip*
+find_chip(const sensors_chip_name *name, int *status)
+{
+    *status = -SENSORS_ERR_NO_ENTRY;
+
+    if (has_wildcards(name))
+    {
+        *status = -SENSORS_ERR_WILDCARDS;
+        return NULL;
+    }
+
+    if (strcmp(name->prefix, PREFIX) != 0 ||
+        name->bus.type != SENSORS_BUS_TYPE_ISA ||
+        name->bus.nr != 0 ||
+        name->addr >= chip_count)
+    {
+        return NULL;
+    }
+
+    *status = 0;
+
+    return &chips[name->addr];
+}
+
+static int
+matches(const sensors_chip_name *match, const sensors_chip_name *name)
+{
+    return (match->prefix == SENSORS_CHIP_NAME_PREFIX_ANY ||
+            strcmp(match->prefix, name->prefix) == 0) &&
+        (match->bus.type == SENSORS_BUS_TYPE_ANY ||
+         match->bus.type == name->bus.type) &&
+        (match->bus.nr == SENSORS_BUS_NR_ANY ||
+         match->bus.nr == name->bus.nr) &&
+        (match->addr == SENSORS_CHIP_NAME_ADDR_ANY ||
+         match->addr == name->addr);
+}
+
+static int
+has_wildcards(const sensors_chip_name *chip)
+{
+    return chip->prefix == SENSORS_CHIP_NAME_PREFIX_ANY ||
+        chip->bus.type == SENSORS_BUS_TYPE_ANY ||
+        chip->bus.nr == SENSORS_BUS_NR_ANY ||
+        chip->addr == SENSORS_CHIP_NAME_ADDR_ANY;
+}
+
+/*
+ * Return a pseudo-random number in [0, 1).  The draws are numbered
+ * atomically and hashed with SplitMix64, so that concurrent readers
+ * don't need a lock, and a single-threaded run is reproducible.
+ */
+static double
+draw(void)
+{
+    uint64_t x = seed +
+        __atomic_add_fetch(&draws, 1, __ATOMIC_RELAXED) *
+        0x9E3779B97F4A7C15ull;
+
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+
+    return (double)(x >> 11) / (double)(1ull << 53);
+}
+
+static void
+wait_us(long us)
+{
+    struct timespec delay = {us / 1000000, us % 1000000 * 1000};
+
+    while (us > 0 && nanosleep(&delay, &delay) < 0 && errno == EINTR)
+    {
+    }
+}
@@ -1,6 +1,11 @@
 #! /usr/bin/env python2
 # -*- coding: utf-8 -*-
 
+import os
+import select
+import subprocess
+import sys
+import time
 import unittest
 
 import sensors
@@ -49,5 +54,558 @@ class TestSubfeature(unittest.TestCase):
             self.assertEqual(s1, s2)
 
 
+class TestTopology(unittest.TestCase):
+    def test_cache(self):
+        c = sensors.get_detected_chips()[0]
+        features = c.get_features()
+        feature = features[0]
+        self.assertTrue(c.get_features() is features)
+        self.assertTrue(c.get_all_subfeatures(feature) is
+                        c.get_all_subfeatures(feature))
+        self.assertTrue(c.get_label(feature) is c.get_label(feature))
+
+        subfeature = c.get_all_subfeatures(feature)[0]
+        self.assertTrue(c.get_subfeature(feature, subfeature.type) is
+                        subfeature)
+
+    def test_reinit(self):
+        # The default configuration can't be loaded again, so use another
+        # process to keep it for the other tests
+        script = """
+import os, sensors
+c = sensors.get_detected_chips()[0]
+features = c.get_features()
+sensors.init(os.devnull)
+print("%s %s" % (c.get_features() is features,
+                c.get_features() == features))
+"""
+        output = subprocess.check_output([sys.executable, '-c', script])
+        self.assertEqual(output.split(), [b'False', b'True'])
+
+    def test_interned(self):
+        chips = sensors.get_detected_chips()
+        feature = chips[0].get_features()[0]
+        subfeature = chips[0].get_all_subfeatures(feature)[0]
+        # Equal features of different chips are the same object
+        for c in chips:
+            for f in c.get_features():
+                self.assertEqual(f is feature, f == feature)
+        self.assertRaises(AttributeError, setattr, feature, 'number', 1)
+        self.assertRaises(AttributeError, setattr, subfeature, 'name', 'x')
+        self.assertRaises(AttributeError, subfeature.__init__, 'x')
+
+        copy = sensors.Subfeature(subfeature.name, subfeature.number,
+                                  subfeature.type, subfeature.mapping,
+                                  subfeature.flags)
+        self.assertEqual(copy, subfeature)
+        copy.name = 'x'
+        self.assertEqual(copy.name, 'x')
+        self.assertNotEqual(copy, subfeature)
+
+
+class TestGetValues(unittest.TestCase):
+    def test_get_values(self):
+        c = sensors.get_detected_chips()[0]
+        numbers = [subfeature.number
+                   for feature in c.get_features()
+                   for subfeature in c.get_all_subfeatures(feature)]
+        readings = c.get_values(numbers)
+        self.assertEqual(len(readings), len(numbers))
+
+        for i, number in enumerate(numbers):
+            self.assertEqual(readings[i] is None,
+                             c.get_value_or_none(number) is None)
+            self.assertEqual(readings[i] is None,
+                             readings.get_status(i) != 0)
+
+        self.assertRaises(OverflowError, c.get_value, 2**32)
+        self.assertRaises(OverflowError, c.get_values, [2**32])
+        self.assertRaises(OverflowError, c.get_values, [-2**32])
+
+
+class TestSnapshot(unittest.TestCase):
+    def test_snapshot(self):
+        snapshot = sensors.snapshot()
+        count = 0
+
+        for chip in sensors.get_detected_chips():
+            self.assertTrue(str(chip) in snapshot.chip_names)
+
+            for feature in chip.get_features():
+                self.assertTrue(feature.name in snapshot.feature_names)
+                count += len(chip.get_all_subfeatures(feature))
+
+        self.assertEqual(len(snapshot), count)
+        self.assertEqual(len(snapshot.readings), count)
+
+    def test_parallel(self):
+        serial = sensors.snapshot()
+        parallel = sensors.snapshot(parallel=True)
+        self.assertEqual([s[:4] for s in serial], [s[:4] for s in parallel])
+        self.assertEqual([serial.readings.get_status(i)
+                          for i in range(len(serial))],
+                         [parallel.readings.get_status(i)
+                          for i in range(len(parallel))])
+
+
+class TestReadPlan(unittest.TestCase):
+    def test_read(self):
+        c = sensors.get_detected_chips()[0]
+        subfeatures = c.get_all_subfeatures(c.get_features()[0])
+        readable = [s for s in subfeatures if s.flags & sensors.MODE_R]
+        plan = sensors.ReadPlan([(c, s) for s in readable])
+        self.assertEqual(len(plan), len(readable))
+        readings = plan.read()
+        self.assertEqual(len(readings), len(readable))
+        self.assertTrue(plan.read(out=readings) is readings)
+        self.assertRaises(RuntimeError, plan.__init__,
+                          [(c, s) for s in readable] * 2)
+        self.assertEqual(len(plan), len(readable))
+
+    def test_wildcards(self):
+        self.assertRaises(sensors.SensorsException,
+                          sensors.ReadPlan, [(sensors.ChipName(), 0)])
+
+    def test_overflow(self):
+        c = sensors.get_detected_chips()[0]
+        number = c.get_all_subfeatures(c.get_features()[0])[0].number
+        self.assertRaises(OverflowError, sensors.ReadPlan,
+                          [(c, number + 2**32)])
+        self.assertRaises(OverflowError, sensors.read_many,
+                          [(c, number + 2**32)])
+
+    def test_parallel(self):
+        pairs = [(c, s)
+                 for c in sensors.get_detected_chips()
+                 for f in c.get_features()
+                 for s in c.get_all_subfeatures(f)
+                 if s.flags & sensors.MODE_R]
+        serial = sensors.ReadPlan(pairs).read()
+        parallel = sensors.ReadPlan(pairs, parallel=True).read()
+        self.assertEqual([serial.get_status(i) for i in range(len(serial))],
+                         [parallel.get_status(i)
+                          for i in range(len(parallel))])
+
+
+class TestSampler(unittest.TestCase):
+    def test_drain(self):
+        c = sensors.get_detected_chips()[0]
+        subfeatures = c.get_all_subfeatures(c.get_features()[0])
+        plan = sensors.ReadPlan([(c, s) for s in subfeatures
+                                 if s.flags & sensors.MODE_R])
+        sampler = sensors.Sampler(plan, 0.01)
+
+        with sampler:
+            self.assertTrue(sampler.running)
+            time.sleep(0.1)
+
+        self.assertFalse(sampler.running)
+        readings = sampler.drain()
+        self.assertTrue(readings.rows > 0)
+        self.assertEqual(readings.columns, len(plan))
+        self.assertEqual(len(readings), readings.rows * readings.columns)
+
+        for row in range(1, readings.rows):
+            self.assertTrue(readings.get_timestamp(row) >
+                            readings.get_timestamp(row - 1))
+
+        self.assertEqual(sampler.drain().rows, 0)
+
+
+class TestPoller(unittest.TestCase):
+    def test_adaptive(self):
+        c = sensors.get_detected_chips()[0]
+        subfeatures = c.get_all_subfeatures(c.get_features()[0])
+        pairs = [(c, s) for s in subfeatures if s.flags & sensors.MODE_R]
+        # The values of real chips move between reads, so any change is
+        # tolerated, and only the statuses are compared
+        poller = sensors.Poller(pairs, 0.001, 0.004, float('inf'))
+        expected = sensors.read_many(pairs)
+
+        for i in range(4):
+            readings = poller.poll()
+
+        for i in range(len(pairs)):
+            self.assertEqual(readings.get_status(i), expected.get_status(i))
+
+            if expected.get_status(i) == 0:
+                self.assertEqual(poller.get_interval(i), 0.004)
+
+        self.assertTrue(poller.next_deadline() <= 0.004)
+        self.assertEqual(poller.reads, 4 * len(pairs))
+
+
+@unittest.skipIf(sensors.LIBSENSORS_VERSION == 'shim',
+                 'the shim has no sysfs attributes to poll')
+class TestAlarmWatcher(unittest.TestCase):
+    def test_wait(self):
+        c = sensors.get_detected_chips()[0]
+
+        with sensors.AlarmWatcher(c) as watcher:
+            for subfeature in watcher.subfeatures:
+                self.assertTrue(subfeature.name.endswith('_alarm'))
+
+            self.assertTrue(watcher.fileno() >= 0)
+            self.assertEqual(watcher.wait(0), [])
+
+        self.assertRaises(ValueError, watcher.wait, 0)
+
+
+class TestStats(unittest.TestCase):
+    def test_stats(self):
+        sensors.reset_stats()
+        c = sensors.get_detected_chips()[0]
+        feature = c.get_features()[0]
+        numbers = [s.number for s in c.get_all_subfeatures(feature)]
+        failures = [c.get_value_or_none(n) for n in numbers + [999]].count(
+            None)
+        stats = sensors.stats()
+        self.assertEqual(stats[None]['get_detected_chips']['calls'], 1)
+        self.assertEqual(stats[str(c)]['get_features']['calls'], 1)
+        self.assertEqual(stats[str(c)]['get_all_subfeatures']['calls'], 1)
+
+        reads = stats[str(c)]['get_value']
+        self.assertEqual(reads['calls'], len(numbers) + 1)
+        self.assertEqual(reads['timed_calls'], reads['calls'])
+        self.assertEqual(sum(count for bound, count in reads['histogram']),
+                         reads['calls'])
+        self.assertTrue(reads['total_ns'] > 0)
+        self.assertEqual(sum(reads['errors'].values()), failures)
+
+        sensors.reset_stats()
+        self.assertEqual(sensors.stats(), {})
+
+
+class TestProfile(unittest.TestCase):
+    def test_profile(self):
+        chips = sensors.get_detected_chips()
+        counts = {}
+
+        for c in chips:
+            counts[str(c)] = len([s for f in c.get_features()
+                                  for s in c.get_all_subfeatures(f)
+                                  if s.flags & sensors.MODE_R])
+
+        report = sensors.profile(0)
+        self.assertEqual(report['rounds'], 1)
+        self.assertEqual(report['reads'], sum(counts.values()))
+        self.assertEqual(set(report['chips']), set(counts))
+
+        for name, chip in report['chips'].items():
+            self.assertEqual(chip['subfeatures'], counts[name])
+            self.assertEqual(chip['reads'], counts[name])
+            self.assertTrue(chip['mean_ns'] <= chip['max_ns'])
+            self.assertTrue(chip['p99_ns'] <= chip['max_ns'])
+            self.assertTrue(chip['adapter'] in report['adapters'])
+
+        for key, adapter in report['adapters'].items():
+            self.assertEqual(adapter['name'], sensors.get_adapter_name(*key))
+
+        for groups in ('chips', 'adapters', 'types'):
+            self.assertEqual(
+                sum(g['reads'] for g in report[groups].values()),
+                report['reads'])
+
+        report = sensors.profile(0.05)
+        self.assertTrue(report['rounds'] >= 1)
+
+        if report['reads'] > 0:
+            self.assertTrue(report['duration'] >= 0.05)
+
+        self.assertRaises(ValueError, sensors.profile, -1)
+
+
+class TestAsyncReader(unittest.TestCase):
+    def test_results(self):
+        c = sensors.get_detected_chips()[0]
+        numbers = [s.number
+                   for s in c.get_all_subfeatures(c.get_features()[0])
+                   if s.flags & sensors.MODE_R]
+        reader = sensors.AsyncReader()
+        tokens = dict((reader.submit(c, n), n) for n in numbers)
+        tokens[reader.submit(c, 999)] = None
+        results = []
+
+        while len(results) < len(tokens):
+            select.select([reader.fileno()], [], [], 1.0)
+            results.extend(reader.results())
+
+        for token, value, error in results:
+            if tokens[token] is None:
+                self.assertEqual(value, None)
+                self.assertTrue(error)
+            else:
+                # The value may have changed since, but not whether the
+                # subfeature can be read
+                expected = c.get_value_or_none(tokens[token])
+                self.assertEqual(error is None, expected is not None)
+                self.assertEqual(value is None, expected is None)
+
+        reader.close()
+        self.assertRaises(ValueError, reader.submit, c, numbers[0])
+
+
+@unittest.skipIf(sys.version_info < (3, 6), 'requires asyncio')
+class TestAsync(unittest.TestCase):
+    def setUp(self):
+        import asyncio
+        self.loop = asyncio.new_event_loop()
+
+    def tearDown(self):
+        self.loop.close()
+
+    def test_aget_value(self):
+        c = sensors.get_detected_chips()[0]
+        number = c.get_all_subfeatures(c.get_features()[0])[0].number
+        value = self.loop.run_until_complete(c.aget_value(number))
+        self.assertTrue(isinstance(value, float))
+        self.assertRaises(sensors.SensorsException,
+                          self.loop.run_until_complete, c.aget_value(999))
+
+    def test_watch(self):
+        c = sensors.get_detected_chips()[0]
+        plan = sensors.ReadPlan([(c, 0)])
+        batches = sensors.watch(plan, 0.01)
+        batch = self.loop.run_until_complete(batches.__anext__())
+        self.assertTrue(batch.rows > 0)
+        self.assertEqual(batch.columns, 1)
+        self.loop.run_until_complete(batches.aclose())
+
+
+@unittest.skipUnless(sensors.LIBSENSORS_VERSION == 'shim',
+                     'requires the module built with --shim')
+class TestShim(unittest.TestCase):
+    def configure(self, settings):
+        os.environ['SENSORS_SHIM'] = settings
+        sensors.init(os.devnull)
+
+    def tearDown(self):
+        os.environ.pop('SENSORS_SHIM', None)
+        sensors.init(os.devnull)
+
+    def test_chips(self):
+        self.configure('chips=7')
+        self.assertEqual([c.addr for c in sensors.get_detected_chips()],
+                         list(range(7)))
+        self.assertRaises(sensors.SensorsException, self.configure,
+                          'chips=-1')
+
+    def test_errors(self):
+        self.configure('chips=3, error.1=kernel, error.2=access')
+        chips = sensors.get_detected_chips()
+        readings = sensors.read_many([(c, 0) for c in chips])
+        # -SENSORS_ERR_KERNEL and -SENSORS_ERR_ACCESS_R
+        self.assertEqual([readings.get_status(i) for i in range(3)],
+                         [0, -4, -3])
+        self.assertRaises(sensors.SensorsException, chips[1].get_value, 0)
+
+    def test_latency(self):
+        self.configure('chips=1 latency=20000')
+        chip = sensors.get_detected_chips()[0]
+        start = time.time()
+        chip.get_value(0)
+        self.assertTrue(time.time() - start >= 0.02)
+
+    def test_hang(self):
+        # The hung thread keeps libsensors locked, so use another process
+        script = """
+import os, sensors, sys, threading
+chips = sensors.get_detected_chips()
+thread = threading.Thread(target=chips[1].get_value, args=(0,))
+thread.daemon = True
+thread.start()
+thread.join(0.2)
+print(thread.is_alive(), chips[0].get_value(0))
+sys.stdout.flush()
+os._exit(0)
+"""
+        env = dict(os.environ, SENSORS_SHIM='chips=2 hang.1=1')
+        output = subprocess.check_output([sys.executable, '-c', script],
+                                         env=env)
+        self.assertEqual(output.split(), [b'True', b'40.0'])
+
+
+class TestHistory(unittest.TestCase):
+    def test_range(self):
+        history = sensors.History(2, 4)
+
+        for i in range(6):
+            history.append(0, float(i), time=100 + i)
+
+        self.assertEqual(history.count(0), 4)
+        self.assertEqual(history.count(1), 0)
+        self.assertEqual(history.latest(0), (105, 5.0))
+        self.assertEqual(history.latest(1), None)
+        self.assertEqual(list(history.range(0)), [2.0, 3.0, 4.0, 5.0])
+        self.assertEqual(list(history.range(0, 103, 105)), [3.0, 4.0])
+        self.assertRaises(ValueError, history.append, 0, 0.0, time=50)
+
+    def test_record(self):
+        c = sensors.get_detected_chips()[0]
+        subfeatures = c.get_all_subfeatures(c.get_features()[0])
+        plan = sensors.ReadPlan([(c, s) for s in subfeatures
+                                 if s.flags & sensors.MODE_R])
+        history = sensors.History(len(plan), 10)
+        readings = plan.read()
+        history.record(readings)
+
+        for i in range(len(plan)):
+            expected = 0 if readings[i] is None else 1
+            self.assertEqual(history.count(i), expected)
+
+    def test_record_range(self):
+        history = sensors.History(1, 4)
+
+        for i in range(3):
+            history.append(0, float(i), time=1000 + i)
+
+        copy = sensors.History(1, 4)
+        copy.record(history.range(0))
+        self.assertEqual(copy.latest(0), (1002, 2.0))
+        self.assertEqual(list(copy.range(0, 1001)), [1.0, 2.0])
+
+
+class TestRollup(unittest.TestCase):
+    def test_windows(self):
+        c = sensors.get_detected_chips()[0]
+        plan = sensors.ReadPlan([(c, c.get_all_subfeatures(
+            c.get_features()[0])[0])])
+        readings = plan.read()
+        value = readings[0]
+        rollup = sensors.Rollup(1, windows=(1.0, 60.0))
+
+        for t in (0, 500000000, 1000000000):
+            rollup.record(readings, time=t)
+
+        self.assertEqual(rollup.drain(), [(1.0, 0, 0, 2, value, value, value)])
+        self.assertEqual(rollup.drain(), [])
+        self.assertEqual(rollup.current(),
+                         [(1.0, 1000000000, 0, 1, value, value, value),
+                          (60.0, 0, 0, 3, value, value, value)])
+
+    def test_record_history(self):
+        history = sensors.History(1, 4)
+
+        for t in (0, 500000000, 1000000000):
+            history.append(0, 1.0, time=t)
+
+        rollup = sensors.Rollup(1, windows=(1.0,))
+        rollup.record(history.range(0))
+        self.assertEqual(rollup.drain(), [(1.0, 0, 0, 2, 1.0, 1.0, 1.0)])
+
+    def test_sampler(self):
+        c = sensors.get_detected_chips()[0]
+        subfeatures = c.get_all_subfeatures(c.get_features()[0])
+        plan = sensors.ReadPlan([(c, s) for s in subfeatures
+                                 if s.flags & sensors.MODE_R])
+        rollup = sensors.Rollup(len(plan), windows=(0.01,))
+        sampler = sensors.Sampler(plan, 0.005, capacity=1, rollup=rollup)
+
+        with sampler:
+            time.sleep(0.1)
+
+        self.assertTrue(len(rollup.drain()) > 0)
+        self.assertRaises(ValueError, sensors.Sampler, plan, 0.01,
+                          rollup=sensors.Rollup(len(plan) + 1))
+
+
+class TestMonitor(unittest.TestCase):
+    def make_monitor(self, changes, **limits):
+        c = sensors.get_detected_chips()[0]
+        f = c.get_features()[0]
+        monitor = sensors.Monitor([(c, f)],
+                                  lambda *args: changes.append(args[2:4]))
+        # Disable the limits of the chip, so that only ours are crossed
+        nan = float('nan')
+        monitor.set_limits(0, min=nan, max=nan, lcrit=nan, crit=nan,
+                           emergency=nan, max_hyst=nan, crit_hyst=nan,
+                           emergency_hyst=nan)
+        monitor.set_limits(0, **limits)
+        return monitor
+
+    def make_readings(self, values):
+        history = sensors.History(1, len(values))
+
+        for i, value in enumerate(values):
+            history.append(0, value, i + 1)
+
+        return history.range(0)
+
+    def test_transitions(self):
+        changes = []
+        monitor = self.make_monitor(changes, min=10, max=50, crit=60)
+
+        self.assertEqual(monitor.evaluate(self.make_readings([30])), 0)
+        self.assertEqual(monitor.evaluate(self.make_readings([55, 56])), 1)
+        self.assertEqual(monitor.get_state(0), sensors.STATE_WARN)
+        self.assertEqual(monitor.evaluate(self.make_readings([65, 5])), 2)
+        self.assertEqual(changes, [(sensors.STATE_OK, sensors.STATE_WARN),
+                                   (sensors.STATE_WARN, sensors.STATE_CRIT),
+                                   (sensors.STATE_CRIT, sensors.STATE_WARN)])
+
+    def test_hysteresis(self):
+        changes = []
+        monitor = self.make_monitor(changes, max=50, max_hyst=45)
+
+        self.assertEqual(monitor.evaluate(self.make_readings([55])), 1)
+        # Back below the maximum, but not below the hysteresis limit
+        self.assertEqual(monitor.evaluate(self.make_readings([48])), 0)
+        self.assertEqual(monitor.get_limits(0)['max_hyst'], 45)
+        self.assertEqual(monitor.evaluate(self.make_readings([40])), 1)
+        self.assertEqual(changes, [(sensors.STATE_OK, sensors.STATE_WARN),
+                                   (sensors.STATE_WARN, sensors.STATE_OK)])
+
+
+class TestFastRead(unittest.TestCase):
+    def tearDown(self):
+        sensors.set_fast_read(False)
+
+    def test_same_errors(self):
+        c = sensors.get_detected_chips()[0]
+        numbers = [subfeature.number
+                   for feature in c.get_features()
+                   for subfeature in c.get_all_subfeatures(feature)]
+        slow = c.get_values(numbers)
+        self.assertFalse(sensors.set_fast_read(True))
+        fast = c.get_values(numbers)
+
+        for i in range(len(numbers)):
+            self.assertEqual(slow.get_status(i), fast.get_status(i))
+
+
+class TestReadMany(unittest.TestCase):
+    def tearDown(self):
+        sensors.set_fast_read(False)
+
+    def test_read_many(self):
+        pairs = [(c, s)
+                 for c in sensors.get_detected_chips()
+                 for f in c.get_features()
+                 for s in c.get_all_subfeatures(f)
+                 if s.flags & sensors.MODE_R]
+        slow = sensors.ReadPlan(pairs).read()
+        fast = sensors.read_many(pairs)
+        self.assertEqual(len(fast), len(pairs))
+
+        for i in range(len(pairs)):
+            self.assertEqual(slow.get_status(i), fast.get_status(i))
+
+    def test_buffer(self):
+        c = sensors.get_detected_chips()[0]
+        subfeatures = c.get_all_subfeatures(c.get_features()[0])
+        readings = sensors.read_many([(c, s.number) for s in subfeatures])
+        values = memoryview(readings)
+        self.assertEqual(values.format, 'd')
+        self.assertEqual(values.shape, (len(readings),))
+        self.assertTrue(values.readonly)
+        statuses = readings.statuses.tolist()
+
+        for i in range(len(readings)):
+            self.assertEqual(statuses[i], readings.get_status(i))
+
+            if statuses[i] == 0:
+                self.assertEqual(values[i], readings[i])
+
+
 if __name__ == '__main__':
     unittest.main()